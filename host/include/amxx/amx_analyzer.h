@@ -0,0 +1,133 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//
+// Static analysis of plugin images: native call sites, natives called inside loops, and the publics with
+// their sizes. Images are read from their files: the core relocates or JIT-compiles the code of a loaded
+// plugin, so the code in its memory can no longer be decoded.
+//
+
+namespace amx
+{
+    /**
+     * @brief N/D
+    */
+    struct NativeUsage
+    {
+        std::string name{};
+
+        /**
+         * @brief \c SYSREQ.C instructions that call the native.
+        */
+        std::size_t call_sites{};
+
+        /**
+         * @brief Call sites that lie between a backward jump and its target.
+        */
+        std::size_t loop_call_sites{};
+    };
+
+    /**
+     * @brief N/D
+    */
+    struct PublicUsage
+    {
+        std::string name{};
+
+        /**
+         * @brief Code address, relative to the code section.
+        */
+        ucell address{};
+
+        /**
+         * @brief Size of the function in bytes, up to the next \c PROC.
+        */
+        std::size_t size{};
+
+        /**
+         * @brief Native call sites in the function itself, not in the functions it calls.
+        */
+        std::size_t native_calls{};
+    };
+
+    /**
+     * @brief N/D
+    */
+    struct ImageReport
+    {
+        std::string plugin{};
+        std::size_t code_size{};
+        std::size_t instructions{};
+
+        /**
+         * @brief \c SYSREQ.PRI and \c SYSREQ.D call sites, whose native is not known statically.
+        */
+        std::size_t dynamic_calls{};
+
+        /**
+         * @brief Every entry of the native table, most loop call sites first.
+        */
+        std::vector<NativeUsage> natives{};
+
+        /**
+         * @brief N/D
+        */
+        std::vector<PublicUsage> publics{};
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] std::size_t LoopCallSites() const;
+    };
+
+    /**
+     * @brief Analyses the code of an unrelocated, expanded image of \c size bytes.
+    */
+    AmxError AnalyzeImage(const unsigned char* image, std::size_t size, ImageReport& report);
+
+    /**
+     * @brief Loads \c path through \c AmxxFile and analyses its image.
+    */
+    AmxError AnalyzeFile(const char* path, ImageReport& report);
+
+    /**
+     * @brief Text tables: the natives of all plugins most called in loops first, then every plugin.
+    */
+    std::string ImageReportText(const std::vector<ImageReport>& reports);
+
+    /**
+     * @brief N/D
+    */
+    std::string ImageReportJson(const std::vector<ImageReport>& reports);
+}
+
+namespace amxx
+{
+    /**
+     * @brief Analyses the file of every plugin the core has loaded.
+     * A plugin whose script name does not open as a path is looked up by file name in \c plugins_dir.
+     * Plugins whose file cannot be analysed are left out.
+    */
+    std::vector<amx::ImageReport> AnalyzeLoadedPlugins(const char* plugins_dir);
+}
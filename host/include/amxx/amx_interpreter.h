@@ -0,0 +1,152 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/amx_opcodes.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace amx
+{
+    /**
+     * @brief Pawn abstract machine running a plugin image in place.
+     * \c Init validates the header, expands compact-encoded images and translates the code into threaded
+     * code: every opcode becomes the address of its handler and every jump target a pointer into the
+     * translated code, so dispatch is a single indirect jump (computed goto on GCC and Clang).
+     * Natives bound before the first call are called directly, the way \c SYSREQ.D does.
+    */
+    class Interpreter
+    {
+    public:
+        Interpreter() = default;
+        Interpreter(const Interpreter&) = delete;
+        Interpreter& operator=(const Interpreter&) = delete;
+        ~Interpreter();
+
+        /**
+         * @brief Prepares \c amx to run \c image.
+         * \c image holds the file image and must be \c cell aligned and at least \c AmxHeader::stp bytes long,
+         * since the data, heap and stack live right after the code.
+        */
+        AmxError Init(Amx* amx, unsigned char* image, std::size_t image_size);
+
+        /**
+         * @brief Binds the natives of \c list to the matching entries of the native table.
+        */
+        void RegisterNatives(const AmxNativeInfo* list);
+
+        /**
+         * @brief Binds every still unbound native through \c resolve; returns the number still unbound.
+        */
+        std::size_t ResolveNatives(const std::function<AmxNative(const char* name)>& resolve);
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] std::size_t UnboundNativeCount() const;
+
+        /**
+         * @brief Pushes an argument for the next \c Exec.
+        */
+        AmxError Push(cell value);
+
+        /**
+         * @brief Runs the public \c index, \c AMX_EXEC_MAIN or \c AMX_EXEC_CONT to resume after \c AmxError::Sleep.
+        */
+        AmxError Exec(cell* return_val, int index);
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] Amx* GetAmx() const
+        {
+            return amx_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int PublicCount() const
+        {
+            return static_cast<int>(public_addresses_.size());
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int NativeCount() const
+        {
+            return static_cast<int>(natives_.size());
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] const char* NativeName(const int index) const
+        {
+            return native_names_[index];
+        }
+
+        /**
+         * @brief Size of the code section in bytes.
+        */
+        [[nodiscard]] std::size_t CodeSize() const
+        {
+            return code_size_;
+        }
+
+    private:
+        AmxError Relocate();
+        AmxError CallNative(int index, cell* result, cell* params);
+        void BindNative(std::size_t index, AmxNative func);
+        int Run(cell* return_val, const std::intptr_t* cip, cell pri, cell alt, cell frm, cell stk, cell hea,
+                cell reset_stk, cell reset_hea);
+
+        Amx* amx_{};
+        const unsigned char* code_{};
+        std::size_t code_size_{};
+
+        /**
+         * @brief Threaded code, one entry per code cell.
+        */
+        std::vector<std::intptr_t> threaded_{};
+
+        std::vector<ucell> public_addresses_{};
+        std::vector<const char*> native_names_{};
+        std::vector<AmxNative> natives_{};
+
+        /**
+         * @brief Positions of the SYSREQ.C instructions and the native each one calls.
+        */
+        std::vector<std::pair<std::size_t, cell>> sysreq_sites_{};
+    };
+
+    /**
+     * @brief Interpreter attached to \c amx by \c Interpreter::Init, or nullptr.
+    */
+    Interpreter* GetInterpreter(const Amx* amx);
+
+    /**
+     * @brief Expands a compact-encoded code and data section in place.
+     * \c compact_size is the encoded size and \c expanded_size the size after expansion; \c section must hold the latter.
+    */
+    bool ExpandCompact(unsigned char* section, std::size_t compact_size, std::size_t expanded_size);
+}
@@ -0,0 +1,326 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+
+namespace amx
+{
+    /**
+     * @brief Pawn AMX opcodes, including the float opcodes of the AMXX compiler.
+    */
+    enum class Opcode : cell
+    {
+        None = 0,
+        LoadPri,
+        LoadAlt,
+        LoadSPri,
+        LoadSAlt,
+        LrefPri,
+        LrefAlt,
+        LrefSPri,
+        LrefSAlt,
+        LoadI,
+        LodbI,
+        ConstPri,
+        ConstAlt,
+        AddrPri,
+        AddrAlt,
+        StorPri,
+        StorAlt,
+        StorSPri,
+        StorSAlt,
+        SrefPri,
+        SrefAlt,
+        SrefSPri,
+        SrefSAlt,
+        StorI,
+        StrbI,
+        Lidx,
+        LidxB,
+        Idxaddr,
+        IdxaddrB,
+        AlignPri,
+        AlignAlt,
+        Lctrl,
+        Sctrl,
+        MovePri,
+        MoveAlt,
+        Xchg,
+        PushPri,
+        PushAlt,
+        PushR,
+        PushC,
+        Push,
+        PushS,
+        PopPri,
+        PopAlt,
+        Stack,
+        Heap,
+        Proc,
+        Ret,
+        Retn,
+        Call,
+        CallPri,
+        Jump,
+        Jrel,
+        Jzer,
+        Jnz,
+        Jeq,
+        Jneq,
+        Jless,
+        Jleq,
+        Jgrtr,
+        Jgeq,
+        Jsless,
+        Jsleq,
+        Jsgrtr,
+        Jsgeq,
+        Shl,
+        Shr,
+        Sshr,
+        ShlCPri,
+        ShlCAlt,
+        ShrCPri,
+        ShrCAlt,
+        Smul,
+        Sdiv,
+        SdivAlt,
+        Umul,
+        Udiv,
+        UdivAlt,
+        Add,
+        Sub,
+        SubAlt,
+        And,
+        Or,
+        Xor,
+        Not,
+        Neg,
+        Invert,
+        AddC,
+        SmulC,
+        ZeroPri,
+        ZeroAlt,
+        Zero,
+        ZeroS,
+        SignPri,
+        SignAlt,
+        Eq,
+        Neq,
+        Less,
+        Leq,
+        Grtr,
+        Geq,
+        Sless,
+        Sleq,
+        Sgrtr,
+        Sgeq,
+        EqCPri,
+        EqCAlt,
+        IncPri,
+        IncAlt,
+        Inc,
+        IncS,
+        IncI,
+        DecPri,
+        DecAlt,
+        Dec,
+        DecS,
+        DecI,
+        Movs,
+        Cmps,
+        Fill,
+        Halt,
+        Bounds,
+        SysreqPri,
+        SysreqC,
+
+        /**
+         * @brief Obsolete.
+        */
+        File,
+
+        /**
+         * @brief Obsolete.
+        */
+        Line,
+
+        /**
+         * @brief Obsolete.
+        */
+        Symbol,
+
+        /**
+         * @brief Obsolete.
+        */
+        Srange,
+
+        JumpPri,
+        Switch,
+        Casetbl,
+        SwapPri,
+        SwapAlt,
+        PushAdr,
+        Nop,
+        SysreqD,
+
+        /**
+         * @brief Obsolete.
+        */
+        Symtag,
+
+        Break,
+        FloatMul,
+        FloatDiv,
+        FloatAdd,
+        FloatSub,
+        FloatTo,
+        FloatRound,
+        FloatCmp,
+
+        /**
+         * @brief Number of opcodes.
+        */
+        Count
+    };
+
+    /**
+     * @brief Number of operand cells of \c opcode; -1 for the variable-length ones (FILE, SYMBOL, CASETBL).
+    */
+    constexpr int OpcodeOperands(const Opcode opcode)
+    {
+        switch (opcode) {
+        case Opcode::LoadPri:
+        case Opcode::LoadAlt:
+        case Opcode::LoadSPri:
+        case Opcode::LoadSAlt:
+        case Opcode::LrefPri:
+        case Opcode::LrefAlt:
+        case Opcode::LrefSPri:
+        case Opcode::LrefSAlt:
+        case Opcode::LodbI:
+        case Opcode::ConstPri:
+        case Opcode::ConstAlt:
+        case Opcode::AddrPri:
+        case Opcode::AddrAlt:
+        case Opcode::StorPri:
+        case Opcode::StorAlt:
+        case Opcode::StorSPri:
+        case Opcode::StorSAlt:
+        case Opcode::SrefPri:
+        case Opcode::SrefAlt:
+        case Opcode::SrefSPri:
+        case Opcode::SrefSAlt:
+        case Opcode::StrbI:
+        case Opcode::LidxB:
+        case Opcode::IdxaddrB:
+        case Opcode::AlignPri:
+        case Opcode::AlignAlt:
+        case Opcode::Lctrl:
+        case Opcode::Sctrl:
+        case Opcode::PushR:
+        case Opcode::PushC:
+        case Opcode::Push:
+        case Opcode::PushS:
+        case Opcode::Stack:
+        case Opcode::Heap:
+        case Opcode::Call:
+        case Opcode::Jump:
+        case Opcode::Jrel:
+        case Opcode::Jzer:
+        case Opcode::Jnz:
+        case Opcode::Jeq:
+        case Opcode::Jneq:
+        case Opcode::Jless:
+        case Opcode::Jleq:
+        case Opcode::Jgrtr:
+        case Opcode::Jgeq:
+        case Opcode::Jsless:
+        case Opcode::Jsleq:
+        case Opcode::Jsgrtr:
+        case Opcode::Jsgeq:
+        case Opcode::ShlCPri:
+        case Opcode::ShlCAlt:
+        case Opcode::ShrCPri:
+        case Opcode::ShrCAlt:
+        case Opcode::AddC:
+        case Opcode::SmulC:
+        case Opcode::Zero:
+        case Opcode::ZeroS:
+        case Opcode::EqCPri:
+        case Opcode::EqCAlt:
+        case Opcode::Inc:
+        case Opcode::IncS:
+        case Opcode::Dec:
+        case Opcode::DecS:
+        case Opcode::Movs:
+        case Opcode::Cmps:
+        case Opcode::Fill:
+        case Opcode::Halt:
+        case Opcode::Bounds:
+        case Opcode::SysreqC:
+        case Opcode::Switch:
+        case Opcode::PushAdr:
+        case Opcode::SysreqD:
+        case Opcode::Symtag:
+            return 1;
+
+        case Opcode::Line:
+        case Opcode::Srange:
+            return 2;
+
+        case Opcode::File:
+        case Opcode::Symbol:
+        case Opcode::Casetbl:
+            return -1;
+
+        default:
+            return 0;
+        }
+    }
+
+    /**
+     * @brief True if the operand of \c opcode is a code address.
+    */
+    constexpr bool IsCodeReference(const Opcode opcode)
+    {
+        switch (opcode) {
+        case Opcode::Call:
+        case Opcode::Jump:
+        case Opcode::Jrel:
+        case Opcode::Jzer:
+        case Opcode::Jnz:
+        case Opcode::Jeq:
+        case Opcode::Jneq:
+        case Opcode::Jless:
+        case Opcode::Jleq:
+        case Opcode::Jgrtr:
+        case Opcode::Jgeq:
+        case Opcode::Jsless:
+        case Opcode::Jsleq:
+        case Opcode::Jsgrtr:
+        case Opcode::Jsgeq:
+        case Opcode::Switch:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+}
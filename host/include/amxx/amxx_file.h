@@ -0,0 +1,193 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace amx
+{
+    /**
+     * @brief "AMXX"
+    */
+    constexpr std::int32_t AMXX_FILE_MAGIC = 0x414D5858;
+
+    /**
+     * @brief N/D
+    */
+    constexpr std::int16_t AMXX_FILE_VERSION = 0x0300;
+
+#pragma pack(push, 1)
+
+    /**
+     * @brief Header of a .amxx container.
+    */
+    struct AmxxFileHeader
+    {
+        std::int32_t magic;
+        std::int16_t version;
+        std::int8_t sections;
+    };
+
+    /**
+     * @brief Section of a .amxx container: one plugin image compiled for one cell size.
+    */
+    struct AmxxSection
+    {
+        /**
+         * @brief Cell size in bytes.
+        */
+        std::int8_t cell_size;
+
+        /**
+         * @brief Size of the compressed image in the file.
+        */
+        std::int32_t disk_size;
+
+        /**
+         * @brief Size of the image after decompression.
+        */
+        std::int32_t image_size;
+
+        /**
+         * @brief Memory the image needs, including the heap and stack.
+        */
+        std::int32_t memory_size;
+
+        /**
+         * @brief Offset of the compressed image from the start of the file.
+        */
+        std::int32_t offset;
+    };
+
+#pragma pack(pop)
+
+    /**
+     * @brief Checks that the fields of \c header describe a usable image of at most \c memory_size bytes.
+    */
+    AmxError ValidateHeader(const AmxHeader& header, std::size_t memory_size);
+
+    /**
+     * @brief Read-only memory mapping of a .amxx container, or of a plain .amx file.
+     * \c Load decompresses the section for our cell size straight into the final image, which is allocated
+     * once with room for the data, heap and stack; the file itself is never copied.
+    */
+    class AmxxFile
+    {
+    public:
+        AmxxFile() = default;
+        AmxxFile(const AmxxFile&) = delete;
+        AmxxFile& operator=(const AmxxFile&) = delete;
+
+        /**
+         * @brief N/D
+        */
+        explicit AmxxFile(const char* path)
+        {
+            Open(path);
+        }
+
+        /**
+         * @brief N/D
+        */
+        ~AmxxFile()
+        {
+            Close();
+        }
+
+        /**
+         * @brief Maps \c path and reads its section table.
+        */
+        AmxError Open(const char* path);
+
+        /**
+         * @brief N/D
+        */
+        void Close();
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] bool IsOpen() const
+        {
+            return data_ != nullptr;
+        }
+
+        /**
+         * @brief True for a plain .amx file, which holds a single uncompressed image.
+        */
+        [[nodiscard]] bool IsPlain() const
+        {
+            return plain_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int SectionCount() const
+        {
+            return static_cast<int>(sections_.size());
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] const AmxxSection& GetSection(const int index) const
+        {
+            return sections_[index];
+        }
+
+        /**
+         * @brief Section compiled for \c cell_size byte cells, or nullptr.
+        */
+        [[nodiscard]] const AmxxSection* FindSection(std::size_t cell_size = sizeof(cell)) const;
+
+        /**
+         * @brief Decompresses the section for our cell size into \c image and validates its header.
+         * \c image is resized to the stack top; on failure it is left empty. Debug information the compiler
+         * appended to the image is kept right after it, where \c amx::DebugInfo::ParseImage looks for it.
+        */
+        AmxError Load(std::vector<cell>& image) const;
+
+        /**
+         * @brief Description of the last error of \c Open or \c Load.
+        */
+        [[nodiscard]] const std::string& ErrorText() const
+        {
+            return error_text_;
+        }
+
+    private:
+        AmxError ReadSections();
+        AmxError Fail(AmxError error, const char* text) const;
+
+        const unsigned char* data_{};
+        std::size_t size_{};
+        bool plain_{};
+        std::vector<AmxxSection> sections_{};
+        mutable std::string error_text_{};
+
+#ifdef _WIN32
+        void* file_{};
+        void* mapping_{};
+#endif
+    };
+}
@@ -0,0 +1,245 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/api.h>
+#include <amxx/players.h>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+//
+// In-process stand-in for the AMXX core.
+// Supplies every function requested by AMXX_Attach from in-memory state, so a module can be attached,
+// fed with players and plugins and driven from a test or benchmark binary without a running server.
+//
+
+namespace amxx::host
+{
+    /**
+     * @brief Player record; \c PlayerPropAddress hands out pointers into it.
+    */
+    struct FakePlayer
+    {
+        char name[64];
+        char ip[64];
+        char team[64];
+        bool in_game;
+        bool authorized;
+        bool vgui;
+        float time;
+        float play_time;
+        float menu_expire;
+        PlayerWeapon weapons[32];
+        int current_weapon;
+        int team_id;
+        int deaths;
+        int aiming;
+        int menu;
+        int keys;
+        int flags[32];
+        int new_menu;
+        int new_menu_page;
+
+        //
+        // Not exposed through PlayerPropAddress, only through the getters.
+        //
+
+        int health;
+        int armor;
+        int frags;
+        bool alive;
+        bool bot;
+        bool hltv;
+        bool connecting;
+        cssdk::Edict* edict;
+    };
+
+    /**
+     * @brief C++ body of a public of a fake plugin; \c params is laid out the way the AMX passes it.
+    */
+    using FakePublic = std::function<cell(Amx* amx, cell* params)>;
+
+    /**
+     * @brief N/D
+    */
+    struct FakePublicInfo
+    {
+        const char* name;
+        FakePublic func;
+    };
+
+    /**
+     * @brief Exported functions of a module.
+    */
+    struct ModuleEntryPoints
+    {
+        std::add_pointer_t<Status(int* interface_version, ModuleInfo* module_info)> query{};
+        std::add_pointer_t<GameStatus(const char* game)> check_game{};
+        std::add_pointer_t<Status(std::add_pointer_t<void*(const char*)> request_function)> attach{};
+        std::add_pointer_t<Status()> detach{};
+        std::add_pointer_t<Status()> plugins_loaded{};
+        std::add_pointer_t<void()> plugins_unloaded{};
+        std::add_pointer_t<void()> plugins_unloading{};
+    };
+
+    /**
+     * @brief The \c request_function passed to \c AMXX_Attach.
+    */
+    void* RequestFunction(const char* name);
+
+    /**
+     * @brief Makes \c RequestFunction return nullptr for \c name, as an older core would.
+    */
+    void DisableFunction(const char* name);
+
+    /**
+     * @brief Undoes every \c DisableFunction.
+    */
+    void EnableFunctions();
+
+    /**
+     * @brief Entry points of the module linked into the current binary.
+    */
+    ModuleEntryPoints LinkedModule();
+
+    /**
+     * @brief Loads a module library and resolves its entry points; returns the library handle or nullptr.
+    */
+    void* LoadModuleLibrary(const char* path, ModuleEntryPoints& entry_points);
+
+    /**
+     * @brief N/D
+    */
+    void UnloadModuleLibrary(void* handle);
+
+    /**
+     * @brief Queries, checks and attaches \c module the way the core does on server start.
+    */
+    Status AttachModule(const ModuleEntryPoints& module);
+
+    /**
+     * @brief Detaches the attached module.
+    */
+    void DetachModule();
+
+    /**
+     * @brief Tells the attached module that the plugins are loaded.
+    */
+    void PluginsLoaded();
+
+    /**
+     * @brief Tells the attached module that the plugins are going away and removes them.
+    */
+    void UnloadPlugins();
+
+    /**
+     * @brief Adds a plugin whose publics are C++ callbacks.
+     * The image has a regular header, public and native tables, and \c memory_cells of data, heap and stack.
+    */
+    Amx* AddPlugin(const char* name, std::vector<FakePublicInfo> publics, std::vector<std::string> natives = {},
+                   std::size_t memory_cells = 16384);
+
+    /**
+     * @brief Adds a plugin from a compiled AMX image; its publics run on \c amx::Interpreter.
+     * The image is grown to its stack top if needed. Returns nullptr if the image does not load.
+    */
+    Amx* LoadPlugin(const char* name, std::vector<cell> image);
+
+    /**
+     * @brief Loads a .amxx or .amx file through \c amx::AmxxFile and adds it with \c LoadPlugin.
+    */
+    Amx* LoadPluginFile(const char* path);
+
+    /**
+     * @brief N/D
+    */
+    int PluginCount();
+
+    /**
+     * @brief Pauses or unpauses a plugin; forwards skip paused plugins, direct \c AmxExec calls do not.
+    */
+    void PausePlugin(const Amx* amx, bool paused);
+
+    /**
+     * @brief Returns the native registered by the module as \c name, or nullptr.
+    */
+    AmxNative FindNative(std::string_view name);
+
+    /**
+     * @brief Calls the native \c name with \c args, the way a plugin would.
+    */
+    cell CallNative(Amx* amx, std::string_view name, std::initializer_list<cell> args);
+
+    /**
+     * @brief Record of the player \c id (1..MAX_CLIENTS).
+    */
+    FakePlayer& GetFakePlayer(int id);
+
+    /**
+     * @brief Connects and puts the player \c id in game.
+    */
+    void ConnectPlayer(int id, const char* name, bool bot = false);
+
+    /**
+     * @brief N/D
+    */
+    void DisconnectPlayer(int id);
+
+    /**
+     * @brief Messages written through \c Log, \c LogError and \c PrintConsole.
+    */
+    const std::vector<std::string>& Messages();
+
+    /**
+     * @brief N/D
+    */
+    void ClearMessages();
+
+    /**
+     * @brief Also print the messages to stdout.
+    */
+    void SetEcho(bool echo);
+
+    /**
+     * @brief N/D
+    */
+    void SetModName(const char* mod_name);
+
+    /**
+     * @brief Sets the server's max clients (1..MAX_CLIENTS, default MAX_CLIENTS); like the core, the player
+     * functions and \c PlayerPropAddress know no player above it.
+    */
+    void SetMaxClients(int max_clients);
+
+    /**
+     * @brief N/D
+    */
+    void SetLocalInfo(const char* name, const char* value);
+
+    /**
+     * @brief Drops the plugins, forwards, players and messages and restores the max clients; the module and its
+     * natives stay registered.
+    */
+    void ResetState();
+}
@@ -0,0 +1,392 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/amx_analyzer.h>
+#include <amxx/amx_index.h>
+#include <amxx/amx_interpreter.h>
+#include <amxx/amxx_file.h>
+#include <amxx/api.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+
+namespace
+{
+    using namespace amx;
+
+    /**
+     * @brief Position of the code cell a backward jump goes to, or -1 if \c opcode is not one.
+    */
+    std::ptrdiff_t BackwardTarget(const cell* const code, const std::size_t position, const Opcode opcode)
+    {
+        if (!IsCodeReference(opcode) || opcode == Opcode::Call || opcode == Opcode::Switch) {
+            return -1;
+        }
+
+        auto offset = static_cast<std::ptrdiff_t>(code[position + 1]);
+
+        if (opcode == Opcode::Jrel) {
+            offset += static_cast<std::ptrdiff_t>((position + 2) * sizeof(cell));
+        }
+
+        const auto target = offset / static_cast<std::ptrdiff_t>(sizeof(cell));
+
+        return offset >= 0 && target <= static_cast<std::ptrdiff_t>(position) ? target : -1;
+    }
+
+    bool MoreLoopCalls(const NativeUsage& a, const NativeUsage& b)
+    {
+        if (a.loop_call_sites != b.loop_call_sites) {
+            return a.loop_call_sites > b.loop_call_sites;
+        }
+
+        if (a.call_sites != b.call_sites) {
+            return a.call_sites > b.call_sites;
+        }
+
+        return a.name < b.name;
+    }
+
+    void AppendJsonString(std::string& out, const std::string& text)
+    {
+        out += '"';
+
+        for (const auto ch : text) {
+            const auto byte = static_cast<unsigned char>(ch);
+
+            if (byte == '"' || byte == '\\') {
+                out += '\\';
+                out += ch;
+            }
+            else if (byte < 0x20) {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", byte);
+                out += escape;
+            }
+            else {
+                out += ch;
+            }
+        }
+
+        out += '"';
+    }
+
+    /**
+     * @brief Appends \c format to \c out, formatted through a line buffer.
+    */
+    template <typename... TArgs>
+    void AppendLine(std::string& out, const char* const format, TArgs... args)
+    {
+        char line[256];
+        std::snprintf(line, sizeof(line), format, args...);
+        out += line;
+    }
+}
+
+namespace amx
+{
+    std::size_t ImageReport::LoopCallSites() const
+    {
+        std::size_t sites = 0;
+
+        for (const auto& native : natives) {
+            sites += native.loop_call_sites;
+        }
+
+        return sites;
+    }
+
+    AmxError AnalyzeImage(const unsigned char* const image, const std::size_t size, ImageReport& report)
+    {
+        if (!image || size < sizeof(AmxHeader) || reinterpret_cast<std::uintptr_t>(image) % alignof(cell)) {
+            return AmxError::Init;
+        }
+
+        const auto& header = *reinterpret_cast<const AmxHeader*>(image);
+
+        // Only the tables and the code have to be there, not the data, heap and stack.
+        if (const auto error = ValidateHeader(header, SIZE_MAX); error != AmxError::None) {
+            return error;
+        }
+
+        if (static_cast<std::size_t>(header.dat) > size || (header.flags & AMX_FLAG_COMPACT)) {
+            return AmxError::Format;
+        }
+
+        Amx amx{};
+        amx.base = const_cast<unsigned char*>(image);
+        const amxx::AmxIndex index{&amx};
+
+        const auto* const code = reinterpret_cast<const cell*>(image + header.cod);
+        const auto cells = static_cast<std::size_t>(header.dat - header.cod) / sizeof(cell);
+
+        std::vector<std::size_t> procs{};
+        std::vector<std::pair<std::size_t, cell>> sysreqs{};
+        std::vector<int> loop_edges(cells + 1, 0);
+
+        report.code_size = cells * sizeof(cell);
+        report.instructions = 0;
+        report.dynamic_calls = 0;
+
+        for (std::size_t i = 0; i < cells;) {
+            if (code[i] < 0 || code[i] >= static_cast<cell>(Opcode::Count)) {
+                return AmxError::InvalidInstr;
+            }
+
+            const auto opcode = static_cast<Opcode>(code[i]);
+            std::size_t length;
+
+            ++report.instructions;
+
+            if (opcode == Opcode::Casetbl) {
+                if (i + 1 >= cells || code[i + 1] < 0) {
+                    return AmxError::InvalidInstr;
+                }
+
+                length = 3 + 2 * static_cast<std::size_t>(code[i + 1]);
+            }
+            else if (opcode == Opcode::File || opcode == Opcode::Symbol) {
+                if (i + 1 >= cells || code[i + 1] < 0 || code[i + 1] % sizeof(cell)) {
+                    return AmxError::InvalidInstr;
+                }
+
+                length = 2 + static_cast<std::size_t>(code[i + 1]) / sizeof(cell);
+            }
+            else {
+                length = 1 + static_cast<std::size_t>(OpcodeOperands(opcode));
+            }
+
+            if (i + length > cells) {
+                return AmxError::InvalidInstr;
+            }
+
+            switch (opcode) {
+            case Opcode::Proc:
+                procs.push_back(i);
+                break;
+
+            case Opcode::SysreqC:
+                if (code[i + 1] < 0 || code[i + 1] >= index.NativeCount()) {
+                    return AmxError::InvalidInstr;
+                }
+
+                sysreqs.emplace_back(i, code[i + 1]);
+                break;
+
+            case Opcode::SysreqPri:
+            case Opcode::SysreqD:
+                ++report.dynamic_calls;
+                break;
+
+            default:
+                // The body of a loop runs from the target of the jump back to the jump itself.
+                if (const auto target = BackwardTarget(code, i, opcode); target >= 0) {
+                    ++loop_edges[static_cast<std::size_t>(target)];
+                    --loop_edges[i + 1];
+                }
+
+                break;
+            }
+
+            i += length;
+        }
+
+        // Loop depth of every code cell.
+        for (std::size_t i = 1; i <= cells; ++i) {
+            loop_edges[i] += loop_edges[i - 1];
+        }
+
+        report.natives.assign(static_cast<std::size_t>(index.NativeCount()), {});
+
+        for (auto i = 0; i < index.NativeCount(); ++i) {
+            report.natives[static_cast<std::size_t>(i)].name = index.NativeName(i);
+        }
+
+        for (const auto& [position, native] : sysreqs) {
+            auto& usage = report.natives[static_cast<std::size_t>(native)];
+            ++usage.call_sites;
+
+            if (loop_edges[position] > 0) {
+                ++usage.loop_call_sites;
+            }
+        }
+
+        std::sort(report.natives.begin(), report.natives.end(), MoreLoopCalls);
+
+        report.publics.clear();
+        report.publics.reserve(static_cast<std::size_t>(index.PublicCount()));
+
+        for (auto i = 0; i < index.PublicCount(); ++i) {
+            const auto address = index.PublicAddress(i);
+            const auto begin = static_cast<std::size_t>(address) / sizeof(cell);
+            const auto next = std::upper_bound(procs.begin(), procs.end(), begin);
+            const auto end = next != procs.end() ? *next : cells;
+            const auto first = std::lower_bound(sysreqs.begin(), sysreqs.end(), std::make_pair(begin, cell{-1}));
+            const auto last = std::lower_bound(sysreqs.begin(), sysreqs.end(), std::make_pair(end, cell{-1}));
+
+            report.publics.push_back({index.PublicName(i), address, end > begin ? (end - begin) * sizeof(cell) : 0,
+                                      static_cast<std::size_t>(last - first)});
+        }
+
+        return AmxError::None;
+    }
+
+    AmxError AnalyzeFile(const char* const path, ImageReport& report)
+    {
+        const AmxxFile file{path};
+        std::vector<cell> image{};
+
+        if (const auto error = file.Load(image); error != AmxError::None) {
+            return error;
+        }
+
+        auto* const bytes = reinterpret_cast<unsigned char*>(image.data());
+        auto& header = *reinterpret_cast<AmxHeader*>(bytes);
+
+        if (header.flags & AMX_FLAG_COMPACT) {
+            if (!ExpandCompact(bytes + header.cod, static_cast<std::size_t>(header.size - header.cod),
+                               static_cast<std::size_t>(header.hea - header.cod))) {
+                return AmxError::Format;
+            }
+
+            header.flags = static_cast<std::int16_t>(header.flags & ~AMX_FLAG_COMPACT);
+            header.size = header.hea;
+        }
+
+        report.plugin = amxx::FilenameFromPath(path);
+
+        return AnalyzeImage(bytes, image.size() * sizeof(cell), report);
+    }
+
+    std::string ImageReportText(const std::vector<ImageReport>& reports)
+    {
+        std::map<std::string, NativeUsage> totals{};
+
+        for (const auto& report : reports) {
+            for (const auto& native : report.natives) {
+                auto& total = totals[native.name];
+                total.name = native.name;
+                total.call_sites += native.call_sites;
+                total.loop_call_sites += native.loop_call_sites;
+            }
+        }
+
+        std::vector<NativeUsage> natives{};
+        natives.reserve(totals.size());
+
+        for (auto& [name, usage] : totals) {
+            natives.push_back(std::move(usage));
+        }
+
+        std::sort(natives.begin(), natives.end(), MoreLoopCalls);
+
+        std::string text{};
+        AppendLine(text, "%-32s %10s %10s\n", "native", "sites", "in loops");
+
+        for (const auto& native : natives) {
+            AppendLine(text, "%-32s %10zu %10zu\n", native.name.c_str(), native.call_sites, native.loop_call_sites);
+        }
+
+        for (const auto& report : reports) {
+            AppendLine(text, "\n%s: %zu bytes of code, %zu instructions, %zu native calls in loops, %zu dynamic calls\n",
+                       report.plugin.c_str(), report.code_size, report.instructions, report.LoopCallSites(),
+                       report.dynamic_calls);
+            AppendLine(text, "%-32s %10s %10s\n", "native", "sites", "in loops");
+
+            for (const auto& native : report.natives) {
+                AppendLine(text, "%-32s %10zu %10zu\n", native.name.c_str(), native.call_sites, native.loop_call_sites);
+            }
+
+            AppendLine(text, "%-32s %10s %10s\n", "public", "bytes", "natives");
+
+            for (const auto& function : report.publics) {
+                AppendLine(text, "%-32s %10zu %10zu\n", function.name.c_str(), function.size, function.native_calls);
+            }
+        }
+
+        return text;
+    }
+
+    std::string ImageReportJson(const std::vector<ImageReport>& reports)
+    {
+        std::string json{"{\"plugins\":["};
+
+        for (std::size_t i = 0; i < reports.size(); ++i) {
+            const auto& report = reports[i];
+
+            json += i ? ",{\"name\":" : "{\"name\":";
+            AppendJsonString(json, report.plugin);
+            AppendLine(json, ",\"code_size\":%zu,\"instructions\":%zu,\"dynamic_calls\":%zu,\"natives\":[",
+                       report.code_size, report.instructions, report.dynamic_calls);
+
+            for (std::size_t k = 0; k < report.natives.size(); ++k) {
+                const auto& native = report.natives[k];
+
+                json += k ? ",{\"name\":" : "{\"name\":";
+                AppendJsonString(json, native.name);
+                AppendLine(json, ",\"call_sites\":%zu,\"loop_call_sites\":%zu}", native.call_sites, native.loop_call_sites);
+            }
+
+            json += "],\"publics\":[";
+
+            for (std::size_t k = 0; k < report.publics.size(); ++k) {
+                const auto& function = report.publics[k];
+
+                json += k ? ",{\"name\":" : "{\"name\":";
+                AppendJsonString(json, function.name);
+                AppendLine(json, ",\"address\":%u,\"size\":%zu,\"native_calls\":%zu}", static_cast<unsigned>(function.address),
+                           function.size, function.native_calls);
+            }
+
+            json += "]}";
+        }
+
+        json += "]}";
+
+        return json;
+    }
+}
+
+namespace amxx
+{
+    std::vector<amx::ImageReport> AnalyzeLoadedPlugins(const char* const plugins_dir)
+    {
+        std::vector<amx::ImageReport> reports{};
+
+        for (auto id = 0; GetAmxScript(id); ++id) {
+            const auto* const name = GetAmxScriptName(id);
+            amx::ImageReport report{};
+
+            if (!name) {
+                continue;
+            }
+
+            if (amx::AnalyzeFile(name, report) != AmxError::None) {
+                const auto path = std::string{plugins_dir} + '/' + GetAmxScriptName(id, true);
+
+                if (amx::AnalyzeFile(path.c_str(), report) != AmxError::None) {
+                    continue;
+                }
+            }
+
+            reports.push_back(std::move(report));
+        }
+
+        return reports;
+    }
+}
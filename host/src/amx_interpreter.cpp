@@ -0,0 +1,1321 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/amx_index.h>
+#include <amxx/amx_interpreter.h>
+#include <amxx/amxx_file.h>
+#include <amxx/os_defs.h>
+#include <amxx/plugin_local.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(GCC_COMPILER) || defined(CLANG_COMPILER) || defined(INTEL_COMPILER)
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define AMX_COMPUTED_GOTO
+#endif
+
+namespace
+{
+    /**
+     * @brief Values that may still have to be stored while expanding a compact image in place.
+    */
+    constexpr std::size_t COMPACT_MARGIN = 64;
+
+    /**
+     * @brief Handler addresses, indexed by opcode; filled by the first call of \c Interpreter::Run.
+    */
+    const void* const* g_handlers{};
+
+    /**
+     * @brief Interpreter of every initialized Amx; kept in a PluginLocal so that the registry holds the only
+     * Amx::user_data slot.
+    */
+    amxx::PluginLocal<amx::Interpreter*> g_interpreters{};
+
+    std::intptr_t Handler(const amx::Opcode opcode)
+    {
+#ifdef AMX_COMPUTED_GOTO
+        return reinterpret_cast<std::intptr_t>(g_handlers[static_cast<std::size_t>(opcode)]);
+#else
+        return static_cast<std::intptr_t>(opcode);
+#endif
+    }
+}
+
+namespace amx
+{
+    Interpreter::~Interpreter()
+    {
+        if (amx_ && GetInterpreter(amx_) == this) {
+            g_interpreters.Reset(amx_);
+        }
+    }
+
+    AmxError Interpreter::Init(Amx* const amx, unsigned char* const image, const std::size_t image_size)
+    {
+        if (!amx || !image || image_size < sizeof(AmxHeader) || reinterpret_cast<std::uintptr_t>(image) % alignof(cell)) {
+            return AmxError::Init;
+        }
+
+        auto* const header = reinterpret_cast<AmxHeader*>(image);
+
+        if (const auto error = ValidateHeader(*header, image_size); error != AmxError::None) {
+            return error;
+        }
+
+        if (header->flags & AMX_FLAG_COMPACT) {
+            if (!ExpandCompact(image + header->cod, static_cast<std::size_t>(header->size - header->cod),
+                               static_cast<std::size_t>(header->hea - header->cod))) {
+                return AmxError::Format;
+            }
+
+            header->flags = static_cast<std::int16_t>(header->flags & ~AMX_FLAG_COMPACT);
+            header->size = header->hea;
+        }
+
+        amx_ = amx;
+        code_ = image + header->cod;
+        code_size_ = static_cast<std::size_t>(header->dat - header->cod);
+
+        amx->base = image;
+        amx->data = nullptr;
+        amx->cip = header->cip;
+        amx->frm = 0;
+        amx->hlw = amx->hea = header->hea - header->dat;
+        amx->stp = header->stp - header->dat - static_cast<cell>(sizeof(cell));
+        amx->stk = amx->stp;
+        amx->reset_stk = amx->stk;
+        amx->reset_hea = amx->hea;
+        amx->param_count = 0;
+        amx->error = static_cast<int>(AmxError::None);
+        amx->flags = header->flags | AMX_FLAG_RELOC;
+
+        const amxx::AmxIndex index{amx};
+
+        public_addresses_.resize(static_cast<std::size_t>(index.PublicCount()));
+        native_names_.resize(static_cast<std::size_t>(index.NativeCount()));
+        natives_.assign(native_names_.size(), nullptr);
+
+        for (auto i = 0; i < index.PublicCount(); ++i) {
+            public_addresses_[i] = index.PublicAddress(i);
+        }
+
+        for (auto i = 0; i < index.NativeCount(); ++i) {
+            native_names_[i] = index.NativeName(i);
+        }
+
+        if (const auto error = Relocate(); error != AmxError::None) {
+            amx_ = nullptr;
+            return error;
+        }
+
+        g_interpreters.Get(amx) = this;
+
+        return AmxError::None;
+    }
+
+    AmxError Interpreter::Relocate()
+    {
+        if (!g_handlers) {
+            Run(nullptr, nullptr, 0, 0, 0, 0, 0, 0, 0);
+        }
+
+        const auto* const code = reinterpret_cast<const cell*>(code_);
+        const auto cells = code_size_ / sizeof(cell);
+        std::vector<std::size_t> switches{};
+
+        threaded_.assign(cells, 0);
+        sysreq_sites_.clear();
+
+        const auto target = [this](const cell offset, std::intptr_t& out) {
+            if (offset < 0 || static_cast<std::size_t>(offset) >= code_size_ || offset % sizeof(cell)) {
+                return false;
+            }
+
+            out = reinterpret_cast<std::intptr_t>(threaded_.data() + offset / sizeof(cell));
+            return true;
+        };
+
+        for (std::size_t i = 0; i < cells;) {
+            if (code[i] < 0 || code[i] >= static_cast<cell>(Opcode::Count)) {
+                return AmxError::InvalidInstr;
+            }
+
+            const auto opcode = static_cast<Opcode>(code[i]);
+            threaded_[i] = Handler(opcode);
+
+            switch (opcode) {
+            // Only ever produced by binding a native.
+            case Opcode::SysreqD:
+                return AmxError::InvalidInstr;
+
+            case Opcode::Casetbl: {
+                if (i + 2 >= cells || code[i + 1] < 0 || i + 3 + 2 * static_cast<std::size_t>(code[i + 1]) > cells) {
+                    return AmxError::InvalidInstr;
+                }
+
+                const auto count = static_cast<std::size_t>(code[i + 1]);
+                threaded_[i + 1] = code[i + 1];
+
+                if (!target(code[i + 2], threaded_[i + 2])) {
+                    return AmxError::InvalidInstr;
+                }
+
+                for (std::size_t k = 0; k < count; ++k) {
+                    threaded_[i + 3 + 2 * k] = code[i + 3 + 2 * k];
+
+                    if (!target(code[i + 4 + 2 * k], threaded_[i + 4 + 2 * k])) {
+                        return AmxError::InvalidInstr;
+                    }
+                }
+
+                i += 3 + 2 * count;
+                continue;
+            }
+
+            // Debug information in old images; jump over it.
+            case Opcode::File:
+            case Opcode::Symbol: {
+                if (i + 1 >= cells || code[i + 1] < 0 || code[i + 1] % sizeof(cell)) {
+                    return AmxError::InvalidInstr;
+                }
+
+                const auto next = i + 2 + static_cast<std::size_t>(code[i + 1]) / sizeof(cell);
+
+                if (next > cells) {
+                    return AmxError::InvalidInstr;
+                }
+
+                threaded_[i] = Handler(Opcode::Jump);
+                threaded_[i + 1] = reinterpret_cast<std::intptr_t>(threaded_.data() + next);
+                i = next;
+                continue;
+            }
+
+            default:
+                break;
+            }
+
+            const auto operands = static_cast<std::size_t>(OpcodeOperands(opcode));
+
+            if (i + operands >= cells + (operands ? 0 : 1)) {
+                return AmxError::InvalidInstr;
+            }
+
+            if (IsCodeReference(opcode)) {
+                auto offset = code[i + 1];
+
+                if (opcode == Opcode::Jrel) {
+                    offset += static_cast<cell>((i + 2) * sizeof(cell));
+                    threaded_[i] = Handler(Opcode::Jump);
+                }
+
+                if (!target(offset, threaded_[i + 1])) {
+                    return AmxError::InvalidInstr;
+                }
+
+                if (opcode == Opcode::Switch) {
+                    switches.push_back(static_cast<std::size_t>(offset) / sizeof(cell));
+                }
+            }
+            else {
+                for (std::size_t k = 1; k <= operands; ++k) {
+                    threaded_[i + k] = code[i + k];
+                }
+            }
+
+            if (opcode == Opcode::SysreqC) {
+                if (code[i + 1] < 0 || static_cast<std::size_t>(code[i + 1]) >= natives_.size()) {
+                    return AmxError::InvalidInstr;
+                }
+
+                sysreq_sites_.emplace_back(i, code[i + 1]);
+            }
+
+            i += 1 + operands;
+        }
+
+        for (const auto position : switches) {
+            if (code[position] != static_cast<cell>(Opcode::Casetbl)) {
+                return AmxError::InvalidInstr;
+            }
+        }
+
+        return AmxError::None;
+    }
+
+    void Interpreter::RegisterNatives(const AmxNativeInfo* list)
+    {
+        for (; list && list->name; ++list) {
+            for (std::size_t i = 0; i < native_names_.size(); ++i) {
+                if (std::strcmp(native_names_[i], list->name) == 0) {
+                    BindNative(i, list->func);
+                }
+            }
+        }
+    }
+
+    std::size_t Interpreter::ResolveNatives(const std::function<AmxNative(const char* name)>& resolve)
+    {
+        for (std::size_t i = 0; i < natives_.size(); ++i) {
+            if (!natives_[i]) {
+                if (const auto func = resolve(native_names_[i])) {
+                    BindNative(i, func);
+                }
+            }
+        }
+
+        return UnboundNativeCount();
+    }
+
+    std::size_t Interpreter::UnboundNativeCount() const
+    {
+        return static_cast<std::size_t>(std::count(natives_.begin(), natives_.end(), nullptr));
+    }
+
+    void Interpreter::BindNative(const std::size_t index, const AmxNative func)
+    {
+        natives_[index] = func;
+
+        // With a callback installed every call must go through it, so the sites stay SYSREQ.C.
+        if (amx_->callback) {
+            return;
+        }
+
+        for (const auto& [position, native] : sysreq_sites_) {
+            if (static_cast<std::size_t>(native) == index) {
+                threaded_[position] = Handler(Opcode::SysreqD);
+                threaded_[position + 1] = reinterpret_cast<std::intptr_t>(func);
+            }
+        }
+    }
+
+    AmxError Interpreter::CallNative(const int index, cell* const result, cell* const params)
+    {
+        if (amx_->callback) {
+            return static_cast<AmxError>(amx_->callback(amx_, index, result, params));
+        }
+
+        if (index < 0 || static_cast<std::size_t>(index) >= natives_.size() || !natives_[index]) {
+            return AmxError::NotFound;
+        }
+
+        amx_->error = static_cast<int>(AmxError::None);
+        *result = natives_[index](amx_, params);
+
+        return static_cast<AmxError>(amx_->error);
+    }
+
+    AmxError Interpreter::Push(const cell value)
+    {
+        if (amx_->stk - static_cast<cell>(sizeof(cell)) < amx_->hea + AMX_STACK_MARGIN) {
+            return AmxError::StackErr;
+        }
+
+        amx_->stk -= static_cast<cell>(sizeof(cell));
+        *Address(amx_, amx_->stk) = value;
+        ++amx_->param_count;
+
+        return AmxError::None;
+    }
+
+    AmxError Interpreter::Exec(cell* const return_val, const int index)
+    {
+        if (!amx_) {
+            return AmxError::Init;
+        }
+
+        const auto* const threaded = threaded_.data();
+
+        if (index == AMX_EXEC_CONT) {
+            if (amx_->cip < 0 || static_cast<std::size_t>(amx_->cip) >= code_size_) {
+                return AmxError::InvalidState;
+            }
+
+            return static_cast<AmxError>(Run(return_val, threaded + amx_->cip / sizeof(cell), amx_->pri, amx_->alt,
+                                             amx_->frm, amx_->stk, amx_->hea, amx_->reset_stk, amx_->reset_hea));
+        }
+
+        const auto pushed = static_cast<cell>(amx_->param_count * sizeof(cell));
+        const auto reset_stk = amx_->stk + pushed;
+        const auto reset_hea = amx_->hea;
+        cell address{};
+
+        amx_->param_count = 0;
+
+        if (index == AMX_EXEC_MAIN) {
+            address = reinterpret_cast<const AmxHeader*>(amx_->base)->cip;
+        }
+        else if (index >= 0 && index < PublicCount()) {
+            address = static_cast<cell>(public_addresses_[index]);
+        }
+        else {
+            amx_->stk = reset_stk;
+            return AmxError::Index;
+        }
+
+        if (address < 0 || static_cast<std::size_t>(address) >= code_size_ || address % sizeof(cell)) {
+            amx_->stk = reset_stk;
+            return index == AMX_EXEC_MAIN ? AmxError::NotFound : AmxError::MemAccess;
+        }
+
+        auto stk = amx_->stk;
+
+        if (stk - static_cast<cell>(2 * sizeof(cell)) < amx_->hea + AMX_STACK_MARGIN) {
+            amx_->stk = reset_stk;
+            return AmxError::StackErr;
+        }
+
+        // Argument byte count, then a zero return address: the code section starts with HALT.
+        stk -= static_cast<cell>(sizeof(cell));
+        *Address(amx_, stk) = pushed;
+        stk -= static_cast<cell>(sizeof(cell));
+        *Address(amx_, stk) = 0;
+
+        return static_cast<AmxError>(Run(return_val, threaded + address / sizeof(cell), 0, 0, amx_->frm, stk, amx_->hea,
+                                         reset_stk, reset_hea));
+    }
+
+    int Interpreter::Run(cell* const return_val, const std::intptr_t* cip, cell pri, cell alt, cell frm, cell stk,
+                         cell hea, const cell reset_stk, const cell reset_hea)
+    {
+#ifdef AMX_COMPUTED_GOTO
+        // Same order as amx::Opcode.
+        static const void* const HANDLERS[] = {
+            &&op_None,     &&op_LoadPri,   &&op_LoadAlt,   &&op_LoadSPri,  &&op_LoadSAlt,   &&op_LrefPri,    &&op_LrefAlt,
+            &&op_LrefSPri, &&op_LrefSAlt,  &&op_LoadI,     &&op_LodbI,     &&op_ConstPri,   &&op_ConstAlt,   &&op_AddrPri,
+            &&op_AddrAlt,  &&op_StorPri,   &&op_StorAlt,   &&op_StorSPri,  &&op_StorSAlt,   &&op_SrefPri,    &&op_SrefAlt,
+            &&op_SrefSPri, &&op_SrefSAlt,  &&op_StorI,     &&op_StrbI,     &&op_Lidx,       &&op_LidxB,      &&op_Idxaddr,
+            &&op_IdxaddrB, &&op_AlignPri,  &&op_AlignAlt,  &&op_Lctrl,     &&op_Sctrl,      &&op_MovePri,    &&op_MoveAlt,
+            &&op_Xchg,     &&op_PushPri,   &&op_PushAlt,   &&op_PushR,     &&op_PushC,      &&op_Push,       &&op_PushS,
+            &&op_PopPri,   &&op_PopAlt,    &&op_Stack,     &&op_Heap,      &&op_Proc,       &&op_Ret,        &&op_Retn,
+            &&op_Call,     &&op_CallPri,   &&op_Jump,      &&op_Jrel,      &&op_Jzer,       &&op_Jnz,        &&op_Jeq,
+            &&op_Jneq,     &&op_Jless,     &&op_Jleq,      &&op_Jgrtr,     &&op_Jgeq,       &&op_Jsless,     &&op_Jsleq,
+            &&op_Jsgrtr,   &&op_Jsgeq,     &&op_Shl,       &&op_Shr,       &&op_Sshr,       &&op_ShlCPri,    &&op_ShlCAlt,
+            &&op_ShrCPri,  &&op_ShrCAlt,   &&op_Smul,      &&op_Sdiv,      &&op_SdivAlt,    &&op_Umul,       &&op_Udiv,
+            &&op_UdivAlt,  &&op_Add,       &&op_Sub,       &&op_SubAlt,    &&op_And,        &&op_Or,         &&op_Xor,
+            &&op_Not,      &&op_Neg,       &&op_Invert,    &&op_AddC,      &&op_SmulC,      &&op_ZeroPri,    &&op_ZeroAlt,
+            &&op_Zero,     &&op_ZeroS,     &&op_SignPri,   &&op_SignAlt,   &&op_Eq,         &&op_Neq,        &&op_Less,
+            &&op_Leq,      &&op_Grtr,      &&op_Geq,       &&op_Sless,     &&op_Sleq,       &&op_Sgrtr,      &&op_Sgeq,
+            &&op_EqCPri,   &&op_EqCAlt,    &&op_IncPri,    &&op_IncAlt,    &&op_Inc,        &&op_IncS,       &&op_IncI,
+            &&op_DecPri,   &&op_DecAlt,    &&op_Dec,       &&op_DecS,      &&op_DecI,       &&op_Movs,       &&op_Cmps,
+            &&op_Fill,     &&op_Halt,      &&op_Bounds,    &&op_SysreqPri, &&op_SysreqC,    &&op_File,       &&op_Line,
+            &&op_Symbol,   &&op_Srange,    &&op_JumpPri,   &&op_Switch,    &&op_Casetbl,    &&op_SwapPri,    &&op_SwapAlt,
+            &&op_PushAdr,  &&op_Nop,       &&op_SysreqD,   &&op_Symtag,    &&op_Break,      &&op_FloatMul,   &&op_FloatDiv,
+            &&op_FloatAdd, &&op_FloatSub,  &&op_FloatTo,   &&op_FloatRound, &&op_FloatCmp};
+
+        static_assert(sizeof(HANDLERS) / sizeof(HANDLERS[0]) == static_cast<std::size_t>(Opcode::Count));
+
+        if (!cip) {
+            g_handlers = HANDLERS;
+            return 0;
+        }
+
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define OP(name) op_##name
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define NEXT() goto* reinterpret_cast<const void*>(*cip++)
+#else
+        if (!cip) {
+            return 0;
+        }
+
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define OP(name) case Opcode::name
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define NEXT() continue
+#endif
+
+        auto* const data = amx_->data ? amx_->data : amx_->base + reinterpret_cast<const AmxHeader*>(amx_->base)->dat;
+        const auto* const threaded = threaded_.data();
+        const auto stp = amx_->stp;
+        const auto hlw = amx_->hlw;
+
+        const auto mem = [data](const cell address) -> cell& {
+            return *reinterpret_cast<cell*>(data + address);
+        };
+
+        const auto offset_of = [threaded](const std::intptr_t* const ptr) {
+            return static_cast<cell>((ptr - threaded) * sizeof(cell));
+        };
+
+        const auto jump_target = [](const std::intptr_t operand) {
+            return reinterpret_cast<const std::intptr_t*>(operand);
+        };
+
+        const auto valid_code = [this](const cell offset) {
+            return offset >= 0 && static_cast<std::size_t>(offset) < code_size_ && offset % sizeof(cell) == 0;
+        };
+
+        // Indirect accesses must stay out of the gap between the heap and the stack, and below the stack top.
+        const auto invalid_range = [&hea, &stk, stp](const cell address, const cell size) {
+            const auto last = address + size - 1;
+            return (address >= hea && address < stk) || static_cast<ucell>(address) >= static_cast<ucell>(stp) ||
+                (last >= hea && last < stk) || static_cast<ucell>(last) >= static_cast<ucell>(stp) || size < 0;
+        };
+
+        const auto abort = [&](const AmxError error) {
+            amx_->cip = offset_of(cip);
+            amx_->frm = frm;
+            amx_->pri = pri;
+            amx_->alt = alt;
+            amx_->stk = reset_stk;
+            amx_->hea = reset_hea;
+            return static_cast<int>(error);
+        };
+
+        const auto save_state = [&]() {
+            amx_->cip = offset_of(cip);
+            amx_->frm = frm;
+            amx_->stk = stk;
+            amx_->hea = hea;
+        };
+
+        const auto sleep = [&]() {
+            save_state();
+            amx_->pri = pri;
+            amx_->alt = alt;
+            amx_->reset_stk = reset_stk;
+            amx_->reset_hea = reset_hea;
+            return static_cast<int>(AmxError::Sleep);
+        };
+
+        // Pawn division rounds toward negative infinity; the remainder takes the sign of the divisor.
+        const auto floored_divide = [&pri, &alt](const cell dividend, const cell divisor) {
+            // Negated with wraparound: the hardware traps on the minimum cell divided by -1.
+            if (divisor == -1) {
+                pri = static_cast<cell>(0 - static_cast<ucell>(dividend));
+                alt = 0;
+                return;
+            }
+
+            pri = dividend / divisor;
+            alt = dividend % divisor;
+
+            if (alt != 0 && (alt ^ divisor) < 0) {
+                --pri;
+                alt += divisor;
+            }
+        };
+
+        cell value{};
+        cell address{};
+
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define OPERAND() static_cast<cell>(*cip++)
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define PUSH(v) (stk -= static_cast<cell>(sizeof(cell)), mem(stk) = (v))
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define POP(v) ((v) = mem(stk), stk += static_cast<cell>(sizeof(cell)))
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define CHECK_MARGIN()                                                                                                         \
+    if (UNLIKELY(hea + AMX_STACK_MARGIN > stk))                                                                                \
+    return abort(AmxError::StackErr)
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define CHECK_STACK()                                                                                                          \
+    if (UNLIKELY(stk > stp))                                                                                                   \
+    return abort(AmxError::StackLow)
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define CHECK_HEAP()                                                                                                           \
+    if (UNLIKELY(hea < hlw))                                                                                                   \
+    return abort(AmxError::HeapLow)
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define CHECK_ACCESS(a, size)                                                                                                  \
+    if (UNLIKELY(invalid_range((a), (size))))                                                                                  \
+    return abort(AmxError::MemAccess)
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define JUMP_IF(condition)                                                                                                     \
+    cip = (condition) ? jump_target(*cip) : cip + 1;                                                                           \
+    NEXT()
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define JUMP_TO_OFFSET(offset)                                                                                                 \
+    if (UNLIKELY(!valid_code(offset)))                                                                                         \
+        return abort(AmxError::MemAccess);                                                                                     \
+    cip = threaded + (offset) / sizeof(cell);                                                                                  \
+    NEXT()
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define NATIVE_RETURNED()                                                                                                      \
+    hea = amx_->hea;                                                                                                           \
+    if (UNLIKELY(error != AmxError::None))                                                                                     \
+        return error == AmxError::Sleep ? sleep() : abort(error);                                                              \
+    NEXT()
+
+#ifdef AMX_COMPUTED_GOTO
+        NEXT();
+#else
+        for (;;) {
+            switch (static_cast<Opcode>(*cip++)) {
+#endif
+
+        OP(None) : OP(Casetbl) : return abort(AmxError::InvalidInstr);
+
+        OP(LoadPri) : pri = mem(OPERAND());
+        NEXT();
+
+        OP(LoadAlt) : alt = mem(OPERAND());
+        NEXT();
+
+        OP(LoadSPri) : pri = mem(frm + OPERAND());
+        NEXT();
+
+        OP(LoadSAlt) : alt = mem(frm + OPERAND());
+        NEXT();
+
+        OP(LrefPri) : pri = mem(mem(OPERAND()));
+        NEXT();
+
+        OP(LrefAlt) : alt = mem(mem(OPERAND()));
+        NEXT();
+
+        OP(LrefSPri) : pri = mem(mem(frm + OPERAND()));
+        NEXT();
+
+        OP(LrefSAlt) : alt = mem(mem(frm + OPERAND()));
+        NEXT();
+
+        OP(LoadI) : CHECK_ACCESS(pri, static_cast<cell>(sizeof(cell)));
+        pri = mem(pri);
+        NEXT();
+
+        OP(LodbI) : value = OPERAND();
+        CHECK_ACCESS(pri, value);
+
+        switch (value) {
+        case 1:
+            pri = *(data + pri);
+            break;
+
+        case 2:
+            pri = *reinterpret_cast<std::uint16_t*>(data + pri);
+            break;
+
+        case 4:
+            pri = mem(pri);
+            break;
+
+        default:
+            return abort(AmxError::InvalidInstr);
+        }
+
+        NEXT();
+
+        OP(ConstPri) : pri = OPERAND();
+        NEXT();
+
+        OP(ConstAlt) : alt = OPERAND();
+        NEXT();
+
+        OP(AddrPri) : pri = frm + OPERAND();
+        NEXT();
+
+        OP(AddrAlt) : alt = frm + OPERAND();
+        NEXT();
+
+        OP(StorPri) : mem(OPERAND()) = pri;
+        NEXT();
+
+        OP(StorAlt) : mem(OPERAND()) = alt;
+        NEXT();
+
+        OP(StorSPri) : mem(frm + OPERAND()) = pri;
+        NEXT();
+
+        OP(StorSAlt) : mem(frm + OPERAND()) = alt;
+        NEXT();
+
+        OP(SrefPri) : mem(mem(OPERAND())) = pri;
+        NEXT();
+
+        OP(SrefAlt) : mem(mem(OPERAND())) = alt;
+        NEXT();
+
+        OP(SrefSPri) : mem(mem(frm + OPERAND())) = pri;
+        NEXT();
+
+        OP(SrefSAlt) : mem(mem(frm + OPERAND())) = alt;
+        NEXT();
+
+        OP(StorI) : CHECK_ACCESS(alt, static_cast<cell>(sizeof(cell)));
+        mem(alt) = pri;
+        NEXT();
+
+        OP(StrbI) : value = OPERAND();
+        CHECK_ACCESS(alt, value);
+
+        switch (value) {
+        case 1:
+            *(data + alt) = static_cast<unsigned char>(pri);
+            break;
+
+        case 2:
+            *reinterpret_cast<std::uint16_t*>(data + alt) = static_cast<std::uint16_t>(pri);
+            break;
+
+        case 4:
+            mem(alt) = pri;
+            break;
+
+        default:
+            return abort(AmxError::InvalidInstr);
+        }
+
+        NEXT();
+
+        OP(Lidx) : address = alt + pri * static_cast<cell>(sizeof(cell));
+        CHECK_ACCESS(address, static_cast<cell>(sizeof(cell)));
+        pri = mem(address);
+        NEXT();
+
+        OP(LidxB) : address = alt + (pri << OPERAND());
+        CHECK_ACCESS(address, static_cast<cell>(sizeof(cell)));
+        pri = mem(address);
+        NEXT();
+
+        OP(Idxaddr) : pri = alt + pri * static_cast<cell>(sizeof(cell));
+        NEXT();
+
+        OP(IdxaddrB) : pri = alt + (pri << OPERAND());
+        NEXT();
+
+        OP(AlignPri) : value = OPERAND();
+
+        if (value < static_cast<cell>(sizeof(cell))) {
+            pri ^= static_cast<cell>(sizeof(cell)) - value;
+        }
+
+        NEXT();
+
+        OP(AlignAlt) : value = OPERAND();
+
+        if (value < static_cast<cell>(sizeof(cell))) {
+            alt ^= static_cast<cell>(sizeof(cell)) - value;
+        }
+
+        NEXT();
+
+        OP(Lctrl) : switch (OPERAND()) {
+        case 0:
+            pri = reinterpret_cast<const AmxHeader*>(amx_->base)->cod;
+            break;
+
+        case 1:
+            pri = reinterpret_cast<const AmxHeader*>(amx_->base)->dat;
+            break;
+
+        case 2:
+            pri = hea;
+            break;
+
+        case 3:
+            pri = stp;
+            break;
+
+        case 4:
+            pri = stk;
+            break;
+
+        case 5:
+            pri = frm;
+            break;
+
+        case 6:
+            pri = offset_of(cip);
+            break;
+
+        default:
+            break;
+        }
+
+        NEXT();
+
+        OP(Sctrl) : switch (OPERAND()) {
+        case 2:
+            hea = pri;
+            break;
+
+        case 4:
+            stk = pri;
+            break;
+
+        case 5:
+            frm = pri;
+            break;
+
+        case 6:
+            JUMP_TO_OFFSET(pri);
+
+        default:
+            break;
+        }
+
+        NEXT();
+
+        OP(MovePri) : pri = alt;
+        NEXT();
+
+        OP(MoveAlt) : alt = pri;
+        NEXT();
+
+        OP(Xchg) : std::swap(pri, alt);
+        NEXT();
+
+        OP(PushPri) : PUSH(pri);
+        CHECK_MARGIN();
+        NEXT();
+
+        OP(PushAlt) : PUSH(alt);
+        CHECK_MARGIN();
+        NEXT();
+
+        OP(PushR) : for (value = OPERAND(); value > 0; --value)
+        {
+            PUSH(pri);
+        }
+
+        CHECK_MARGIN();
+        NEXT();
+
+        OP(PushC) : PUSH(OPERAND());
+        CHECK_MARGIN();
+        NEXT();
+
+        OP(Push) : PUSH(mem(OPERAND()));
+        CHECK_MARGIN();
+        NEXT();
+
+        OP(PushS) : PUSH(mem(frm + OPERAND()));
+        CHECK_MARGIN();
+        NEXT();
+
+        OP(PopPri) : POP(pri);
+        CHECK_STACK();
+        NEXT();
+
+        OP(PopAlt) : POP(alt);
+        CHECK_STACK();
+        NEXT();
+
+        OP(Stack) : alt = stk;
+        stk += OPERAND();
+        CHECK_MARGIN();
+        CHECK_STACK();
+        NEXT();
+
+        OP(Heap) : alt = hea;
+        hea += OPERAND();
+        CHECK_MARGIN();
+        CHECK_HEAP();
+        NEXT();
+
+        OP(Proc) : PUSH(frm);
+        frm = stk;
+        CHECK_MARGIN();
+        NEXT();
+
+        OP(Ret) : POP(frm);
+        POP(address);
+        CHECK_STACK();
+        JUMP_TO_OFFSET(address);
+
+        OP(Retn) : POP(frm);
+        POP(address);
+        stk += mem(stk) + static_cast<cell>(sizeof(cell));
+        CHECK_STACK();
+        JUMP_TO_OFFSET(address);
+
+        OP(Call) : PUSH(offset_of(cip + 1));
+        CHECK_MARGIN();
+        cip = jump_target(*cip);
+        NEXT();
+
+        OP(CallPri) : PUSH(offset_of(cip));
+        CHECK_MARGIN();
+        JUMP_TO_OFFSET(pri);
+
+        OP(Jump) : OP(Jrel) : cip = jump_target(*cip);
+        NEXT();
+
+        OP(Jzer) : JUMP_IF(pri == 0);
+
+        OP(Jnz) : JUMP_IF(pri != 0);
+
+        OP(Jeq) : JUMP_IF(pri == alt);
+
+        OP(Jneq) : JUMP_IF(pri != alt);
+
+        OP(Jless) : JUMP_IF(static_cast<ucell>(pri) < static_cast<ucell>(alt));
+
+        OP(Jleq) : JUMP_IF(static_cast<ucell>(pri) <= static_cast<ucell>(alt));
+
+        OP(Jgrtr) : JUMP_IF(static_cast<ucell>(pri) > static_cast<ucell>(alt));
+
+        OP(Jgeq) : JUMP_IF(static_cast<ucell>(pri) >= static_cast<ucell>(alt));
+
+        OP(Jsless) : JUMP_IF(pri < alt);
+
+        OP(Jsleq) : JUMP_IF(pri <= alt);
+
+        OP(Jsgrtr) : JUMP_IF(pri > alt);
+
+        OP(Jsgeq) : JUMP_IF(pri >= alt);
+
+        OP(Shl) : pri = static_cast<cell>(static_cast<ucell>(pri) << alt);
+        NEXT();
+
+        OP(Shr) : pri = static_cast<cell>(static_cast<ucell>(pri) >> alt);
+        NEXT();
+
+        OP(Sshr) : pri >>= alt;
+        NEXT();
+
+        OP(ShlCPri) : pri = static_cast<cell>(static_cast<ucell>(pri) << OPERAND());
+        NEXT();
+
+        OP(ShlCAlt) : alt = static_cast<cell>(static_cast<ucell>(alt) << OPERAND());
+        NEXT();
+
+        OP(ShrCPri) : pri = static_cast<cell>(static_cast<ucell>(pri) >> OPERAND());
+        NEXT();
+
+        OP(ShrCAlt) : alt = static_cast<cell>(static_cast<ucell>(alt) >> OPERAND());
+        NEXT();
+
+        OP(Smul) : pri = static_cast<cell>(static_cast<ucell>(pri) * static_cast<ucell>(alt));
+        NEXT();
+
+        OP(Sdiv) : if (UNLIKELY(alt == 0)) return abort(AmxError::Divide);
+        floored_divide(pri, alt);
+        NEXT();
+
+        OP(SdivAlt) : if (UNLIKELY(pri == 0)) return abort(AmxError::Divide);
+        floored_divide(alt, pri);
+        NEXT();
+
+        OP(Umul) : pri = static_cast<cell>(static_cast<ucell>(pri) * static_cast<ucell>(alt));
+        NEXT();
+
+        OP(Udiv) : if (UNLIKELY(alt == 0)) return abort(AmxError::Divide);
+        value = static_cast<cell>(static_cast<ucell>(pri) / static_cast<ucell>(alt));
+        alt = static_cast<cell>(static_cast<ucell>(pri) % static_cast<ucell>(alt));
+        pri = value;
+        NEXT();
+
+        OP(UdivAlt) : if (UNLIKELY(pri == 0)) return abort(AmxError::Divide);
+        value = static_cast<cell>(static_cast<ucell>(alt) / static_cast<ucell>(pri));
+        alt = static_cast<cell>(static_cast<ucell>(alt) % static_cast<ucell>(pri));
+        pri = value;
+        NEXT();
+
+        OP(Add) : pri = static_cast<cell>(static_cast<ucell>(pri) + static_cast<ucell>(alt));
+        NEXT();
+
+        OP(Sub) : pri = static_cast<cell>(static_cast<ucell>(pri) - static_cast<ucell>(alt));
+        NEXT();
+
+        OP(SubAlt) : pri = static_cast<cell>(static_cast<ucell>(alt) - static_cast<ucell>(pri));
+        NEXT();
+
+        OP(And) : pri &= alt;
+        NEXT();
+
+        OP(Or) : pri |= alt;
+        NEXT();
+
+        OP(Xor) : pri ^= alt;
+        NEXT();
+
+        OP(Not) : pri = !pri;
+        NEXT();
+
+        OP(Neg) : pri = static_cast<cell>(0U - static_cast<ucell>(pri));
+        NEXT();
+
+        OP(Invert) : pri = ~pri;
+        NEXT();
+
+        OP(AddC) : pri = static_cast<cell>(static_cast<ucell>(pri) + static_cast<ucell>(OPERAND()));
+        NEXT();
+
+        OP(SmulC) : pri = static_cast<cell>(static_cast<ucell>(pri) * static_cast<ucell>(OPERAND()));
+        NEXT();
+
+        OP(ZeroPri) : pri = 0;
+        NEXT();
+
+        OP(ZeroAlt) : alt = 0;
+        NEXT();
+
+        OP(Zero) : mem(OPERAND()) = 0;
+        NEXT();
+
+        OP(ZeroS) : mem(frm + OPERAND()) = 0;
+        NEXT();
+
+        OP(SignPri) : if (pri & 0x80) pri |= ~static_cast<cell>(0xFF);
+        NEXT();
+
+        OP(SignAlt) : if (alt & 0x80) alt |= ~static_cast<cell>(0xFF);
+        NEXT();
+
+        OP(Eq) : pri = pri == alt;
+        NEXT();
+
+        OP(Neq) : pri = pri != alt;
+        NEXT();
+
+        OP(Less) : pri = static_cast<ucell>(pri) < static_cast<ucell>(alt);
+        NEXT();
+
+        OP(Leq) : pri = static_cast<ucell>(pri) <= static_cast<ucell>(alt);
+        NEXT();
+
+        OP(Grtr) : pri = static_cast<ucell>(pri) > static_cast<ucell>(alt);
+        NEXT();
+
+        OP(Geq) : pri = static_cast<ucell>(pri) >= static_cast<ucell>(alt);
+        NEXT();
+
+        OP(Sless) : pri = pri < alt;
+        NEXT();
+
+        OP(Sleq) : pri = pri <= alt;
+        NEXT();
+
+        OP(Sgrtr) : pri = pri > alt;
+        NEXT();
+
+        OP(Sgeq) : pri = pri >= alt;
+        NEXT();
+
+        OP(EqCPri) : pri = pri == OPERAND();
+        NEXT();
+
+        OP(EqCAlt) : pri = alt == OPERAND();
+        NEXT();
+
+        OP(IncPri) : ++pri;
+        NEXT();
+
+        OP(IncAlt) : ++alt;
+        NEXT();
+
+        OP(Inc) : ++mem(OPERAND());
+        NEXT();
+
+        OP(IncS) : ++mem(frm + OPERAND());
+        NEXT();
+
+        OP(IncI) : CHECK_ACCESS(pri, static_cast<cell>(sizeof(cell)));
+        ++mem(pri);
+        NEXT();
+
+        OP(DecPri) : --pri;
+        NEXT();
+
+        OP(DecAlt) : --alt;
+        NEXT();
+
+        OP(Dec) : --mem(OPERAND());
+        NEXT();
+
+        OP(DecS) : --mem(frm + OPERAND());
+        NEXT();
+
+        OP(DecI) : CHECK_ACCESS(pri, static_cast<cell>(sizeof(cell)));
+        --mem(pri);
+        NEXT();
+
+        OP(Movs) : value = OPERAND();
+        CHECK_ACCESS(pri, value);
+        CHECK_ACCESS(alt, value);
+        std::memmove(data + alt, data + pri, static_cast<std::size_t>(value));
+        NEXT();
+
+        OP(Cmps) : value = OPERAND();
+        CHECK_ACCESS(pri, value);
+        CHECK_ACCESS(alt, value);
+        address = 0;
+
+        for (cell i = 0; i < value && address == 0; ++i) {
+            address = static_cast<cell>(data[alt + i]) - static_cast<cell>(data[pri + i]);
+        }
+
+        pri = address;
+        NEXT();
+
+        OP(Fill) : value = OPERAND();
+        CHECK_ACCESS(alt, value);
+
+        for (address = alt; value >= static_cast<cell>(sizeof(cell)); value -= static_cast<cell>(sizeof(cell))) {
+            mem(address) = pri;
+            address += static_cast<cell>(sizeof(cell));
+        }
+
+        NEXT();
+
+        OP(Halt) : value = OPERAND();
+
+        if (return_val) {
+            *return_val = pri;
+        }
+
+        if (value == static_cast<cell>(AmxError::Sleep)) {
+            return sleep();
+        }
+
+        return abort(static_cast<AmxError>(value));
+
+        OP(Bounds) : if (UNLIKELY(static_cast<ucell>(pri) > static_cast<ucell>(*cip))) return abort(AmxError::Bounds);
+        ++cip;
+        NEXT();
+
+        OP(SysreqPri) :
+        {
+            save_state();
+            const auto error = CallNative(pri, &pri, &mem(stk));
+            NATIVE_RETURNED();
+        }
+
+        OP(SysreqC) :
+        {
+            const auto index = OPERAND();
+            save_state();
+            const auto error = CallNative(index, &pri, &mem(stk));
+            NATIVE_RETURNED();
+        }
+
+        OP(SysreqD) :
+        {
+            const auto func = reinterpret_cast<AmxNative>(*cip++);
+            save_state();
+            amx_->error = static_cast<int>(AmxError::None);
+            pri = func(amx_, &mem(stk));
+            const auto error = static_cast<AmxError>(amx_->error);
+            NATIVE_RETURNED();
+        }
+
+        OP(File) : OP(Symbol) : return abort(AmxError::InvalidInstr);
+
+        OP(Line) : OP(Srange) : cip += 2;
+        NEXT();
+
+        OP(Symtag) : ++cip;
+        NEXT();
+
+        OP(JumpPri) : JUMP_TO_OFFSET(pri);
+
+        OP(Switch) :
+        {
+            // Table layout: CASETBL, count, default target, then (value, target) pairs.
+            const auto* const table = jump_target(*cip);
+            const auto count = table[1];
+            cip = jump_target(table[2]);
+
+            for (std::intptr_t i = 0; i < count; ++i) {
+                if (static_cast<cell>(table[3 + 2 * i]) == pri) {
+                    cip = jump_target(table[4 + 2 * i]);
+                    break;
+                }
+            }
+        }
+
+        NEXT();
+
+        OP(SwapPri) : std::swap(mem(stk), pri);
+        NEXT();
+
+        OP(SwapAlt) : std::swap(mem(stk), alt);
+        NEXT();
+
+        OP(PushAdr) : PUSH(frm + OPERAND());
+        CHECK_MARGIN();
+        NEXT();
+
+        OP(Nop) : NEXT();
+
+        OP(Break) : if (amx_->debug)
+        {
+            save_state();
+            const auto error = static_cast<AmxError>(amx_->debug(amx_));
+
+            if (error != AmxError::None) {
+                return error == AmxError::Sleep ? sleep() : abort(error);
+            }
+        }
+
+        NEXT();
+
+        //
+        // AMXX float opcodes: the operands sit on the stack the way a native call would see them.
+        //
+
+        OP(FloatMul) : pri = FloatToCell(CellToFloat(mem(stk + 4)) * CellToFloat(mem(stk + 8)));
+        NEXT();
+
+        OP(FloatDiv) : pri = FloatToCell(CellToFloat(mem(stk + 4)) / CellToFloat(mem(stk + 8)));
+        NEXT();
+
+        OP(FloatAdd) : pri = FloatToCell(CellToFloat(mem(stk + 4)) + CellToFloat(mem(stk + 8)));
+        NEXT();
+
+        OP(FloatSub) : pri = FloatToCell(CellToFloat(mem(stk + 4)) - CellToFloat(mem(stk + 8)));
+        NEXT();
+
+        OP(FloatTo) : pri = FloatToCell(static_cast<real>(mem(stk + 4)));
+        NEXT();
+
+        OP(FloatRound) :
+        {
+            auto number = CellToFloat(mem(stk + 4));
+
+            switch (mem(stk + 8)) {
+            case 1:
+                number = std::floor(number);
+                break;
+
+            case 2:
+                number = std::ceil(number);
+                break;
+
+            case 3:
+                number = std::trunc(number);
+                break;
+
+            default:
+                number = std::floor(number + static_cast<real>(0.5));
+                break;
+            }
+
+            pri = static_cast<cell>(number);
+        }
+
+        NEXT();
+
+        OP(FloatCmp) :
+        {
+            const auto left = CellToFloat(mem(stk + 4));
+            const auto right = CellToFloat(mem(stk + 8));
+            pri = left == right ? 0 : (left > right ? 1 : -1);
+        }
+
+        NEXT();
+
+#ifndef AMX_COMPUTED_GOTO
+            default:
+                return abort(AmxError::InvalidInstr);
+            }
+        }
+#endif
+
+#undef NATIVE_RETURNED
+#undef JUMP_TO_OFFSET
+#undef JUMP_IF
+#undef CHECK_ACCESS
+#undef CHECK_HEAP
+#undef CHECK_STACK
+#undef CHECK_MARGIN
+#undef POP
+#undef PUSH
+#undef OPERAND
+#undef NEXT
+#undef OP
+    }
+
+    Interpreter* GetInterpreter(const Amx* const amx)
+    {
+        auto* const interpreter = g_interpreters.Find(amx);
+
+        return interpreter ? *interpreter : nullptr;
+    }
+
+    bool ExpandCompact(unsigned char* const section, std::size_t compact_size, std::size_t expanded_size)
+    {
+        struct Spare
+        {
+            std::size_t position;
+            ucell value;
+        } spare[COMPACT_MARGIN];
+
+        std::size_t head = 0;
+        std::size_t tail = 0;
+        std::size_t count = 0;
+
+        if (expanded_size % sizeof(cell) || compact_size > expanded_size) {
+            return false;
+        }
+
+        // Decode from the end backward, so the expansion can run in place.
+        while (compact_size > 0) {
+            ucell value = 0;
+            std::size_t shift = 0;
+
+            do {
+                --compact_size;
+
+                if (shift >= 8 * sizeof(cell)) {
+                    return false;
+                }
+
+                value |= static_cast<ucell>(section[compact_size] & 0x7F) << shift;
+                shift += 7;
+            }
+            while (compact_size > 0 && (section[compact_size - 1] & 0x80) != 0);
+
+            // Sign extension.
+            if (section[compact_size] & 0x40) {
+                while (shift < 8 * sizeof(cell)) {
+                    value |= static_cast<ucell>(0xFF) << shift;
+                    shift += 8;
+                }
+            }
+
+            while (count && spare[head].position > compact_size) {
+                std::memcpy(section + spare[head].position, &spare[head].value, sizeof(ucell));
+                head = (head + 1) % COMPACT_MARGIN;
+                --count;
+            }
+
+            if (expanded_size < sizeof(cell)) {
+                return false;
+            }
+
+            expanded_size -= sizeof(cell);
+
+            if (expanded_size > compact_size || (expanded_size == compact_size && expanded_size == 0)) {
+                std::memcpy(section + expanded_size, &value, sizeof(ucell));
+            }
+            else {
+                if (count == COMPACT_MARGIN) {
+                    return false;
+                }
+
+                spare[tail] = {expanded_size, value};
+                tail = (tail + 1) % COMPACT_MARGIN;
+                ++count;
+            }
+        }
+
+        while (count) {
+            std::memcpy(section + spare[head].position, &spare[head].value, sizeof(ucell));
+            head = (head + 1) % COMPACT_MARGIN;
+            --count;
+        }
+
+        return expanded_size == 0;
+    }
+}
@@ -0,0 +1,346 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/amxx_file.h>
+#include <amxx/os_defs.h>
+#include <algorithm>
+#include <cstring>
+
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    /**
+     * @brief Container format of AMXX 1.0, which has no cell size sections.
+    */
+    constexpr std::int32_t AMXX_OLD_FILE_MAGIC = 0x414D5842;
+
+    /**
+     * @brief Cell size of a plain .amx image, from its magic; 0 if unknown.
+    */
+    std::size_t PlainCellSize(const std::uint16_t magic)
+    {
+        switch (magic) {
+        case 0xF1E0:
+            return 4;
+
+        case 0xF1E1:
+            return 8;
+
+        case 0xF1E2:
+            return 2;
+
+        default:
+            return 0;
+        }
+    }
+}
+
+namespace amx
+{
+    AmxError ValidateHeader(const AmxHeader& header, const std::size_t memory_size)
+    {
+        if (header.magic != AMX_MAGIC) {
+            return AmxError::Format;
+        }
+
+        const auto file_version = static_cast<int>(header.file_version);
+
+        if (file_version < MIN_FILE_VERSION || file_version > CUR_FILE_VERSION ||
+            static_cast<int>(header.amx_version) > CUR_FILE_VERSION) {
+            return AmxError::Version;
+        }
+
+        const auto definition_size = file_version >= 7 ? sizeof(AmxFuncStubNt) : sizeof(AmxFuncStub);
+        const auto header_size = static_cast<std::int32_t>(sizeof(AmxHeader));
+
+        if (static_cast<std::size_t>(header.definition_size) != definition_size || header.publics < header_size ||
+            header.natives < header.publics || header.libraries < header.natives || header.cod < header.libraries ||
+            header.dat < header.cod || header.hea < header.dat || header.stp < header.hea || header.size < header.cod ||
+            header.size > header.stp || (header.dat - header.cod) % sizeof(cell) || (header.stp - header.dat) % sizeof(cell)) {
+            return AmxError::Format;
+        }
+
+        if (static_cast<std::size_t>(header.stp) > memory_size) {
+            return AmxError::Memory;
+        }
+
+        return AmxError::None;
+    }
+
+    AmxError AmxxFile::Open(const char* const path)
+    {
+        Close();
+
+#ifdef _WIN32
+        file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (file_ == INVALID_HANDLE_VALUE) {
+            file_ = nullptr;
+            return Fail(AmxError::NotFound, "Unable to open the file");
+        }
+
+        LARGE_INTEGER file_size{};
+        GetFileSizeEx(file_, &file_size);
+        size_ = static_cast<std::size_t>(file_size.QuadPart);
+        mapping_ = size_ ? CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+
+        if (mapping_) {
+            data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        }
+#else
+        const auto fd = open(path, O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0) {
+            return Fail(AmxError::NotFound, "Unable to open the file");
+        }
+
+        struct stat info{};
+
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            size_ = static_cast<std::size_t>(info.st_size);
+
+            if (auto* const map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0); map != MAP_FAILED) {
+                data_ = static_cast<const unsigned char*>(map);
+            }
+        }
+
+        // The mapping stays valid after the descriptor is closed.
+        close(fd);
+#endif
+
+        if (!data_) {
+            Close();
+            return Fail(AmxError::NotFound, "Unable to map the file");
+        }
+
+        if (const auto error = ReadSections(); error != AmxError::None) {
+            Close();
+            return error;
+        }
+
+        return AmxError::None;
+    }
+
+    AmxError AmxxFile::ReadSections()
+    {
+        // A plain .amx file is its own single uncompressed section.
+        if (size_ >= sizeof(AmxHeader)) {
+            AmxHeader header{};
+            std::memcpy(&header, data_, sizeof(header));
+
+            if (const auto cell_size = PlainCellSize(header.magic)) {
+                plain_ = true;
+                sections_.push_back({static_cast<std::int8_t>(cell_size), static_cast<std::int32_t>(size_),
+                                     static_cast<std::int32_t>(size_), header.stp, 0});
+                return AmxError::None;
+            }
+        }
+
+        AmxxFileHeader file_header{};
+
+        if (size_ < sizeof(file_header)) {
+            return Fail(AmxError::Format, "File is too small");
+        }
+
+        std::memcpy(&file_header, data_, sizeof(file_header));
+
+        if (file_header.magic == AMXX_OLD_FILE_MAGIC) {
+            return Fail(AmxError::Version, "Old .amxx format is not supported");
+        }
+
+        if (file_header.magic != AMXX_FILE_MAGIC) {
+            return Fail(AmxError::Format, "Not an .amx or .amxx file");
+        }
+
+        if (file_header.version != AMXX_FILE_VERSION) {
+            return Fail(AmxError::Version, "Unsupported .amxx version");
+        }
+
+        const auto sections = static_cast<std::size_t>(std::max<std::int8_t>(file_header.sections, 0));
+
+        if (size_ < sizeof(file_header) + sections * sizeof(AmxxSection)) {
+            return Fail(AmxError::Format, "Truncated section table");
+        }
+
+        sections_.resize(sections);
+        std::memcpy(sections_.data(), data_ + sizeof(file_header), sections * sizeof(AmxxSection));
+
+        for (const auto& section : sections_) {
+            if (section.offset < 0 || section.disk_size < 0 ||
+                static_cast<std::size_t>(section.offset) + static_cast<std::size_t>(section.disk_size) > size_) {
+                return Fail(AmxError::Format, "Section lies outside the file");
+            }
+        }
+
+        return AmxError::None;
+    }
+
+    void AmxxFile::Close()
+    {
+#ifdef _WIN32
+        if (data_) {
+            UnmapViewOfFile(data_);
+        }
+
+        if (mapping_) {
+            CloseHandle(mapping_);
+        }
+
+        if (file_) {
+            CloseHandle(file_);
+        }
+
+        file_ = mapping_ = nullptr;
+#else
+        if (data_) {
+            munmap(const_cast<unsigned char*>(data_), size_);
+        }
+#endif
+
+        data_ = nullptr;
+        size_ = 0;
+        plain_ = false;
+        sections_.clear();
+    }
+
+    const AmxxSection* AmxxFile::FindSection(const std::size_t cell_size) const
+    {
+        for (const auto& section : sections_) {
+            if (static_cast<std::size_t>(section.cell_size) == cell_size) {
+                return &section;
+            }
+        }
+
+        return nullptr;
+    }
+
+    AmxError AmxxFile::Load(std::vector<cell>& image) const
+    {
+        image.clear();
+
+        const auto* const section = FindSection();
+
+        if (!section) {
+            return Fail(IsOpen() ? AmxError::Format : AmxError::Init, "No section for this cell size");
+        }
+
+        // Fields of the packed section are read by value; they may be misaligned.
+        const std::int32_t section_size = section->image_size;
+        const auto* const source = data_ + section->offset;
+        const auto source_size = static_cast<std::size_t>(section->disk_size);
+        const auto image_size = static_cast<std::size_t>(section_size > 0 ? section_size : 0);
+        AmxHeader header{};
+
+        if (image_size < sizeof(header)) {
+            return Fail(AmxError::Format, "Image is smaller than its header");
+        }
+
+#ifdef HAS_ZLIB
+        z_stream stream{};
+
+        if (!plain_ && inflateInit(&stream) != Z_OK) {
+            return Fail(AmxError::Memory, "Unable to initialize zlib");
+        }
+
+        // Inflates into [out, out + size); the stream keeps its position between calls.
+        const auto inflate_to = [&stream, source, source_size](void* const out, const std::size_t size) {
+            if (!stream.next_in) {
+                stream.next_in = const_cast<Bytef*>(source);
+                stream.avail_in = static_cast<uInt>(source_size);
+            }
+
+            stream.next_out = static_cast<Bytef*>(out);
+            stream.avail_out = static_cast<uInt>(size);
+
+            const auto result = inflate(&stream, Z_SYNC_FLUSH);
+            return (result == Z_OK || result == Z_STREAM_END) && stream.avail_out == 0;
+        };
+#endif
+
+        // The header comes first, so the image can be sized from its stack top before the rest is inflated.
+        if (plain_) {
+            std::memcpy(&header, source, sizeof(header));
+        }
+        else {
+#ifdef HAS_ZLIB
+            if (!inflate_to(&header, sizeof(header))) {
+                inflateEnd(&stream);
+                return Fail(AmxError::Format, "Unable to decompress the header");
+            }
+#else
+            return Fail(AmxError::Format, "Compressed sections require zlib");
+#endif
+        }
+
+        const std::int32_t stack_top = header.stp;
+        const auto memory_size = std::max(static_cast<std::size_t>(stack_top > 0 ? stack_top : 0), image_size);
+
+        if (const auto error = ValidateHeader(header, memory_size); error != AmxError::None ||
+            static_cast<std::size_t>(header.size) > image_size) {
+#ifdef HAS_ZLIB
+            if (!plain_) {
+                inflateEnd(&stream);
+            }
+#endif
+            return Fail(error != AmxError::None ? error : AmxError::Format, "Invalid image header");
+        }
+
+        image.resize((memory_size + sizeof(cell) - 1) / sizeof(cell));
+        auto* const out = reinterpret_cast<unsigned char*>(image.data());
+
+        if (plain_) {
+            if (image_size > source_size) {
+                image.clear();
+                return Fail(AmxError::Format, "Truncated image");
+            }
+
+            std::memcpy(out, source, image_size);
+            return AmxError::None;
+        }
+
+#ifdef HAS_ZLIB
+        std::memcpy(out, &header, sizeof(header));
+
+        const auto inflated = inflate_to(out + sizeof(header), image_size - sizeof(header));
+        const auto result = inflate(&stream, Z_FINISH);
+        inflateEnd(&stream);
+
+        if (!inflated || result != Z_STREAM_END) {
+            image.clear();
+            return Fail(AmxError::Format, "Unable to decompress the image");
+        }
+#endif
+
+        return AmxError::None;
+    }
+
+    AmxError AmxxFile::Fail(const AmxError error, const char* const text) const
+    {
+        error_text_ = text;
+        return error;
+    }
+}
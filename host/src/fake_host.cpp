@@ -0,0 +1,1642 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/amx_heap.h>
+#include <amxx/amx_index.h>
+#include <amxx/amx_interpreter.h>
+#include <amxx/amxx_file.h>
+#include <amxx/cell_string.h>
+#include <amxx/fake_host.h>
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+extern "C" amxx::Status AMXX_Query(int* interface_version, amxx::ModuleInfo* module_info);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+extern "C" amxx::GameStatus AMXX_CheckGame(const char* game);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+extern "C" amxx::Status AMXX_Attach(std::add_pointer_t<void*(const char*)> request_function);
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+extern "C" amxx::Status AMXX_Detach();
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+extern "C" amxx::Status AMXX_PluginsLoaded();
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+extern "C" void AMXX_PluginsUnloaded();
+
+// NOLINTNEXTLINE(readability-identifier-naming)
+extern "C" void AMXX_PluginsUnloading();
+
+namespace
+{
+    using namespace amxx;
+    using namespace amxx::host;
+
+    /**
+     * @brief Size of the buffers returned by the string functions.
+    */
+    constexpr std::size_t STRING_BUFFER_SIZE = 16384;
+
+    struct Plugin
+    {
+        std::string name{};
+        std::vector<cell> image{};
+        Amx amx{};
+        std::vector<std::string> public_names{};
+        std::vector<FakePublic> publics{};
+        std::vector<std::string> native_names{};
+
+        /**
+         * @brief Forwards skip a paused plugin, as the core does.
+        */
+        bool paused{};
+
+        /**
+         * @brief Runs the code of a bytecode plugin; nullptr for a plugin with C++ publics.
+        */
+        std::unique_ptr<amx::Interpreter> interpreter{};
+    };
+
+    /**
+     * @brief Image loaded through \c LoadAmxScript into an Amx owned by the caller.
+    */
+    struct Script
+    {
+        std::vector<cell> image{};
+        std::unique_ptr<amx::Interpreter> interpreter{};
+    };
+
+    struct HostForward
+    {
+        std::string func_name{};
+        ForwardExecType exec_type{};
+        std::vector<ForwardParam> params{};
+
+        /**
+         * @brief Plugin of a single-plugin forward; nullptr for a multi-plugin one.
+        */
+        Amx* amx{};
+        int func{-1};
+        bool active{true};
+    };
+
+    struct PreparedArray
+    {
+        void* data;
+        std::size_t size;
+        bool is_char;
+        bool copy_back;
+    };
+
+    struct ForwardValue
+    {
+        cell value;
+        const char* string;
+        char* string_ex;
+        cell* ref;
+    };
+
+    struct HostState
+    {
+        ModuleEntryPoints module{};
+        bool attached{};
+        std::vector<std::unique_ptr<Plugin>> plugins{};
+        std::vector<std::unique_ptr<Script>> scripts{};
+        std::unordered_map<std::string, AmxNative> natives{};
+        std::vector<HostForward> multi_forwards{};
+        std::vector<HostForward> sp_forwards{};
+        std::vector<PreparedArray> arrays{};
+        int forward_depth{};
+        FakePlayer players[MAX_CLIENTS + 1]{};
+
+        /**
+         * @brief \c gpGlobals->maxClients: the core has no player record past it.
+        */
+        int max_clients{MAX_CLIENTS};
+
+        std::vector<std::string> messages{};
+        bool echo{};
+        std::string mod_name{"cstrike"};
+        std::map<std::string, std::string> local_info{};
+        std::vector<std::string> disabled{};
+        std::map<std::string, void*> functions{};
+        std::vector<std::pair<std::string, LibType>> libraries{};
+        std::vector<void*> auth_funcs{};
+    };
+
+    HostState g_host{};
+
+    char g_string_buffers[4][STRING_BUFFER_SIZE]{};
+    char g_format_buffer[STRING_BUFFER_SIZE]{};
+    char g_path_buffer[STRING_BUFFER_SIZE]{};
+
+    Plugin* FindPlugin(const Amx* const amx)
+    {
+        for (const auto& plugin : g_host.plugins) {
+            if (&plugin->amx == amx) {
+                return plugin.get();
+            }
+        }
+
+        return nullptr;
+    }
+
+    void AddMessage(std::string message)
+    {
+        if (g_host.echo) {
+            std::puts(message.c_str());
+        }
+
+        g_host.messages.emplace_back(std::move(message));
+    }
+
+    std::string FormatV(const char* const format, std::va_list args)
+    {
+        char buffer[STRING_BUFFER_SIZE];
+        std::vsnprintf(buffer, sizeof(buffer), format, args);
+
+        return buffer;
+    }
+
+    std::size_t RegisterNativeList(const AmxNativeInfo* list)
+    {
+        std::size_t count = 0;
+
+        for (; list && list->name; ++list, ++count) {
+            g_host.natives[list->name] = list->func;
+        }
+
+        return count;
+    }
+
+    //
+    // Amx execution.
+    //
+
+    int HostAmxPush(Amx* const amx, const cell value)
+    {
+        if (amx->stk - static_cast<cell>(sizeof(cell)) < amx->hea + AMX_STACK_MARGIN) {
+            return static_cast<int>(AmxError::StackErr);
+        }
+
+        amx->stk -= static_cast<cell>(sizeof(cell));
+        *amx::Address(amx, amx->stk) = value;
+        ++amx->param_count;
+
+        return static_cast<int>(AmxError::None);
+    }
+
+    int HostAmxExec(Amx* const amx, cell* const return_val, const int index)
+    {
+        if (auto* const interpreter = amx::GetInterpreter(amx)) {
+            // Natives may be registered after the plugin was loaded.
+            if (interpreter->UnboundNativeCount()) {
+                interpreter->ResolveNatives([](const char* const name) { return FindNative(name); });
+            }
+
+            return static_cast<int>(interpreter->Exec(return_val, index));
+        }
+
+        const auto pushed = static_cast<cell>(amx->param_count * sizeof(cell));
+        const auto reset_stk = amx->stk + pushed;
+        const auto reset_hea = amx->hea;
+        auto* const plugin = FindPlugin(amx);
+
+        amx->param_count = 0;
+
+        if (!plugin || index < 0 || index >= static_cast<int>(plugin->publics.size())) {
+            amx->stk = reset_stk;
+            return static_cast<int>(plugin ? AmxError::Index : AmxError::Init);
+        }
+
+        if (amx->stk - static_cast<cell>(sizeof(cell)) < amx->hea + AMX_STACK_MARGIN) {
+            amx->stk = reset_stk;
+            return static_cast<int>(AmxError::StackErr);
+        }
+
+        // Same frame as the AMX builds: the byte count of the arguments followed by the arguments.
+        amx->stk -= static_cast<cell>(sizeof(cell));
+        *amx::Address(amx, amx->stk) = pushed;
+        amx->error = static_cast<int>(AmxError::None);
+
+        const auto saved_reset_stk = amx->reset_stk;
+        const auto saved_reset_hea = amx->reset_hea;
+        amx->reset_stk = reset_stk;
+        amx->reset_hea = reset_hea;
+
+        const auto result = plugin->publics[index](amx, amx::Address(amx, amx->stk));
+
+        amx->reset_stk = saved_reset_stk;
+        amx->reset_hea = saved_reset_hea;
+        amx->stk = reset_stk;
+        amx->hea = reset_hea;
+
+        if (return_val) {
+            *return_val = result;
+        }
+
+        return amx->error;
+    }
+
+    int HostAmxExecV(Amx* const amx, cell* const return_val, const int index, const int /*num_params*/, cell /*params*/[])
+    {
+        // The core registers amx_Execv as amx_Exec: the arguments are ignored and must be pushed beforehand.
+        return HostAmxExec(amx, return_val, index);
+    }
+
+    int HostAmxAllot(Amx* const amx, const int length, cell* const amx_address, cell** const phys_address)
+    {
+        const auto bytes = static_cast<cell>(length * sizeof(cell));
+
+        if (amx->stk - amx->hea - bytes < AMX_STACK_MARGIN) {
+            return static_cast<int>(AmxError::Memory);
+        }
+
+        *amx_address = amx->hea;
+        *phys_address = amx::Address(amx, amx->hea);
+        amx->hea += bytes;
+
+        return static_cast<int>(AmxError::None);
+    }
+
+    int HostAmxFindPublic(Amx* const amx, const char* const func_name, int* const index)
+    {
+        if (const auto* const plugin = FindPlugin(amx)) {
+            for (std::size_t i = 0; i < plugin->public_names.size(); ++i) {
+                if (plugin->public_names[i] == func_name) {
+                    *index = static_cast<int>(i);
+                    return static_cast<int>(AmxError::None);
+                }
+            }
+        }
+        else if (amx::GetInterpreter(amx)) {
+            if (*index = AmxIndex{amx}.FindPublic(func_name); *index >= 0) {
+                return static_cast<int>(AmxError::None);
+            }
+        }
+
+        *index = -1;
+
+        return static_cast<int>(AmxError::NotFound);
+    }
+
+    int HostAmxFindNative(Amx* const amx, const char* const func_name, int* const index)
+    {
+        if (const auto* const plugin = FindPlugin(amx)) {
+            for (std::size_t i = 0; i < plugin->native_names.size(); ++i) {
+                if (plugin->native_names[i] == func_name) {
+                    *index = static_cast<int>(i);
+                    return static_cast<int>(AmxError::None);
+                }
+            }
+        }
+        else if (amx::GetInterpreter(amx)) {
+            if (*index = AmxIndex{amx}.FindNative(func_name); *index >= 0) {
+                return static_cast<int>(AmxError::None);
+            }
+        }
+
+        *index = -1;
+
+        return static_cast<int>(AmxError::NotFound);
+    }
+
+    int HostAmxReRegister(Amx* /*amx*/, AmxNativeInfo* const list, const int number)
+    {
+        for (auto i = 0; i < number && list[i].name; ++i) {
+            g_host.natives[list[i].name] = list[i].func;
+        }
+
+        return static_cast<int>(AmxError::None);
+    }
+
+    int HostLoadAmxScriptEx(Amx* const amx, void** const code, const char* const path, char* const error_info,
+                            const std::size_t max_length, int /*debug*/)
+    {
+        const amx::AmxxFile file{path};
+        auto script = std::make_unique<Script>();
+        auto error = file.IsOpen() ? file.Load(script->image) : AmxError::NotFound;
+
+        if (error == AmxError::None) {
+            script->interpreter = std::make_unique<amx::Interpreter>();
+            error = script->interpreter->Init(amx, reinterpret_cast<unsigned char*>(script->image.data()),
+                                              script->image.size() * sizeof(cell));
+        }
+
+        if (error != AmxError::None) {
+            std::snprintf(error_info, max_length, "%s", file.ErrorText().empty() ? "Invalid plugin image" : file.ErrorText().c_str());
+            return static_cast<int>(error);
+        }
+
+        script->interpreter->ResolveNatives([](const char* const name) { return FindNative(name); });
+        *code = g_host.scripts.emplace_back(std::move(script))->image.data();
+
+        return static_cast<int>(AmxError::None);
+    }
+
+    int HostLoadAmxScript(Amx* const amx, void** const code, const char* const path, char error_info[64], const int debug)
+    {
+        return HostLoadAmxScriptEx(amx, code, path, error_info, 64, debug);
+    }
+
+    int HostUnloadAmxScript(Amx* /*amx*/, void** const code)
+    {
+        auto& scripts = g_host.scripts;
+
+        scripts.erase(std::remove_if(scripts.begin(), scripts.end(),
+                                     [code](const auto& script) { return script->image.data() == *code; }),
+                      scripts.end());
+        *code = nullptr;
+
+        return static_cast<int>(AmxError::None);
+    }
+
+    //
+    // Natives and libraries.
+    //
+
+    int HostAddNatives(const AmxNativeInfo* list)
+    {
+        return static_cast<int>(RegisterNativeList(list));
+    }
+
+    void HostOverrideNatives(AmxNativeInfo* natives, const char* /*my_name*/)
+    {
+        RegisterNativeList(natives);
+    }
+
+    int HostFindLibrary(const char* const name, const LibType type)
+    {
+        for (const auto& [library, library_type] : g_host.libraries) {
+            if (library_type == type && library == name) {
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+
+    std::size_t HostAddLibraries(const char* const name, const LibType type, void* /*parent*/)
+    {
+        g_host.libraries.emplace_back(name, type);
+        return 1;
+    }
+
+    std::size_t HostRemoveLibraries(void* /*parent*/)
+    {
+        const auto count = g_host.libraries.size();
+        g_host.libraries.clear();
+
+        return count;
+    }
+
+    //
+    // Plugins.
+    //
+
+    const char* HostGetAmxScriptName(const int id)
+    {
+        return id >= 0 && id < static_cast<int>(g_host.plugins.size()) ? g_host.plugins[id]->name.c_str() : "";
+    }
+
+    Amx* HostGetAmxScript(const int id)
+    {
+        return id >= 0 && id < static_cast<int>(g_host.plugins.size()) ? &g_host.plugins[id]->amx : nullptr;
+    }
+
+    int HostFindAmxScriptByAmx(const Amx* const amx)
+    {
+        for (std::size_t i = 0; i < g_host.plugins.size(); ++i) {
+            if (&g_host.plugins[i]->amx == amx) {
+                return static_cast<int>(i);
+            }
+        }
+
+        return -1;
+    }
+
+    int HostFindAmxScriptByName(const char* const name)
+    {
+        for (std::size_t i = 0; i < g_host.plugins.size(); ++i) {
+            if (g_host.plugins[i]->name == name) {
+                return static_cast<int>(i);
+            }
+        }
+
+        return -1;
+    }
+
+    //
+    // Strings and memory.
+    //
+
+    cell* HostGetAmxAddress(Amx* const amx, const cell offset)
+    {
+        return amx::Address(amx, offset);
+    }
+
+    int HostSetAmxString(Amx* const amx, const cell amx_address, const char* const source, const int max)
+    {
+        return static_cast<int>(amx::SetString(amx, amx_address, source, std::strlen(source), max));
+    }
+
+    char* HostGetAmxString(Amx* const amx, const cell amx_address, const int buffer_id, int* const len)
+    {
+        auto* const buffer = g_string_buffers[buffer_id & 3];
+        const auto length = amx::NarrowString(amx::Address(amx, amx_address), buffer, STRING_BUFFER_SIZE);
+
+        if (len) {
+            *len = static_cast<int>(length.size());
+        }
+
+        return buffer;
+    }
+
+    int HostGetAmxStringLen(const cell* const ptr)
+    {
+        return static_cast<int>(amx::GetStringLen(ptr));
+    }
+
+    /**
+     * @brief Pawn-style formatting: variadic arguments are passed by reference.
+    */
+    char* HostFormatAmxString(Amx* const amx, cell* const params, const int start_param, int* const len)
+    {
+        const auto param_count = static_cast<int>(params[0] / sizeof(cell));
+        const auto format = amx::GetString(amx, params[start_param]);
+        auto arg = start_param + 1;
+        std::size_t out = 0;
+
+        const auto append = [&out](const char* const text) {
+            const auto length = std::strlen(text);
+            const auto count = length < STRING_BUFFER_SIZE - 1 - out ? length : STRING_BUFFER_SIZE - 1 - out;
+
+            std::memcpy(g_format_buffer + out, text, count);
+            out += count;
+        };
+
+        for (std::size_t i = 0; i < format.size() && out < STRING_BUFFER_SIZE - 1; ++i) {
+            if (format[i] != '%' || i + 1 == format.size()) {
+                g_format_buffer[out++] = format[i];
+                continue;
+            }
+
+            auto end = i + 1;
+
+            while (end < format.size() && std::strchr("-+ #0123456789.", format[end])) {
+                ++end;
+            }
+
+            if (end == format.size()) {
+                break;
+            }
+
+            const auto conversion = format[end];
+            auto spec = format.substr(i, end - i);
+            char text[STRING_BUFFER_SIZE];
+            i = end;
+
+            if (conversion == '%') {
+                append("%");
+                continue;
+            }
+
+            if (arg > param_count) {
+                break;
+            }
+
+            const auto address = params[arg++];
+
+            switch (conversion) {
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'c':
+                spec += conversion;
+                std::snprintf(text, sizeof(text), spec.c_str(), *amx::Address(amx, address));
+                break;
+
+            case 'f':
+                spec += conversion;
+                std::snprintf(text, sizeof(text), spec.c_str(),
+                              static_cast<double>(amx::CellToFloat(*amx::Address(amx, address))));
+                break;
+
+            case 's':
+                spec += conversion;
+                std::snprintf(text, sizeof(text), spec.c_str(), amx::GetString(amx, address).c_str());
+                break;
+
+            default:
+                text[0] = '\0';
+                break;
+            }
+
+            append(text);
+        }
+
+        g_format_buffer[out] = '\0';
+
+        if (len) {
+            *len = static_cast<int>(out);
+        }
+
+        return g_format_buffer;
+    }
+
+    void HostCopyAmxMemory(cell* const dest, const cell* const src, const int len)
+    {
+        std::memmove(dest, src, len * sizeof(cell));
+    }
+
+    const char* HostFormat(const char* const format, ...)
+    {
+        std::va_list args;
+        va_start(args, format);
+        std::vsnprintf(g_format_buffer, sizeof(g_format_buffer), format, args);
+        va_end(args);
+
+        return g_format_buffer;
+    }
+
+    char* HostBuildPathName(const char* const format, ...)
+    {
+        std::va_list args;
+        va_start(args, format);
+        const auto path = FormatV(format, args);
+        va_end(args);
+
+        std::snprintf(g_path_buffer, sizeof(g_path_buffer), "%s/%s", g_host.mod_name.c_str(), path.c_str());
+
+        return g_path_buffer;
+    }
+
+    char* HostBuildPathNameR(char* const buffer, const std::size_t max_len, const char* const format, ...)
+    {
+        std::va_list args;
+        va_start(args, format);
+        const auto path = FormatV(format, args);
+        va_end(args);
+
+        std::snprintf(buffer, max_len, "%s/%s", g_host.mod_name.c_str(), path.c_str());
+
+        return buffer;
+    }
+
+    cell HostRealToCell(const real value)
+    {
+        return amx::FloatToCell(value);
+    }
+
+    real HostCellToReal(const cell value)
+    {
+        return amx::CellToFloat(value);
+    }
+
+    char* HostGetAmxStringNull(Amx* const amx, const cell amx_address, const int buffer_id, int* const len)
+    {
+        return HostGetAmxString(amx, amx_address, buffer_id, len);
+    }
+
+    cell* HostGetAmxVectorNull(Amx* const amx, const cell offset)
+    {
+        return amx::Address(amx, offset);
+    }
+
+    void* HostGetConfigManager()
+    {
+        return nullptr;
+    }
+
+    int HostSetAmxStringUtf8Cell(Amx* const amx, const cell amx_address, const cell* const source,
+                                 const std::size_t source_len, const std::size_t max_len)
+    {
+        auto* const dest = amx::Address(amx, amx_address);
+        const auto length = source_len < max_len ? source_len : max_len;
+
+        std::memmove(dest, source, length * sizeof(cell));
+        dest[length] = 0;
+
+        return static_cast<int>(length);
+    }
+
+    int HostSetAmxStringUtf8Char(Amx* const amx, const cell amx_address, const char* const source,
+                                 const std::size_t source_len, const std::size_t max_len)
+    {
+        return static_cast<int>(amx::SetStringUtf8(amx, amx_address, source, source_len, max_len));
+    }
+
+    //
+    // Logging.
+    //
+
+    void HostPrintConsole(const char* const format, ...)
+    {
+        std::va_list args;
+        va_start(args, format);
+        AddMessage(FormatV(format, args));
+        va_end(args);
+    }
+
+    void HostLog(const char* const format, ...)
+    {
+        std::va_list args;
+        va_start(args, format);
+        AddMessage(FormatV(format, args));
+        va_end(args);
+    }
+
+    void HostLogError(Amx* const amx, const AmxError error, const char* const format, ...)
+    {
+        std::va_list args;
+        va_start(args, format);
+        AddMessage("[error " + std::to_string(static_cast<int>(error)) + "] " + FormatV(format, args));
+        va_end(args);
+
+        // The core raises the error after logging it.
+        if (amx) {
+            amx->error = static_cast<int>(error);
+        }
+    }
+
+    int HostRaiseAmxError(Amx* const amx, const AmxError error)
+    {
+        amx->error = static_cast<int>(error);
+        return 0;
+    }
+
+    //
+    // Forwards.
+    //
+
+    std::vector<ForwardParam> ReadForwardParams(std::va_list args)
+    {
+        std::vector<ForwardParam> params{};
+
+        for (auto param = static_cast<ForwardParam>(va_arg(args, int)); param != ForwardParam::Done;
+             param = static_cast<ForwardParam>(va_arg(args, int))) {
+            params.push_back(param);
+        }
+
+        return params;
+    }
+
+    int HostRegisterForward(const char* const func_name, const ForwardExecType exec_type, ...)
+    {
+        std::va_list args;
+        va_start(args, exec_type);
+        auto params = ReadForwardParams(args);
+        va_end(args);
+
+        g_host.multi_forwards.push_back({func_name, exec_type, std::move(params)});
+
+        return static_cast<int>(g_host.multi_forwards.size() - 1) << 1;
+    }
+
+    int RegisterSpForwardImpl(Amx* const amx, const int func, std::va_list args)
+    {
+        auto params = ReadForwardParams(args);
+
+        g_host.sp_forwards.push_back({HostGetAmxScriptName(HostFindAmxScriptByAmx(amx)), ForwardExecType::Ignore,
+                                      std::move(params), amx, func});
+
+        return static_cast<int>(g_host.sp_forwards.size() - 1) << 1 | 1;
+    }
+
+    int HostRegisterSpForward(Amx* const amx, const int func, ...)
+    {
+        std::va_list args;
+        va_start(args, func);
+        const auto id = RegisterSpForwardImpl(amx, func, args);
+        va_end(args);
+
+        return id;
+    }
+
+    int HostRegisterSpForwardByName(Amx* const amx, const char* const func_name, ...)
+    {
+        auto func = -1;
+
+        if (HostAmxFindPublic(amx, func_name, &func) != static_cast<int>(AmxError::None)) {
+            return -1;
+        }
+
+        std::va_list args;
+        va_start(args, func_name);
+        const auto id = RegisterSpForwardImpl(amx, func, args);
+        va_end(args);
+
+        return id;
+    }
+
+    void HostUnregisterSpForward(const int id)
+    {
+        if ((id & 1) && (id >> 1) < static_cast<int>(g_host.sp_forwards.size())) {
+            g_host.sp_forwards[id >> 1].active = false;
+        }
+    }
+
+    cell PrepareArray(void* const data, const std::size_t size, const bool is_char, const bool copy_back)
+    {
+        g_host.arrays.push_back({data, size, is_char, copy_back});
+        return static_cast<cell>(g_host.arrays.size() - 1);
+    }
+
+    cell HostPrepareCellArray(cell* const ptr, const std::size_t size)
+    {
+        return PrepareArray(ptr, size, false, false);
+    }
+
+    cell HostPrepareCharArray(char* const ptr, const std::size_t size)
+    {
+        return PrepareArray(ptr, size, true, false);
+    }
+
+    cell HostPrepareCellArrayA(cell* const ptr, const std::size_t size, const bool copy_back)
+    {
+        return PrepareArray(ptr, size, false, copy_back);
+    }
+
+    cell HostPrepareCharArrayA(char* const ptr, const std::size_t size, const bool copy_back)
+    {
+        return PrepareArray(ptr, size, true, copy_back);
+    }
+
+    /**
+     * @brief Marshals the arguments into the plugin heap, calls the public and copies the results back.
+    */
+    cell RunForward(Amx* const amx, const int func, const HostForward& forward, const std::vector<ForwardValue>& values)
+    {
+        const auto count = forward.params.size();
+        std::vector<cell> params(count);
+        std::vector<cell*> phys(count);
+        AmxHeapScope heap{amx};
+
+        for (std::size_t i = 0; i < count; ++i) {
+            AmxHeapBlock block{};
+
+            switch (forward.params[i]) {
+            case ForwardParam::String:
+                block = heap.AllocateString(values[i].string ? values[i].string : "");
+                break;
+
+            case ForwardParam::StringEx:
+                block = heap.AllocateString(values[i].string_ex ? values[i].string_ex : "");
+                break;
+
+            case ForwardParam::Array: {
+                if (values[i].value < 0 || values[i].value >= static_cast<cell>(g_host.arrays.size())) {
+                    AddMessage("[fake host] Invalid array handle passed to forward \"" + forward.func_name + "\"");
+                    return 0;
+                }
+
+                const auto& array = g_host.arrays[values[i].value];
+                block = heap.Allocate(array.size);
+
+                if (block && array.is_char) {
+                    amx::simd::WidenChars(block.phys, static_cast<const char*>(array.data), array.size);
+                }
+                else if (block) {
+                    std::memcpy(block.phys, array.data, array.size * sizeof(cell));
+                }
+
+                break;
+            }
+
+            case ForwardParam::CellByRef:
+            case ForwardParam::FloatByRef:
+                block = heap.AllocateCell(*values[i].ref);
+                break;
+
+            default:
+                params[i] = values[i].value;
+                continue;
+            }
+
+            if (!block) {
+                AddMessage("[fake host] Not enough plugin heap to run forward \"" + forward.func_name + "\"");
+                return 0;
+            }
+
+            params[i] = block.address;
+            phys[i] = block.phys;
+        }
+
+        for (auto i = count; i > 0; --i) {
+            if (HostAmxPush(amx, params[i - 1]) != static_cast<int>(AmxError::None)) {
+                amx->stk += static_cast<cell>(amx->param_count * sizeof(cell));
+                amx->param_count = 0;
+                AddMessage("[fake host] Not enough plugin stack to run forward \"" + forward.func_name + "\"");
+                return 0;
+            }
+        }
+
+        cell result{};
+        const auto error = HostAmxExec(amx, &result, func);
+
+        if (error != static_cast<int>(AmxError::None)) {
+            AddMessage("[fake host] Run time error " + std::to_string(error) + " in forward \"" + forward.func_name + "\"");
+            return 0;
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            switch (forward.params[i]) {
+            case ForwardParam::StringEx:
+                if (values[i].string_ex) {
+                    amx::simd::NarrowCells(values[i].string_ex, phys[i], amx::GetStringLen(phys[i]) + 1);
+                }
+                break;
+
+            case ForwardParam::Array:
+                if (const auto& array = g_host.arrays[values[i].value]; array.copy_back) {
+                    if (array.is_char) {
+                        amx::simd::NarrowCells(static_cast<char*>(array.data), phys[i], array.size);
+                    }
+                    else {
+                        std::memcpy(array.data, phys[i], array.size * sizeof(cell));
+                    }
+                }
+                break;
+
+            case ForwardParam::CellByRef:
+            case ForwardParam::FloatByRef:
+                *values[i].ref = *phys[i];
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        return result;
+    }
+
+    int HostExecuteForward(const int id, ...)
+    {
+        auto& forwards = (id & 1) ? g_host.sp_forwards : g_host.multi_forwards;
+        const auto index = id >> 1;
+
+        if (id < 0 || index >= static_cast<int>(forwards.size()) || !forwards[index].active) {
+            return -1;
+        }
+
+        const auto forward = forwards[index];
+        std::vector<ForwardValue> values(forward.params.size());
+
+        std::va_list args;
+        va_start(args, id);
+
+        for (std::size_t i = 0; i < forward.params.size(); ++i) {
+            switch (forward.params[i]) {
+            case ForwardParam::Float:
+                values[i].value = amx::FloatToCell(static_cast<real>(va_arg(args, double)));
+                break;
+
+            case ForwardParam::String:
+                values[i].string = va_arg(args, const char*);
+                break;
+
+            case ForwardParam::StringEx:
+                values[i].string_ex = va_arg(args, char*);
+                break;
+
+            case ForwardParam::CellByRef:
+            case ForwardParam::FloatByRef:
+                values[i].ref = va_arg(args, cell*);
+                break;
+
+            default:
+                values[i].value = va_arg(args, cell);
+                break;
+            }
+        }
+
+        va_end(args);
+
+        ++g_host.forward_depth;
+        cell result = 0;
+
+        if (forward.amx) {
+            if (const auto* const plugin = FindPlugin(forward.amx); !plugin || !plugin->paused) {
+                result = RunForward(forward.amx, forward.func, forward, values);
+            }
+        }
+        else {
+            for (std::size_t i = 0; i < g_host.plugins.size(); ++i) {
+                auto func = -1;
+                auto* const amx = &g_host.plugins[i]->amx;
+
+                if (g_host.plugins[i]->paused) {
+                    continue;
+                }
+
+                if (HostAmxFindPublic(amx, forward.func_name.c_str(), &func) != static_cast<int>(AmxError::None)) {
+                    continue;
+                }
+
+                const auto value = RunForward(amx, func, forward, values);
+
+                switch (forward.exec_type) {
+                case ForwardExecType::Stop:
+                    if (value > 0) {
+                        --g_host.forward_depth;
+                        return value;
+                    }
+                    break;
+
+                case ForwardExecType::Stop2:
+                    if (value == 1) {
+                        --g_host.forward_depth;
+                        return value;
+                    }
+                    [[fallthrough]];
+
+                case ForwardExecType::Continue:
+                    result = value > result ? value : result;
+                    break;
+
+                default:
+                    break;
+                }
+            }
+        }
+
+        // Prepared arrays live until the outermost forward returns.
+        if (--g_host.forward_depth == 0) {
+            g_host.arrays.clear();
+        }
+
+        return result;
+    }
+
+    //
+    // Players.
+    //
+
+    FakePlayer* Player(const int id)
+    {
+        return id >= 1 && id <= g_host.max_clients ? &g_host.players[id] : nullptr;
+    }
+
+    int HostIsPlayerValid(const int id)
+    {
+        return Player(id) != nullptr;
+    }
+
+    const char* HostGetPlayerName(const int id)
+    {
+        return Player(id) ? Player(id)->name : "";
+    }
+
+    const char* HostGetPlayerIp(const int id)
+    {
+        return Player(id) ? Player(id)->ip : "";
+    }
+
+    const char* HostGetPlayerTeam(const int id)
+    {
+        return Player(id) ? Player(id)->team : "";
+    }
+
+    void* HostPlayerPropAddress(const int id, const PlayerProp prop)
+    {
+        auto* const player = Player(id);
+
+        if (!player) {
+            return nullptr;
+        }
+
+        switch (prop) {
+        case PlayerProp::Name:
+            return player->name;
+        case PlayerProp::Ip:
+            return player->ip;
+        case PlayerProp::Team:
+            return player->team;
+        case PlayerProp::InGame:
+            return &player->in_game;
+        case PlayerProp::Authorized:
+            return &player->authorized;
+        case PlayerProp::Vgui:
+            return &player->vgui;
+        case PlayerProp::Time:
+            return &player->time;
+        case PlayerProp::PlayTime:
+            return &player->play_time;
+        case PlayerProp::MenuExpire:
+            return &player->menu_expire;
+        case PlayerProp::Weapons:
+            return player->weapons;
+        case PlayerProp::CurrentWeapon:
+            return &player->current_weapon;
+        case PlayerProp::TeamId:
+            return &player->team_id;
+        case PlayerProp::Deaths:
+            return &player->deaths;
+        case PlayerProp::Aiming:
+            return &player->aiming;
+        case PlayerProp::Menu:
+            return &player->menu;
+        case PlayerProp::Keys:
+            return &player->keys;
+        case PlayerProp::Flags:
+            return player->flags;
+        case PlayerProp::NewMenu:
+            return &player->new_menu;
+        case PlayerProp::NewMenuPage:
+            return &player->new_menu_page;
+        }
+
+        return nullptr;
+    }
+
+    template <typename T, T FakePlayer::*Field>
+    T GetPlayerField(const int id)
+    {
+        const auto* const player = Player(id);
+        return player ? player->*Field : T{};
+    }
+
+    template <bool FakePlayer::*Field>
+    int GetPlayerBool(const int id)
+    {
+        const auto* const player = Player(id);
+        return player && player->*Field;
+    }
+
+    int HostGetPlayerFlags(const int id)
+    {
+        return Player(id) ? Player(id)->flags[0] : 0;
+    }
+
+    int HostSetPlayerTeamInfo(const int id, const int team_id, const char* const name)
+    {
+        auto* const player = Player(id);
+
+        if (!player) {
+            return 0;
+        }
+
+        player->team_id = team_id;
+
+        if (name) {
+            std::snprintf(player->team, sizeof(player->team), "%s", name);
+        }
+
+        return 1;
+    }
+
+    //
+    // Misc.
+    //
+
+    const char* HostGetModName()
+    {
+        return g_host.mod_name.c_str();
+    }
+
+    const char* HostGetLocalInfo(const char* const name, const char* const def)
+    {
+        const auto it = g_host.local_info.find(name);
+        return it != g_host.local_info.end() ? it->second.c_str() : def;
+    }
+
+    void HostMergeDefinitionFile(const char* /*file_name*/)
+    {
+    }
+
+    void HostRegisterFunction(void* const pfn, const char* const desc)
+    {
+        g_host.functions[desc] = pfn;
+    }
+
+    void* HostRegisterFunctionEx(void* const pfn, const char* const desc)
+    {
+        auto& slot = g_host.functions[desc];
+        auto* const previous = slot;
+        slot = pfn;
+
+        return previous;
+    }
+
+    void HostRegisterAuthFunc(const std::add_pointer_t<void(int, const char*)> authorize_func)
+    {
+        g_host.auth_funcs.push_back(reinterpret_cast<void*>(authorize_func));
+    }
+
+    void HostUnregisterAuthFunc(const std::add_pointer_t<void(int, const char*)> authorize_func)
+    {
+        auto& funcs = g_host.auth_funcs;
+
+        for (auto it = funcs.begin(); it != funcs.end(); ++it) {
+            if (*it == reinterpret_cast<void*>(authorize_func)) {
+                funcs.erase(it);
+                break;
+            }
+        }
+    }
+
+    void HostMessageBlock(const int mode, int /*message*/, int* const opt)
+    {
+        if (mode == AMXX_MSG_BLOCK_GET && opt) {
+            *opt = AMXX_BLOCK_NOT;
+        }
+    }
+
+    struct HostFunction
+    {
+        const char* name;
+        void* pointer;
+    };
+
+    // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define HOST_FUNC(N, F) {N, reinterpret_cast<void*>(F)}
+
+    const HostFunction HOST_FUNCTIONS[] = {
+        HOST_FUNC("amx_Allot", HostAmxAllot),
+        HOST_FUNC("amx_Exec", HostAmxExec),
+        HOST_FUNC("amx_Execv", HostAmxExecV),
+        HOST_FUNC("amx_FindNative", HostAmxFindNative),
+        HOST_FUNC("amx_FindPublic", HostAmxFindPublic),
+        HOST_FUNC("amx_Push", HostAmxPush),
+        HOST_FUNC("AddLibraries", HostAddLibraries),
+        HOST_FUNC("AddNatives", HostAddNatives),
+        HOST_FUNC("AddNewNatives", HostAddNatives),
+        HOST_FUNC("AmxReregister", HostAmxReRegister),
+        HOST_FUNC("BuildPathname", HostBuildPathName),
+        HOST_FUNC("BuildPathnameR", HostBuildPathNameR),
+        HOST_FUNC("CellToReal", HostCellToReal),
+        HOST_FUNC("CopyAmxMemory", HostCopyAmxMemory),
+        HOST_FUNC("ExecuteForward", HostExecuteForward),
+        HOST_FUNC("FindAmxScriptByAmx", HostFindAmxScriptByAmx),
+        HOST_FUNC("FindAmxScriptByName", HostFindAmxScriptByName),
+        HOST_FUNC("FindLibrary", HostFindLibrary),
+        HOST_FUNC("Format", HostFormat),
+        HOST_FUNC("FormatAmxString", HostFormatAmxString),
+        HOST_FUNC("GetAmxAddr", HostGetAmxAddress),
+        HOST_FUNC("GetAmxScript", HostGetAmxScript),
+        HOST_FUNC("GetAmxScriptName", HostGetAmxScriptName),
+        HOST_FUNC("GetAmxString", HostGetAmxString),
+        HOST_FUNC("GetAmxStringLen", HostGetAmxStringLen),
+        HOST_FUNC("GetLocalInfo", HostGetLocalInfo),
+        HOST_FUNC("GetModname", HostGetModName),
+        HOST_FUNC("GetPlayerArmor", (GetPlayerField<int, &FakePlayer::armor>)),
+        HOST_FUNC("GetPlayerCurweapon", (GetPlayerField<int, &FakePlayer::current_weapon>)),
+        HOST_FUNC("GetPlayerDeaths", (GetPlayerField<int, &FakePlayer::deaths>)),
+        HOST_FUNC("GetPlayerEdict", (GetPlayerField<cssdk::Edict*, &FakePlayer::edict>)),
+        HOST_FUNC("GetPlayerFlags", HostGetPlayerFlags),
+        HOST_FUNC("GetPlayerFrags", (GetPlayerField<int, &FakePlayer::frags>)),
+        HOST_FUNC("GetPlayerHealth", (GetPlayerField<int, &FakePlayer::health>)),
+        HOST_FUNC("GetPlayerIP", HostGetPlayerIp),
+        HOST_FUNC("GetPlayerKeys", (GetPlayerField<int, &FakePlayer::keys>)),
+        HOST_FUNC("GetPlayerMenu", (GetPlayerField<int, &FakePlayer::menu>)),
+        HOST_FUNC("GetPlayerName", HostGetPlayerName),
+        HOST_FUNC("GetPlayerPlayTime", (GetPlayerField<float, &FakePlayer::play_time>)),
+        HOST_FUNC("GetPlayerTeam", HostGetPlayerTeam),
+        HOST_FUNC("GetPlayerTeamID", (GetPlayerField<int, &FakePlayer::team_id>)),
+        HOST_FUNC("GetPlayerTime", (GetPlayerField<float, &FakePlayer::time>)),
+        HOST_FUNC("IsPlayerAlive", GetPlayerBool<&FakePlayer::alive>),
+        HOST_FUNC("IsPlayerAuthorized", GetPlayerBool<&FakePlayer::authorized>),
+        HOST_FUNC("IsPlayerBot", GetPlayerBool<&FakePlayer::bot>),
+        HOST_FUNC("IsPlayerConnecting", GetPlayerBool<&FakePlayer::connecting>),
+        HOST_FUNC("IsPlayerHLTV", GetPlayerBool<&FakePlayer::hltv>),
+        HOST_FUNC("IsPlayerInGame", GetPlayerBool<&FakePlayer::in_game>),
+        HOST_FUNC("IsPlayerValid", HostIsPlayerValid),
+        HOST_FUNC("LoadAmxScript", HostLoadAmxScript),
+        HOST_FUNC("Log", HostLog),
+        HOST_FUNC("LogError", HostLogError),
+        HOST_FUNC("MergeDefinitionFile", HostMergeDefinitionFile),
+        HOST_FUNC("MessageBlock", HostMessageBlock),
+        HOST_FUNC("OverrideNatives", HostOverrideNatives),
+        HOST_FUNC("PlayerPropAddr", HostPlayerPropAddress),
+        HOST_FUNC("PrepareCellArray", HostPrepareCellArray),
+        HOST_FUNC("PrepareCellArrayA", HostPrepareCellArrayA),
+        HOST_FUNC("PrepareCharArray", HostPrepareCharArray),
+        HOST_FUNC("PrepareCharArrayA", HostPrepareCharArrayA),
+        HOST_FUNC("PrintSrvConsole", HostPrintConsole),
+        HOST_FUNC("RaiseAmxError", HostRaiseAmxError),
+        HOST_FUNC("RealToCell", HostRealToCell),
+        HOST_FUNC("RegAuthFunc", HostRegisterAuthFunc),
+        HOST_FUNC("RegisterForward", HostRegisterForward),
+        HOST_FUNC("RegisterFunction", HostRegisterFunction),
+        HOST_FUNC("RegisterFunctionEx", HostRegisterFunctionEx),
+        HOST_FUNC("RegisterSPForward", HostRegisterSpForward),
+        HOST_FUNC("RegisterSPForwardByName", HostRegisterSpForwardByName),
+        HOST_FUNC("RemoveLibraries", HostRemoveLibraries),
+        HOST_FUNC("SetAmxString", HostSetAmxString),
+        HOST_FUNC("SetPlayerTeamInfo", HostSetPlayerTeamInfo),
+        HOST_FUNC("UnloadAmxScript", HostUnloadAmxScript),
+        HOST_FUNC("UnregAuthFunc", HostUnregisterAuthFunc),
+        HOST_FUNC("UnregisterSPForward", HostUnregisterSpForward),
+        HOST_FUNC("GetAmxStringNull", HostGetAmxStringNull),
+        HOST_FUNC("GetAmxVectorNull", HostGetAmxVectorNull),
+        HOST_FUNC("GetConfigManager", HostGetConfigManager),
+        HOST_FUNC("LoadAmxScriptEx", HostLoadAmxScriptEx),
+        HOST_FUNC("SetAmxStringUTF8Cell", HostSetAmxStringUtf8Cell),
+        HOST_FUNC("SetAmxStringUTF8Char", HostSetAmxStringUtf8Char),
+    };
+
+#undef HOST_FUNC
+}
+
+namespace amxx::host
+{
+    void* RequestFunction(const char* const name)
+    {
+        for (const auto& disabled : g_host.disabled) {
+            if (disabled == name) {
+                return nullptr;
+            }
+        }
+
+        for (const auto& function : HOST_FUNCTIONS) {
+            if (std::strcmp(function.name, name) == 0) {
+                return function.pointer;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void DisableFunction(const char* const name)
+    {
+        g_host.disabled.emplace_back(name);
+    }
+
+    void EnableFunctions()
+    {
+        g_host.disabled.clear();
+    }
+
+    ModuleEntryPoints LinkedModule()
+    {
+        return {AMXX_Query,         AMXX_CheckGame,       AMXX_Attach,          AMXX_Detach,
+                AMXX_PluginsLoaded, AMXX_PluginsUnloaded, AMXX_PluginsUnloading};
+    }
+
+    void* LoadModuleLibrary(const char* const path, ModuleEntryPoints& entry_points)
+    {
+#ifdef _WIN32
+        auto* const handle = LoadLibraryA(path);
+        const auto symbol = [handle](const char* name) { return reinterpret_cast<void*>(GetProcAddress(handle, name)); };
+#else
+        auto* const handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+        const auto symbol = [handle](const char* name) { return dlsym(handle, name); };
+#endif
+
+        if (!handle) {
+            return nullptr;
+        }
+
+        entry_points.query = reinterpret_cast<decltype(entry_points.query)>(symbol("AMXX_Query"));
+        entry_points.check_game = reinterpret_cast<decltype(entry_points.check_game)>(symbol("AMXX_CheckGame"));
+        entry_points.attach = reinterpret_cast<decltype(entry_points.attach)>(symbol("AMXX_Attach"));
+        entry_points.detach = reinterpret_cast<decltype(entry_points.detach)>(symbol("AMXX_Detach"));
+        entry_points.plugins_loaded = reinterpret_cast<decltype(entry_points.plugins_loaded)>(symbol("AMXX_PluginsLoaded"));
+        entry_points.plugins_unloaded =
+            reinterpret_cast<decltype(entry_points.plugins_unloaded)>(symbol("AMXX_PluginsUnloaded"));
+        entry_points.plugins_unloading =
+            reinterpret_cast<decltype(entry_points.plugins_unloading)>(symbol("AMXX_PluginsUnloading"));
+
+        return reinterpret_cast<void*>(handle);
+    }
+
+    void UnloadModuleLibrary(void* const handle)
+    {
+        if (!handle) {
+            return;
+        }
+
+#ifdef _WIN32
+        FreeLibrary(static_cast<HMODULE>(handle));
+#else
+        dlclose(handle);
+#endif
+    }
+
+    Status AttachModule(const ModuleEntryPoints& module)
+    {
+        if (!module.query || !module.attach) {
+            return Status::InvalidParameter;
+        }
+
+        auto interface_version = AMXX_INTERFACE_VERSION;
+        ModuleInfo info{};
+
+        if (const auto status = module.query(&interface_version, &info); status != Status::Ok) {
+            return status;
+        }
+
+        if (module.check_game && module.check_game(g_host.mod_name.c_str()) != GameStatus::Ok) {
+            return Status::Failed;
+        }
+
+        const auto status = module.attach(RequestFunction);
+
+        if (status == Status::Ok) {
+            g_host.module = module;
+            g_host.attached = true;
+        }
+
+        return status;
+    }
+
+    void DetachModule()
+    {
+        if (g_host.attached && g_host.module.detach) {
+            g_host.module.detach();
+        }
+
+        g_host.attached = false;
+    }
+
+    void PluginsLoaded()
+    {
+        if (g_host.attached && g_host.module.plugins_loaded) {
+            g_host.module.plugins_loaded();
+        }
+    }
+
+    void UnloadPlugins()
+    {
+        if (g_host.attached && g_host.module.plugins_unloading) {
+            g_host.module.plugins_unloading();
+        }
+
+        g_host.plugins.clear();
+        g_host.multi_forwards.clear();
+        g_host.sp_forwards.clear();
+
+        if (g_host.attached && g_host.module.plugins_unloaded) {
+            g_host.module.plugins_unloaded();
+        }
+    }
+
+    Amx* AddPlugin(const char* const name, std::vector<FakePublicInfo> publics, std::vector<std::string> natives,
+                   const std::size_t memory_cells)
+    {
+        auto plugin = std::make_unique<Plugin>();
+        plugin->name = name;
+
+        std::size_t names_size = sizeof(std::uint16_t);
+
+        for (const auto& info : publics) {
+            plugin->public_names.emplace_back(info.name);
+            plugin->publics.push_back(std::move(info.func));
+            names_size += plugin->public_names.back().size() + 1;
+        }
+
+        for (auto& native : natives) {
+            names_size += native.size() + 1;
+            plugin->native_names.push_back(std::move(native));
+        }
+
+        const auto align = [](const std::size_t offset) { return (offset + sizeof(cell) - 1) & ~(sizeof(cell) - 1); };
+        const auto publics_offset = sizeof(AmxHeader);
+        const auto natives_offset = publics_offset + plugin->public_names.size() * sizeof(AmxFuncStubNt);
+        const auto names_offset = natives_offset + plugin->native_names.size() * sizeof(AmxFuncStubNt);
+        const auto code_offset = align(names_offset + names_size);
+        const auto data_offset = code_offset + sizeof(cell);
+        const auto stack_top = data_offset + memory_cells * sizeof(cell);
+
+        plugin->image.assign(stack_top / sizeof(cell), 0);
+
+        auto* const base = reinterpret_cast<unsigned char*>(plugin->image.data());
+        auto* const header = reinterpret_cast<AmxHeader*>(base);
+
+        header->size = static_cast<std::int32_t>(data_offset);
+        header->magic = AMX_MAGIC;
+        header->file_version = static_cast<std::byte>(CUR_FILE_VERSION);
+        header->amx_version = static_cast<std::byte>(MIN_AMX_VERSION);
+        header->definition_size = sizeof(AmxFuncStubNt);
+        header->cod = static_cast<std::int32_t>(code_offset);
+        header->dat = static_cast<std::int32_t>(data_offset);
+        header->hea = static_cast<std::int32_t>(data_offset);
+        header->stp = static_cast<std::int32_t>(stack_top);
+        header->cip = -1;
+        header->publics = static_cast<std::int32_t>(publics_offset);
+        header->natives = static_cast<std::int32_t>(natives_offset);
+        header->libraries = static_cast<std::int32_t>(names_offset);
+        header->public_vars = static_cast<std::int32_t>(names_offset);
+        header->tags = static_cast<std::int32_t>(names_offset);
+        header->name_table = static_cast<std::int32_t>(names_offset);
+
+        // Name table: the maximum name length followed by the zero-terminated names.
+        auto name_offset = names_offset + sizeof(std::uint16_t);
+        const std::uint16_t max_name_length = AMX_NAME_MAX;
+        std::memcpy(base + names_offset, &max_name_length, sizeof(max_name_length));
+
+        const auto write_entry = [&](const std::size_t entry_offset, const std::string& entry_name, const ucell address) {
+            const AmxFuncStubNt entry{address, static_cast<ucell>(name_offset)};
+            std::memcpy(base + entry_offset, &entry, sizeof(entry));
+            std::memcpy(base + name_offset, entry_name.c_str(), entry_name.size() + 1);
+            name_offset += entry_name.size() + 1;
+        };
+
+        for (std::size_t i = 0; i < plugin->public_names.size(); ++i) {
+            write_entry(publics_offset + i * sizeof(AmxFuncStubNt), plugin->public_names[i], static_cast<ucell>(i));
+        }
+
+        for (std::size_t i = 0; i < plugin->native_names.size(); ++i) {
+            write_entry(natives_offset + i * sizeof(AmxFuncStubNt), plugin->native_names[i], 0);
+        }
+
+        auto& amx = plugin->amx;
+        amx.base = base;
+        amx.hea = amx.hlw = 0;
+        amx.stp = static_cast<cell>(stack_top - data_offset - sizeof(cell));
+        amx.stk = amx.reset_stk = amx.stp;
+        amx.reset_hea = amx.hea;
+        amx.flags = AMX_FLAG_NTV_REG;
+
+        return &g_host.plugins.emplace_back(std::move(plugin))->amx;
+    }
+
+    Amx* LoadPlugin(const char* const name, std::vector<cell> image)
+    {
+        auto plugin = std::make_unique<Plugin>();
+        plugin->name = name;
+        plugin->image = std::move(image);
+
+        if (plugin->image.size() * sizeof(cell) >= sizeof(AmxHeader)) {
+            const auto stack_top = reinterpret_cast<const AmxHeader*>(plugin->image.data())->stp;
+
+            if (stack_top > 0 && static_cast<std::size_t>(stack_top) > plugin->image.size() * sizeof(cell)) {
+                plugin->image.resize((static_cast<std::size_t>(stack_top) + sizeof(cell) - 1) / sizeof(cell), 0);
+            }
+        }
+
+        plugin->interpreter = std::make_unique<amx::Interpreter>();
+
+        const auto error = plugin->interpreter->Init(&plugin->amx, reinterpret_cast<unsigned char*>(plugin->image.data()),
+                                                     plugin->image.size() * sizeof(cell));
+
+        if (error != AmxError::None) {
+            AddMessage("[fake host] Plugin \"" + plugin->name + "\" failed to load (error " +
+                       std::to_string(static_cast<int>(error)) + ")");
+            return nullptr;
+        }
+
+        const AmxIndex index{&plugin->amx};
+
+        for (auto i = 0; i < index.PublicCount(); ++i) {
+            plugin->public_names.emplace_back(index.PublicName(i));
+        }
+
+        for (auto i = 0; i < index.NativeCount(); ++i) {
+            plugin->native_names.emplace_back(index.NativeName(i));
+        }
+
+        plugin->interpreter->ResolveNatives([](const char* const native) { return FindNative(native); });
+
+        return &g_host.plugins.emplace_back(std::move(plugin))->amx;
+    }
+
+    Amx* LoadPluginFile(const char* const path)
+    {
+        const amx::AmxxFile file{path};
+        std::vector<cell> image{};
+
+        if (const auto error = file.IsOpen() ? file.Load(image) : AmxError::NotFound; error != AmxError::None) {
+            AddMessage("[fake host] Plugin \"" + std::string{path} + "\" failed to load: " +
+                       (file.ErrorText().empty() ? "invalid plugin image" : file.ErrorText()));
+            return nullptr;
+        }
+
+        return LoadPlugin(path, std::move(image));
+    }
+
+    int PluginCount()
+    {
+        return static_cast<int>(g_host.plugins.size());
+    }
+
+    void PausePlugin(const Amx* const amx, const bool paused)
+    {
+        if (auto* const plugin = FindPlugin(amx)) {
+            plugin->paused = paused;
+        }
+    }
+
+    AmxNative FindNative(const std::string_view name)
+    {
+        const auto it = g_host.natives.find(std::string{name});
+        return it != g_host.natives.end() ? it->second : nullptr;
+    }
+
+    cell CallNative(Amx* const amx, const std::string_view name, const std::initializer_list<cell> args)
+    {
+        const auto native = FindNative(name);
+
+        if (!native) {
+            AddMessage("[fake host] Native \"" + std::string{name} + "\" is not registered");
+            return 0;
+        }
+
+        std::vector<cell> params{};
+        params.reserve(args.size() + 1);
+        params.push_back(static_cast<cell>(args.size() * sizeof(cell)));
+        params.insert(params.end(), args.begin(), args.end());
+
+        amx->error = static_cast<int>(AmxError::None);
+
+        return native(amx, params.data());
+    }
+
+    FakePlayer& GetFakePlayer(const int id)
+    {
+        return g_host.players[id];
+    }
+
+    void ConnectPlayer(const int id, const char* const name, const bool bot)
+    {
+        auto& player = g_host.players[id];
+
+        player = FakePlayer{};
+        std::snprintf(player.name, sizeof(player.name), "%s", name);
+        std::snprintf(player.ip, sizeof(player.ip), "%s", bot ? "" : "127.0.0.1");
+        player.in_game = true;
+        player.authorized = true;
+        player.bot = bot;
+        player.alive = true;
+        player.health = 100;
+    }
+
+    void DisconnectPlayer(const int id)
+    {
+        g_host.players[id] = FakePlayer{};
+    }
+
+    const std::vector<std::string>& Messages()
+    {
+        return g_host.messages;
+    }
+
+    void ClearMessages()
+    {
+        g_host.messages.clear();
+    }
+
+    void SetEcho(const bool echo)
+    {
+        g_host.echo = echo;
+    }
+
+    void SetModName(const char* const mod_name)
+    {
+        g_host.mod_name = mod_name;
+    }
+
+    void SetMaxClients(const int max_clients)
+    {
+        g_host.max_clients = max_clients < 1 ? 1 : max_clients > MAX_CLIENTS ? MAX_CLIENTS : max_clients;
+    }
+
+    void SetLocalInfo(const char* const name, const char* const value)
+    {
+        g_host.local_info[name] = value;
+    }
+
+    void ResetState()
+    {
+        const auto module = g_host.module;
+        const auto attached = g_host.attached;
+        const auto echo = g_host.echo;
+        auto natives = std::move(g_host.natives);
+
+        g_host = HostState{};
+        g_host.module = module;
+        g_host.attached = attached;
+        g_host.echo = echo;
+        g_host.natives = std::move(natives);
+    }
+}
@@ -19,6 +19,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <string>
 
 //-V::122
@@ -149,6 +150,11 @@ constexpr auto AMX_EXEC_CONT = -2;
 */
 constexpr auto AMX_USER_NUM = 4;
 
+/**
+ * @brief Safety margin kept between the heap and the stack, in bytes.
+*/
+constexpr auto AMX_STACK_MARGIN = 16 * static_cast<int>(sizeof(cell));
+
 /**
  * @brief Maximum name length for file version <= 6.
 */
@@ -588,8 +594,156 @@ struct Amx
 #endif
 #endif
 
+namespace amx::simd
+{
+    enum class Level
+    {
+        /**
+         * @brief Portable loops.
+        */
+        Scalar = 0,
+
+        /**
+         * @brief 128-bit SSE2 kernels.
+        */
+        Sse2,
+
+        /**
+         * @brief 256-bit AVX2 kernels.
+        */
+        Avx2
+    };
+
+    /**
+     * @brief Returns the kernel set selected for this CPU.
+    */
+    Level ActiveLevel();
+
+    /**
+     * @brief Forces a kernel set (clamped to what the CPU supports); returns the level in effect.
+    */
+    Level SetLevel(Level level);
+
+    /**
+     * @brief Length of a zero-terminated cell string, scanning at most \c max_length cells.
+    */
+    std::size_t CellStringLength(const cell* address, std::size_t max_length);
+
+    /**
+     * @brief Packs \c count cells into chars, keeping the low byte of each cell.
+    */
+    void NarrowCells(char* dest, const cell* src, std::size_t count);
+
+    /**
+     * @brief Widens \c count chars into cells, same as \c static_cast<cell>(char).
+    */
+    void WidenChars(cell* dest, const char* src, std::size_t count);
+
+    /**
+     * @brief Widens \c count bytes into cells, zero-extended as \c static_cast<unsigned char>.
+    */
+    void WidenBytes(cell* dest, const char* src, std::size_t count);
+
+    /**
+     * @brief Returns true if \c length bytes of \c src are well-formed UTF-8.
+    */
+    bool ValidateUtf8(const char* src, std::size_t length);
+
+    /**
+     * @brief Copies \c count cells; the ranges may overlap.
+    */
+    void CopyCells(cell* dest, const cell* src, std::size_t count);
+
+    /**
+     * @brief Sets \c count cells to \c value.
+    */
+    void FillCells(cell* dest, cell value, std::size_t count);
+
+    /**
+     * @brief Returns the index of the first cell that differs, or \c count if the ranges are equal.
+    */
+    std::size_t CompareCells(const cell* first, const cell* second, std::size_t count);
+
+    /**
+     * @brief Returns the index of the first cell equal to \c value, or \c count if there is none.
+    */
+    std::size_t FindCell(const cell* src, cell value, std::size_t count);
+
+    /**
+     * @brief Returns the number of cells equal to \c value.
+    */
+    std::size_t CountCell(const cell* src, cell value, std::size_t count);
+}
+
 namespace amx
 {
+    /**
+     * @brief Builds a tag for \c Amx::user_tags from four characters.
+    */
+    constexpr long MakeUserTag(const char a, const char b, const char c, const char d)
+    {
+        return static_cast<long>(a) << 24 | static_cast<long>(b) << 16 | static_cast<long>(c) << 8 | static_cast<long>(d);
+    }
+
+    /**
+     * @brief First \c Amx::user_data slot the core addresses by fixed index, without a tag
+     * (\c UD_HANDLER, \c UD_DEBUGGER and \c UD_FINDPLUGIN). A null slot there is not a free one:
+     * \c UD_DEBUGGER stays null for plugins built without debug info and is still read by the core.
+    */
+    constexpr auto AMX_USER_CORE_FIRST = 1;
+
+    /**
+     * @brief Returns the user data stored under \c tag, or nullptr.
+    */
+    inline void* GetUserData(const Amx* const amx, const long tag)
+    {
+        for (auto i = 0; i < AMX_USER_CORE_FIRST; ++i) {
+            if (amx->user_tags[i] == tag) {
+                return amx->user_data[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * @brief Stores \c ptr under \c tag in a slot the core does not reserve.
+     * Returns false if there is none left; callers then keep their own lookup.
+    */
+    inline bool SetUserData(Amx* const amx, const long tag, void* const ptr)
+    {
+        for (auto i = 0; i < AMX_USER_CORE_FIRST; ++i) {
+            if (amx->user_tags[i] == tag) {
+                amx->user_data[i] = ptr;
+                return true;
+            }
+        }
+
+        for (auto i = 0; i < AMX_USER_CORE_FIRST; ++i) {
+            if (amx->user_tags[i] == 0 && amx->user_data[i] == nullptr) {
+                amx->user_tags[i] = tag;
+                amx->user_data[i] = ptr;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Releases the slot stored under \c tag.
+    */
+    inline void RemoveUserData(Amx* const amx, const long tag)
+    {
+        for (auto i = 0; i < AMX_USER_CORE_FIRST; ++i) {
+            if (amx->user_tags[i] == tag) {
+                amx->user_tags[i] = 0;
+                amx->user_data[i] = nullptr;
+                return;
+            }
+        }
+    }
+
     /**
      * @brief Real to cell.
     */
@@ -623,13 +777,7 @@ namespace amx
     */
     inline std::size_t GetStringLen(const cell* const address)
     {
-        std::size_t length{0};
-
-        while (address[length]) {
-            ++length;
-        }
-
-        return length;
+        return simd::CellStringLength(address, SIZE_MAX);
     }
 
     /**
@@ -649,10 +797,7 @@ namespace amx
 
         if (const auto length = GetStringLen(address)) {
             string.resize(length);
-
-            for (std::size_t i = 0; i < length; ++i) {
-                string[i] = static_cast<std::string::value_type>(address[i]);
-            }
+            simd::NarrowCells(string.data(), address, length);
         }
 
         return string;
@@ -665,4 +810,77 @@ namespace amx
     {
         return GetString(Address(amx, address));
     }
+
+    /**
+     * @brief Writes \c source into the plugin memory at \c address, truncated to \c max_len characters.
+     * Returns the number of characters written, not counting the terminating zero.
+    */
+    inline std::size_t SetString(const Amx* const amx, const cell address, const char* const source,
+                                 const std::size_t source_len, const std::size_t max_len)
+    {
+        auto* const dest = Address(amx, address);
+        const auto length = source_len < max_len ? source_len : max_len;
+
+        simd::WidenChars(dest, source, length);
+        dest[length] = 0;
+
+        return length;
+    }
+
+    /**
+     * @brief Same as \c SetString, but never cuts a UTF-8 sequence in half when truncating.
+     * As in the core, bytes are zero-extended and the copy stops at an embedded zero.
+    */
+    inline std::size_t SetStringUtf8(const Amx* const amx, const cell address, const char* const source,
+                                     const std::size_t source_len, const std::size_t max_len)
+    {
+        auto* const dest = Address(amx, address);
+        auto length = source_len < max_len ? source_len : max_len;
+        auto truncated = source_len > max_len;
+
+        if (const auto* const end = static_cast<const char*>(std::memchr(source, 0, length))) {
+            length = static_cast<std::size_t>(end - source);
+            truncated = false;
+        }
+
+        simd::WidenBytes(dest, source, length);
+
+        if (truncated && length && (dest[length - 1] & 0x80)) {
+            std::size_t count = 1;
+            auto lead = length - 1;
+
+            while (lead && (dest[lead] & 0xC0) == 0x80) {
+                --lead;
+                ++count;
+            }
+
+            std::size_t expected = 0;
+
+            switch (dest[lead] & 0xF0) {
+            case 0xC0:
+            case 0xD0:
+                expected = 2;
+                break;
+
+            case 0xE0:
+                expected = 3;
+                break;
+
+            case 0xF0:
+                expected = 4;
+                break;
+
+            default:
+                break;
+            }
+
+            if (expected != count) {
+                length -= count;
+            }
+        }
+
+        dest[length] = 0;
+
+        return length;
+    }
 }
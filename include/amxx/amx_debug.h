@@ -0,0 +1,140 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace amx
+{
+    /**
+     * @brief N/D
+    */
+    constexpr std::uint16_t AMX_DBG_MAGIC = 0xF1EF;
+
+#pragma pack(push, 1)
+
+    /**
+     * @brief Header of the debug information the compiler appends to an image built with debug info.
+    */
+    struct DebugHeader
+    {
+        /**
+         * @brief Size of the debug information, this header included.
+        */
+        std::int32_t size;
+
+        std::uint16_t magic;
+        std::int8_t file_version;
+        std::int8_t amx_version;
+        std::int16_t flags;
+        std::int16_t files;
+        std::int16_t lines;
+        std::int16_t symbols;
+        std::int16_t tags;
+        std::int16_t automatons;
+        std::int16_t states;
+    };
+
+#pragma pack(pop)
+
+    /**
+     * @brief Function, file and line tables of the debug information, copied out of the image.
+    */
+    class DebugInfo
+    {
+    public:
+        /**
+         * @brief Parses \c size bytes of debug information; returns false and stays empty if they are malformed.
+        */
+        bool Parse(const unsigned char* data, std::size_t size);
+
+        /**
+         * @brief Parses the debug information that follows the image of \c amx.
+         * It is only there if the image has \c AMX_FLAG_DEBUG and the heap and stack have not overwritten it yet,
+         * so call this before the plugin runs; otherwise parse a copy taken from the plugin file.
+        */
+        bool ParseImage(const Amx* amx);
+
+        /**
+         * @brief N/D
+        */
+        void Clear();
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] bool Empty() const
+        {
+            return functions_.empty();
+        }
+
+        /**
+         * @brief Name of the function whose code contains \c address, or nullptr.
+        */
+        [[nodiscard]] const char* FunctionAt(ucell address) const;
+
+        /**
+         * @brief Source file of the code at \c address, or nullptr.
+        */
+        [[nodiscard]] const char* FileAt(ucell address) const;
+
+        /**
+         * @brief Source line of the code at \c address (1-based), or 0.
+        */
+        [[nodiscard]] int LineAt(ucell address) const;
+
+    private:
+        struct Function
+        {
+            ucell start;
+            ucell end;
+            std::string name;
+        };
+
+        struct File
+        {
+            ucell address;
+            std::string name;
+        };
+
+        struct Line
+        {
+            ucell address;
+            std::int32_t line;
+        };
+
+        /**
+         * @brief Sorted by start address.
+        */
+        std::vector<Function> functions_{};
+
+        /**
+         * @brief Sorted by address; a file covers the code up to the next one.
+        */
+        std::vector<File> files_{};
+
+        /**
+         * @brief Sorted by address; a line covers the code up to the next one.
+        */
+        std::vector<Line> lines_{};
+    };
+}
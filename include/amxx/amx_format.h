@@ -0,0 +1,516 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/cell_string.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+//
+// Pawn-style formatting into caller buffers.
+// A format is split once into pieces, literal runs and conversions: at compile time for C++ literals through
+// CompiledFormat, and on first use for plugin formats, whose pieces are cached per script and address.
+// Plugin arguments are read straight from the params of the native. Supported are %d %i %u %f %s %c %x %X %b
+// and %%, with the '-' and '0' flags, a width and a precision. Plugin formats with anything else (%L, %n, %a)
+// are handed to the core's FormatAmxString.
+//
+
+namespace amx
+{
+    enum class FormatConversion : std::uint8_t
+    {
+        /**
+         * @brief Literal run of the format string.
+        */
+        Text = 0,
+
+        /**
+         * @brief %d and %i.
+        */
+        Integer,
+
+        /**
+         * @brief %u.
+        */
+        Unsigned,
+
+        /**
+         * @brief %f; six decimals unless a precision is given.
+        */
+        Float,
+
+        /**
+         * @brief %s; the precision limits the number of characters.
+        */
+        String,
+
+        /**
+         * @brief %c.
+        */
+        Char,
+
+        /**
+         * @brief %x.
+        */
+        Hex,
+
+        /**
+         * @brief %X.
+        */
+        HexUpper,
+
+        /**
+         * @brief %b.
+        */
+        Binary,
+
+        /**
+         * @brief Anything else; only formatted by the core.
+        */
+        Unsupported
+    };
+
+    /**
+     * @brief One piece of a parsed format.
+    */
+    struct FormatSpec
+    {
+        FormatConversion conversion{};
+        bool left_align{};
+        bool zero_pad{};
+        std::uint16_t width{};
+        std::int16_t precision = -1;
+
+        /**
+         * @brief Range of the piece in the format string; for \c FormatConversion::Text, the text to copy.
+        */
+        std::uint32_t offset{};
+
+        /**
+         * @brief N/D
+        */
+        std::uint32_t length{};
+    };
+
+    enum class FormatArgKind : std::uint8_t
+    {
+        Integer = 0,
+        Float,
+        String,
+        Cells
+    };
+
+    /**
+     * @brief Argument of \c FormatPieces, converted from its C++ type or read from the params of a native.
+    */
+    struct FormatArg
+    {
+        FormatArgKind kind{};
+
+        /**
+         * @brief Signed value, for %d and %c.
+        */
+        std::int64_t integer{};
+
+        /**
+         * @brief Bits of the value at its own width, for %u, %x and %b.
+        */
+        std::uint64_t bits{};
+
+        /**
+         * @brief N/D
+        */
+        double real{};
+
+        /**
+         * @brief N/D
+        */
+        const char* chars{};
+
+        /**
+         * @brief N/D
+        */
+        const cell* cells{};
+
+        /**
+         * @brief Length of \c chars or \c cells.
+        */
+        std::size_t length{};
+    };
+
+    /**
+     * @brief Splits \c format into pieces; returns the number of pieces, which may exceed \c capacity.
+    */
+    constexpr std::size_t ParseFormat(const std::string_view format, FormatSpec* const specs, const std::size_t capacity)
+    {
+        std::size_t count = 0;
+
+        const auto add = [specs, capacity, &count](const FormatSpec& spec) {
+            if (count < capacity) {
+                specs[count] = spec;
+            }
+
+            ++count;
+        };
+
+        const auto text = [](const std::size_t offset, const std::size_t length) {
+            FormatSpec spec{};
+            spec.offset = static_cast<std::uint32_t>(offset);
+            spec.length = static_cast<std::uint32_t>(length);
+
+            return spec;
+        };
+
+        const auto digit = [&format](const std::size_t index) {
+            return index < format.size() && format[index] >= '0' && format[index] <= '9';
+        };
+
+        std::size_t i = 0;
+
+        while (i < format.size()) {
+            if (format[i] != '%') {
+                const auto start = i;
+
+                while (i < format.size() && format[i] != '%') {
+                    ++i;
+                }
+
+                add(text(start, i - start));
+                continue;
+            }
+
+            // A trailing '%' is kept as is; "%%" is a literal '%'.
+            if (i + 1 == format.size() || format[i + 1] == '%') {
+                add(text(i + 1 == format.size() ? i : i + 1, 1));
+                i += 2;
+                continue;
+            }
+
+            FormatSpec spec{};
+            spec.offset = static_cast<std::uint32_t>(i++);
+
+            for (; i < format.size() && (format[i] == '-' || format[i] == '0'); ++i) {
+                (format[i] == '-' ? spec.left_align : spec.zero_pad) = true;
+            }
+
+            for (; digit(i); ++i) {
+                spec.width = static_cast<std::uint16_t>(spec.width < 1000 ? spec.width * 10 + (format[i] - '0') : spec.width);
+            }
+
+            if (i < format.size() && format[i] == '.') {
+                spec.precision = 0;
+
+                for (++i; digit(i); ++i) {
+                    spec.precision = static_cast<std::int16_t>(spec.precision < 1000 ? spec.precision * 10 + (format[i] - '0') : spec.precision);
+                }
+            }
+
+            if (i == format.size()) {
+                spec.conversion = FormatConversion::Unsupported;
+            }
+            else {
+                switch (format[i++]) {
+                case 'd':
+                case 'i':
+                    spec.conversion = FormatConversion::Integer;
+                    break;
+
+                case 'u':
+                    spec.conversion = FormatConversion::Unsigned;
+                    break;
+
+                case 'f':
+                    spec.conversion = FormatConversion::Float;
+                    break;
+
+                case 's':
+                    spec.conversion = FormatConversion::String;
+                    break;
+
+                case 'c':
+                    spec.conversion = FormatConversion::Char;
+                    break;
+
+                case 'x':
+                    spec.conversion = FormatConversion::Hex;
+                    break;
+
+                case 'X':
+                    spec.conversion = FormatConversion::HexUpper;
+                    break;
+
+                case 'b':
+                    spec.conversion = FormatConversion::Binary;
+                    break;
+
+                default:
+                    spec.conversion = FormatConversion::Unsupported;
+                    break;
+                }
+            }
+
+            spec.length = static_cast<std::uint32_t>(i - spec.offset);
+            add(spec);
+        }
+
+        return count;
+    }
+
+    /**
+     * @brief Returns true if an argument of \c kind can be formatted by \c conversion.
+    */
+    constexpr bool FormatAccepts(const FormatConversion conversion, const FormatArgKind kind)
+    {
+        switch (conversion) {
+        case FormatConversion::Float:
+            return kind == FormatArgKind::Float;
+
+        case FormatConversion::String:
+            return kind == FormatArgKind::String || kind == FormatArgKind::Cells;
+
+        case FormatConversion::Text:
+        case FormatConversion::Unsupported:
+            return false;
+
+        default:
+            return kind == FormatArgKind::Integer;
+        }
+    }
+
+    /**
+     * @brief Format string parsed at compile time.
+     *
+     * @code
+     * static constexpr amx::CompiledFormat HUD_FORMAT{"HP: %d | Armor: %d | %s"};
+     * char text[128];
+     * amx::FormatTo<HUD_FORMAT>(text, sizeof(text), health, armor, weapon_name);
+     * @endcode
+    */
+    template <std::size_t N>
+    class CompiledFormat
+    {
+    public:
+        // ReSharper disable once CppNonExplicitConvertingConstructor
+        constexpr CompiledFormat(const char (&format)[N]) // NOLINT(google-explicit-constructor)
+        {
+            for (std::size_t i = 0; i < N; ++i) {
+                text_[i] = format[i];
+            }
+
+            count_ = ParseFormat({format, N - 1}, specs_.data(), specs_.size());
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr std::string_view Text() const
+        {
+            return {text_, N - 1};
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr const FormatSpec* Specs() const
+        {
+            return specs_.data();
+        }
+
+        /**
+         * @brief Number of pieces.
+        */
+        [[nodiscard]] constexpr std::size_t Count() const
+        {
+            return count_;
+        }
+
+        /**
+         * @brief Number of arguments the format takes.
+        */
+        [[nodiscard]] constexpr std::size_t ArgCount() const
+        {
+            std::size_t args = 0;
+
+            for (std::size_t i = 0; i < count_; ++i) {
+                args += specs_[i].conversion != FormatConversion::Text;
+            }
+
+            return args;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr bool Supported() const
+        {
+            for (std::size_t i = 0; i < count_; ++i) {
+                if (specs_[i].conversion == FormatConversion::Unsupported) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief Returns true if the argument \c index can be of \c kind.
+        */
+        [[nodiscard]] constexpr bool Accepts(const std::size_t index, const FormatArgKind kind) const
+        {
+            std::size_t arg = 0;
+
+            for (std::size_t i = 0; i < count_; ++i) {
+                if (specs_[i].conversion == FormatConversion::Text) {
+                    continue;
+                }
+
+                if (arg++ == index) {
+                    return FormatAccepts(specs_[i].conversion, kind);
+                }
+            }
+
+            return false;
+        }
+
+    private:
+        char text_[N]{};
+
+        /**
+         * @brief Every piece takes at least one character, so N is always enough.
+        */
+        std::array<FormatSpec, N> specs_{};
+
+        std::size_t count_{};
+    };
+
+    /**
+     * @brief Formats \c count pieces of \c format into \c buffer, always zero-terminated and truncated to \c size.
+     * Returns the length written. \c args holds one argument per conversion.
+    */
+    std::size_t FormatPieces(char* buffer, std::size_t size, std::string_view format, const FormatSpec* specs,
+                             std::size_t count, const FormatArg* args);
+
+    /**
+     * @brief Formats the arguments of a native the way the core's \c FormatAmxString does, into \c buffer.
+     * \c params[start_param] is the format and the arguments follow it, passed by reference as variadic
+     * arguments are. Returns the length written.
+    */
+    std::size_t FormatAmxString(Amx* amx, cell* params, int start_param, char* buffer, std::size_t size);
+
+    /**
+     * @brief N/D
+    */
+    template <std::size_t Size>
+    std::size_t FormatAmxString(Amx* amx, cell* params, const int start_param, char (&buffer)[Size])
+    {
+        return FormatAmxString(amx, params, start_param, buffer, Size);
+    }
+
+    namespace detail
+    {
+        template <typename T>
+        constexpr FormatArgKind FormatArgKindOf()
+        {
+            using Type = std::decay_t<T>;
+
+            if constexpr (std::is_integral_v<Type> || std::is_enum_v<Type>) {
+                return FormatArgKind::Integer;
+            }
+            else if constexpr (std::is_floating_point_v<Type>) {
+                return FormatArgKind::Float;
+            }
+            else if constexpr (std::is_same_v<Type, CellStringView>) {
+                return FormatArgKind::Cells;
+            }
+            else {
+                static_assert(std::is_convertible_v<const T&, std::string_view>, "Type cannot be formatted.");
+                return FormatArgKind::String;
+            }
+        }
+
+        template <typename T>
+        constexpr auto ToIntegral(const T value)
+        {
+            if constexpr (std::is_enum_v<T>) {
+                return static_cast<std::underlying_type_t<T>>(value);
+            }
+            else if constexpr (std::is_same_v<T, bool>) {
+                return static_cast<unsigned char>(value);
+            }
+            else {
+                return value;
+            }
+        }
+
+        template <typename T>
+        FormatArg MakeFormatArg(const T& value)
+        {
+            FormatArg arg{};
+            arg.kind = FormatArgKindOf<T>();
+
+            if constexpr (FormatArgKindOf<T>() == FormatArgKind::Integer) {
+                const auto integral = ToIntegral(value);
+                arg.integer = static_cast<std::int64_t>(integral);
+                arg.bits = static_cast<std::make_unsigned_t<decltype(integral)>>(integral);
+            }
+            else if constexpr (FormatArgKindOf<T>() == FormatArgKind::Float) {
+                arg.real = static_cast<double>(value);
+            }
+            else if constexpr (FormatArgKindOf<T>() == FormatArgKind::Cells) {
+                arg.cells = value.data();
+                arg.length = value.size();
+            }
+            else {
+                const std::string_view view{value};
+                arg.chars = view.data();
+                arg.length = view.size();
+            }
+
+            return arg;
+        }
+
+        template <const auto& Format, typename... TArgs, std::size_t... Indices>
+        constexpr bool FormatArgsMatch(std::index_sequence<Indices...>)
+        {
+            return (Format.Accepts(Indices, FormatArgKindOf<TArgs>()) && ...);
+        }
+    }
+
+    /**
+     * @brief Formats \c args with the compile-time \c Format into \c buffer; returns the length written.
+     * The number and types of the arguments are checked at compile time.
+    */
+    template <const auto& Format, typename... TArgs>
+    std::size_t FormatTo(char* const buffer, const std::size_t size, const TArgs&... args)
+    {
+        static_assert(Format.Supported(), "The format string has a conversion that only the core supports.");
+        static_assert(Format.ArgCount() == sizeof...(TArgs), "Wrong number of arguments for the format string.");
+        static_assert(detail::FormatArgsMatch<Format, TArgs...>(std::index_sequence_for<TArgs...>{}),
+                      "An argument does not match its conversion.");
+
+        // One extra element, so the array is never empty.
+        const FormatArg format_args[] = {detail::MakeFormatArg(args)..., FormatArg{}};
+
+        return FormatPieces(buffer, size, Format.Text(), Format.Specs(), Format.Count(), format_args);
+    }
+}
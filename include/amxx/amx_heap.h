@@ -0,0 +1,203 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/os_defs.h>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+namespace amxx
+{
+    /**
+     * @brief Block of plugin heap: the address seen by the plugin and the physical pointer.
+    */
+    struct AmxHeapBlock
+    {
+        cell address{};
+        cell* phys{};
+
+        explicit operator bool() const
+        {
+            return phys != nullptr;
+        }
+    };
+
+    /**
+     * @brief Bump arena over the plugin heap.
+     * Records \c Amx::hea on construction, serves allocations from as few heap bumps as possible
+     * and rolls \c Amx::hea back when the scope ends.
+    */
+    class AmxHeapScope
+    {
+    public:
+        explicit AmxHeapScope(Amx* amx)
+            : amx_(amx), saved_hea_(amx->hea), top_(amx->hea)
+        {
+        }
+
+        /**
+         * @brief Reserves room for \c cells in one heap bump, so the following allocations do not touch \c Amx::hea.
+        */
+        AmxHeapScope(Amx* amx, const std::size_t cells)
+            : AmxHeapScope(amx)
+        {
+            Reserve(cells);
+        }
+
+        AmxHeapScope(const AmxHeapScope&) = delete;
+        AmxHeapScope& operator=(const AmxHeapScope&) = delete;
+
+        ~AmxHeapScope()
+        {
+            // Anything allocated after the scope must have been released already.
+            assert(amx_->hea >= top_ && "plugin heap released below an active AmxHeapScope");
+            amx_->hea = saved_hea_;
+        }
+
+        /**
+         * @brief Grows the reserved region to at least \c cells free cells.
+         * Returns \c AmxError::Memory if the heap would run into the stack.
+        */
+        AmxError Reserve(const std::size_t cells)
+        {
+            const auto free_cells = static_cast<std::size_t>(top_ - NextAddress()) / sizeof(cell);
+
+            if (free_cells >= cells) {
+                return AmxError::None;
+            }
+
+            // Sized in std::size_t before narrowing, so a huge request cannot wrap into a small one.
+            const auto room = amx_->stk - top_ - AMX_STACK_MARGIN;
+            const auto grow_cells = cells - free_cells;
+
+            if (UNLIKELY(room < 0 || grow_cells > static_cast<std::size_t>(room) / sizeof(cell) || amx_->hea != top_)) {
+                return AmxError::Memory;
+            }
+
+            top_ += static_cast<cell>(grow_cells * sizeof(cell));
+            amx_->hea = top_;
+
+            return AmxError::None;
+        }
+
+        /**
+         * @brief Allocates \c cells uninitialized cells; returns an empty block on failure.
+        */
+        AmxHeapBlock Allocate(const std::size_t cells)
+        {
+            if (Reserve(cells) != AmxError::None) {
+                return {};
+            }
+
+            const auto address = NextAddress();
+            used_ += cells;
+
+            CheckWatermark();
+
+            return {address, amx::Address(amx_, address)};
+        }
+
+        /**
+         * @brief Copies \c count cells into the heap.
+        */
+        AmxHeapBlock AllocateArray(const cell* const data, const std::size_t count)
+        {
+            const auto block = Allocate(count);
+
+            if (block) {
+                std::memcpy(block.phys, data, count * sizeof(cell));
+            }
+
+            return block;
+        }
+
+        /**
+         * @brief Widens \c string into a zero-terminated plugin string.
+        */
+        AmxHeapBlock AllocateString(const std::string_view string)
+        {
+            const auto block = Allocate(string.size() + 1);
+
+            if (block) {
+                amx::simd::WidenChars(block.phys, string.data(), string.size());
+                block.phys[string.size()] = 0;
+            }
+
+            return block;
+        }
+
+        /**
+         * @brief Allocates a single cell initialized to \c value.
+        */
+        AmxHeapBlock AllocateCell(const cell value)
+        {
+            const auto block = Allocate(1);
+
+            if (block) {
+                *block.phys = value;
+            }
+
+            return block;
+        }
+
+        /**
+         * @brief Rolls back every allocation of the scope while keeping it usable.
+        */
+        void Reset()
+        {
+            amx_->hea = top_ = saved_hea_;
+            used_ = 0;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] Amx* GetAmx() const
+        {
+            return amx_;
+        }
+
+        /**
+         * @brief Number of cells handed out so far.
+        */
+        [[nodiscard]] std::size_t Used() const
+        {
+            return used_;
+        }
+
+    private:
+        [[nodiscard]] cell NextAddress() const
+        {
+            return saved_hea_ + static_cast<cell>(used_ * sizeof(cell));
+        }
+
+        void CheckWatermark() const
+        {
+            assert(amx_->hea >= saved_hea_ && "plugin heap below the AmxHeapScope watermark");
+            assert(amx_->stk - amx_->hea >= AMX_STACK_MARGIN && "plugin heap collides with the stack");
+        }
+
+        Amx* amx_;
+        cell saved_hea_;
+        cell top_;
+        std::size_t used_{};
+    };
+}
@@ -0,0 +1,176 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/cell_string.h>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace amxx
+{
+    /**
+     * @brief Hashed name lookup over the public and native tables of a loaded Amx image.
+     * Built once by parsing the \c AmxHeader tables; lookups are a hash and a short probe.
+    */
+    class AmxIndex
+    {
+    public:
+        explicit AmxIndex(const Amx* amx);
+
+        /**
+         * @brief Returns the index of the public \c name, or -1.
+        */
+        [[nodiscard]] int FindPublic(const std::string_view name) const
+        {
+            return publics_.Find(name);
+        }
+
+        /**
+         * @brief Returns the index of the native \c name, or -1.
+        */
+        [[nodiscard]] int FindNative(const std::string_view name) const
+        {
+            return natives_.Find(name);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int PublicCount() const
+        {
+            return static_cast<int>(publics_.names.size());
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int NativeCount() const
+        {
+            return static_cast<int>(natives_.names.size());
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] const char* PublicName(const int index) const
+        {
+            return publics_.names[index];
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] const char* NativeName(const int index) const
+        {
+            return natives_.names[index];
+        }
+
+        /**
+         * @brief Code address of the public \c index, relative to the code section.
+        */
+        [[nodiscard]] ucell PublicAddress(const int index) const
+        {
+            return public_addresses_[index];
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] const Amx* GetAmx() const
+        {
+            return amx_;
+        }
+
+    private:
+        struct Entry
+        {
+            std::uint32_t hash;
+            int index;
+        };
+
+        struct Table
+        {
+            std::vector<const char*> names{};
+            std::vector<Entry> entries{};
+            std::uint32_t mask{};
+
+            void Build();
+
+            [[nodiscard]] int Find(const std::string_view name) const
+            {
+                if (entries.empty()) {
+                    return -1;
+                }
+
+                const auto hash = static_cast<std::uint32_t>(amx::HashString(name));
+
+                for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+                    const auto& entry = entries[slot];
+
+                    if (entry.index < 0) {
+                        return -1;
+                    }
+
+                    if (entry.hash == hash && std::strncmp(names[entry.index], name.data(), name.size()) == 0 &&
+                        names[entry.index][name.size()] == '\0') {
+                        return entry.index;
+                    }
+                }
+            }
+        };
+
+        const Amx* amx_;
+        Table publics_{};
+        Table natives_{};
+        std::vector<ucell> public_addresses_{};
+    };
+
+    /**
+     * @brief Returns the index of \c amx, building it on first use and keeping it in a \c PluginLocal.
+    */
+    const AmxIndex& GetAmxIndex(Amx* amx);
+
+    /**
+     * @brief Drops the index of \c amx; the next \c GetAmxIndex call rebuilds it.
+    */
+    void ReleaseAmxIndex(Amx* amx);
+
+    /**
+     * @brief Drops every index; called before the plugins are unloaded.
+    */
+    void ReleaseAmxIndices();
+
+    /**
+     * @brief Index-backed replacement for \c AmxFindPublic.
+    */
+    inline int FindPublicIndex(Amx* amx, const std::string_view name)
+    {
+        return GetAmxIndex(amx).FindPublic(name);
+    }
+
+    /**
+     * @brief Index-backed replacement for \c AmxFindNative.
+    */
+    inline int FindNativeIndex(Amx* amx, const std::string_view name)
+    {
+        return GetAmxIndex(amx).FindNative(name);
+    }
+}
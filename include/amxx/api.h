@@ -20,9 +20,21 @@
 #include <amxx/amx.h>
 #include <amxx/config.h>
 #include <amxx/os_defs.h>
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <string>
 #include <type_traits>
 #include <utility>
 
+#ifdef AMXX_NATIVE_STATS
+#include <amxx/native_stats.h>
+#endif
+
+#ifdef AMXX_TRACE
+#include <amxx/trace.h>
+#endif
+
 #ifdef USE_METAMOD
 #include <cssdk/engine/edict.h>
 #else
@@ -414,9 +426,88 @@ namespace amxx
 #endif
     };
 
+    /**
+     * @brief Outcome of the API function lookup done by \c AMXX_Attach.
+    */
+    struct ApiResolveInfo
+    {
+        /**
+         * @brief Number of functions supplied by the core.
+        */
+        int resolved{};
+
+        /**
+         * @brief Number of optional functions the core does not have; their pointers stay null.
+        */
+        int missing_optional{};
+
+        /**
+         * @brief First required function the core does not have, or nullptr.
+        */
+        const char* missing_required{};
+
+        /**
+         * @brief Time spent resolving, in nanoseconds.
+        */
+        std::int64_t nanoseconds{};
+    };
+
     namespace detail
     {
         inline ApiFuncPointers api_funcs{};
+        inline ApiResolveInfo api_resolve_info{};
+
+        /**
+         * @brief Set by \c AMXX_Attach on the thread the core runs on.
+        */
+        inline bool game_thread_known{};
+        inline thread_local bool on_game_thread{};
+
+        /**
+         * @brief Teardown of a subsystem, run by \c AMXX_PluginsUnloading while the plugins are still loaded.
+        */
+        using UnloadHandler = void (*)();
+
+        /**
+         * @brief Runs \c handler on every \c AMXX_PluginsUnloading from now on; a subsystem registers its teardown
+         * when it is first used, so modules that never use it do not pay for it. Adding it again does nothing.
+        */
+        void AddUnloadHandler(UnloadHandler handler);
+
+        /**
+         * @brief The API pointers; debug builds assert that the core is only called from the game thread.
+        */
+        inline const ApiFuncPointers& Api()
+        {
+            assert(!game_thread_known || on_game_thread);
+            return api_funcs;
+        }
+    }
+
+    /**
+     * @brief True on the thread the core runs on (the one that attached the module).
+    */
+    inline bool IsGameThread()
+    {
+        return detail::on_game_thread;
+    }
+
+    /**
+     * @brief Outcome of resolving the AMXX functions in the last \c AMXX_Attach.
+    */
+    inline const ApiResolveInfo& GetApiResolveInfo()
+    {
+        return detail::api_resolve_info;
+    }
+
+    /**
+     * @brief True if the core supplied the function, e.g. \c IsApiFunctionAvailable(&ApiFuncPointers::get_config_manager).
+     * Only optional functions can be missing after a successful attach.
+    */
+    template <typename T>
+    bool IsApiFunctionAvailable(T ApiFuncPointers::*const function)
+    {
+        return detail::api_funcs.*function != nullptr;
     }
 
     /**
@@ -429,7 +520,11 @@ namespace amxx
     */
     inline int AddNatives(const AmxNativeInfo* list)
     {
-        return detail::api_funcs.add_natives(list);
+#ifdef AMXX_NATIVE_STATS
+        return detail::Api().add_natives(InstrumentNatives(list));
+#else
+        return detail::Api().add_natives(list);
+#endif
     }
 
     /**
@@ -437,7 +532,11 @@ namespace amxx
     */
     inline int AddNewNatives(const AmxNativeInfo* list)
     {
-        return detail::api_funcs.add_new_natives(list);
+#ifdef AMXX_NATIVE_STATS
+        return detail::Api().add_new_natives(InstrumentNatives(list));
+#else
+        return detail::Api().add_new_natives(list);
+#endif
     }
 
     /**
@@ -446,7 +545,7 @@ namespace amxx
     template <typename... TArgs>
     char* BuildPathName(const char* format, TArgs&&... args)
     {
-        return detail::api_funcs.build_path_name(format, std::forward<TArgs>(args)...);
+        return detail::Api().build_path_name(format, std::forward<TArgs>(args)...);
     }
 
     /**
@@ -455,7 +554,7 @@ namespace amxx
     template <typename... TArgs>
     char* BuildPathNameR(char* buffer, const std::size_t max_len, const char* format, TArgs&&... args)
     {
-        return detail::api_funcs.build_path_name_r(buffer, max_len, format, std::forward<TArgs>(args)...);
+        return detail::Api().build_path_name_r(buffer, max_len, format, std::forward<TArgs>(args)...);
     }
 
     /**
@@ -463,7 +562,7 @@ namespace amxx
     */
     // inline cell* GetAmxAddress(Amx* amx, const cell offset)
     //{
-    //	return detail::api_funcs.get_amx_address(amx, offset);
+    //	return detail::Api().get_amx_address(amx, offset);
     //}
 
     /**
@@ -472,7 +571,7 @@ namespace amxx
     template <typename... TArgs>
     void PrintConsole(const char* format, TArgs&&... args)
     {
-        detail::api_funcs.print_console(format, std::forward<TArgs>(args)...);
+        detail::Api().print_console(format, std::forward<TArgs>(args)...);
     }
 
     /**
@@ -480,7 +579,7 @@ namespace amxx
     */
     inline const char* GetModName()
     {
-        return detail::api_funcs.get_mod_name();
+        return detail::Api().get_mod_name();
     }
 
     /**
@@ -489,8 +588,8 @@ namespace amxx
     inline const char* GetAmxScriptName(const int id, const bool filename = false)
     {
         return filename
-            ? FilenameFromPath(detail::api_funcs.get_amx_script_name(id))
-            : detail::api_funcs.get_amx_script_name(id);
+            ? FilenameFromPath(detail::Api().get_amx_script_name(id))
+            : detail::Api().get_amx_script_name(id);
     }
 
     /**
@@ -498,7 +597,7 @@ namespace amxx
     */
     inline Amx* GetAmxScript(const int id)
     {
-        return detail::api_funcs.get_amx_script(id);
+        return detail::Api().get_amx_script(id);
     }
 
     /**
@@ -506,7 +605,7 @@ namespace amxx
     */
     inline int FindAmxScriptByAmx(const Amx* amx)
     {
-        return detail::api_funcs.find_amx_script_by_amx(amx);
+        return detail::Api().find_amx_script_by_amx(amx);
     }
 
     /**
@@ -514,7 +613,7 @@ namespace amxx
     */
     inline int FindAmxScriptByName(const char* name)
     {
-        return detail::api_funcs.find_amx_script_by_name(name);
+        return detail::Api().find_amx_script_by_name(name);
     }
 
     /**
@@ -522,7 +621,7 @@ namespace amxx
     */
     inline int SetAmxString(Amx* amx, const cell amx_address, const char* source, const int max)
     {
-        return detail::api_funcs.set_amx_string(amx, amx_address, source, max);
+        return detail::Api().set_amx_string(amx, amx_address, source, max);
     }
 
     /**
@@ -530,7 +629,7 @@ namespace amxx
     */
     inline char* GetAmxString(Amx* amx, const cell amx_address, const int buffer_id, int* len)
     {
-        return detail::api_funcs.get_amx_string(amx, amx_address, buffer_id, len);
+        return detail::Api().get_amx_string(amx, amx_address, buffer_id, len);
     }
 
     /**
@@ -539,7 +638,7 @@ namespace amxx
     inline char* GetAmxString(Amx* amx, const cell amx_address, const int buffer_id = 0)
     {
         auto len = 0;
-        return detail::api_funcs.get_amx_string(amx, amx_address, buffer_id, &len);
+        return detail::Api().get_amx_string(amx, amx_address, buffer_id, &len);
     }
 
     /**
@@ -547,7 +646,7 @@ namespace amxx
     */
     inline int GetAmxStringLen(const cell* ptr)
     {
-        return detail::api_funcs.get_amx_string_len(ptr);
+        return detail::Api().get_amx_string_len(ptr);
     }
 
     /**
@@ -555,7 +654,7 @@ namespace amxx
     */
     inline char* FormatAmxString(Amx* amx, cell* params, const int start_param, int* len)
     {
-        return detail::api_funcs.format_amx_string(amx, params, start_param, len);
+        return detail::Api().format_amx_string(amx, params, start_param, len);
     }
 
     /**
@@ -563,7 +662,7 @@ namespace amxx
     */
     inline void CopyAmxMemory(cell* dest, const cell* src, const int len)
     {
-        detail::api_funcs.copy_amx_memory(dest, src, len);
+        detail::Api().copy_amx_memory(dest, src, len);
     }
 
     /**
@@ -572,7 +671,7 @@ namespace amxx
     template <typename... TArgs>
     void Log(const char* format, TArgs&&... args)
     {
-        detail::api_funcs.log(format, std::forward<TArgs>(args)...);
+        detail::Api().log(format, std::forward<TArgs>(args)...);
     }
 
     /**
@@ -581,7 +680,7 @@ namespace amxx
     template <typename... TArgs>
     void LogError(Amx* amx, const AmxError error, const char* format, TArgs&&... args)
     {
-        detail::api_funcs.log_error(amx, error, format, std::forward<TArgs>(args)...);
+        detail::Api().log_error(amx, error, format, std::forward<TArgs>(args)...);
     }
 
     /**
@@ -589,7 +688,7 @@ namespace amxx
     */
     inline int RaiseAmxError(Amx* amx, const AmxError error)
     {
-        return detail::api_funcs.raise_amx_error(amx, error);
+        return detail::Api().raise_amx_error(amx, error);
     }
 
     /**
@@ -598,7 +697,14 @@ namespace amxx
     template <typename... TArgs>
     int RegisterForward(const char* func_name, const ForwardExecType exec_type, TArgs&&... args)
     {
-        return detail::api_funcs.register_forward(func_name, exec_type, std::forward<TArgs>(args)...);
+#ifdef AMXX_TRACE
+        const auto id = detail::Api().register_forward(func_name, exec_type, std::forward<TArgs>(args)...);
+        SetTraceForwardName(id, func_name);
+
+        return id;
+#else
+        return detail::Api().register_forward(func_name, exec_type, std::forward<TArgs>(args)...);
+#endif
     }
 
     /**
@@ -607,7 +713,11 @@ namespace amxx
     template <typename... TArgs>
     int ExecuteForward(const int id, TArgs&&... args)
     {
-        return detail::api_funcs.execute_forward(id, std::forward<TArgs>(args)...);
+#ifdef AMXX_TRACE
+        const TraceScope trace_scope{TraceForwardName(id), "forward"};
+#endif
+
+        return detail::Api().execute_forward(id, std::forward<TArgs>(args)...);
     }
 
     /**
@@ -615,7 +725,7 @@ namespace amxx
     */
     inline cell PrepareCellArray(cell* ptr, const std::size_t size)
     {
-        return detail::api_funcs.prepare_cell_array(ptr, size);
+        return detail::Api().prepare_cell_array(ptr, size);
     }
 
     /**
@@ -623,7 +733,7 @@ namespace amxx
     */
     inline cell PrepareCharArray(char* ptr, const std::size_t size)
     {
-        return detail::api_funcs.prepare_char_array(ptr, size);
+        return detail::Api().prepare_char_array(ptr, size);
     }
 
     /**
@@ -631,7 +741,7 @@ namespace amxx
     */
     inline cell PrepareCellArrayA(cell* ptr, const std::size_t size, const bool copy_back)
     {
-        return detail::api_funcs.prepare_cell_array_a(ptr, size, copy_back);
+        return detail::Api().prepare_cell_array_a(ptr, size, copy_back);
     }
 
     /**
@@ -639,7 +749,7 @@ namespace amxx
     */
     inline cell PrepareCharArrayA(char* ptr, const std::size_t size, const bool copy_back)
     {
-        return detail::api_funcs.prepare_char_array_a(ptr, size, copy_back);
+        return detail::Api().prepare_char_array_a(ptr, size, copy_back);
     }
 
     /**
@@ -647,7 +757,7 @@ namespace amxx
     */
     inline int IsPlayerValid(const int id)
     {
-        return detail::api_funcs.is_player_valid(id);
+        return detail::Api().is_player_valid(id);
     }
 
     /**
@@ -655,7 +765,7 @@ namespace amxx
     */
     inline const char* GetPlayerName(const int id)
     {
-        return detail::api_funcs.get_player_name(id);
+        return detail::Api().get_player_name(id);
     }
 
     /**
@@ -663,7 +773,7 @@ namespace amxx
     */
     inline const char* GetPlayerIp(const int id)
     {
-        return detail::api_funcs.get_player_ip(id);
+        return detail::Api().get_player_ip(id);
     }
 
     /**
@@ -671,7 +781,7 @@ namespace amxx
     */
     inline int IsPlayerInGame(const int id)
     {
-        return detail::api_funcs.is_player_in_game(id);
+        return detail::Api().is_player_in_game(id);
     }
 
     /**
@@ -679,7 +789,7 @@ namespace amxx
     */
     inline int IsPlayerBot(const int id)
     {
-        return detail::api_funcs.is_player_bot(id);
+        return detail::Api().is_player_bot(id);
     }
 
     /**
@@ -687,7 +797,7 @@ namespace amxx
     */
     inline int IsPlayerAuthorized(const int id)
     {
-        return detail::api_funcs.is_player_authorized(id);
+        return detail::Api().is_player_authorized(id);
     }
 
     /**
@@ -695,7 +805,7 @@ namespace amxx
     */
     inline float GetPlayerTime(const int id)
     {
-        return detail::api_funcs.get_player_time(id);
+        return detail::Api().get_player_time(id);
     }
 
     /**
@@ -703,7 +813,7 @@ namespace amxx
     */
     inline float GetPlayerPlayTime(const int id)
     {
-        return detail::api_funcs.get_player_play_time(id);
+        return detail::Api().get_player_play_time(id);
     }
 
     /**
@@ -711,7 +821,7 @@ namespace amxx
     */
     inline int GetPlayerFlags(const int id)
     {
-        return detail::api_funcs.get_player_flags(id);
+        return detail::Api().get_player_flags(id);
     }
 
     /**
@@ -719,7 +829,7 @@ namespace amxx
     */
     inline int GetPlayerCurWeapon(const int id)
     {
-        return detail::api_funcs.get_player_cur_weapon(id);
+        return detail::Api().get_player_cur_weapon(id);
     }
 
     /**
@@ -727,7 +837,7 @@ namespace amxx
     */
     inline const char* GetPlayerTeam(const int id)
     {
-        return detail::api_funcs.get_player_team(id);
+        return detail::Api().get_player_team(id);
     }
 
     /**
@@ -735,7 +845,7 @@ namespace amxx
     */
     inline int GetPlayerTeamId(const int id)
     {
-        return detail::api_funcs.get_player_team_id(id);
+        return detail::Api().get_player_team_id(id);
     }
 
     /**
@@ -743,7 +853,7 @@ namespace amxx
     */
     inline int GetPlayerDeaths(const int id)
     {
-        return detail::api_funcs.get_player_deaths(id);
+        return detail::Api().get_player_deaths(id);
     }
 
     /**
@@ -751,7 +861,7 @@ namespace amxx
     */
     inline int GetPlayerMenu(const int id)
     {
-        return detail::api_funcs.get_player_menu(id);
+        return detail::Api().get_player_menu(id);
     }
 
     /**
@@ -759,7 +869,7 @@ namespace amxx
     */
     inline int GetPlayerKeys(const int id)
     {
-        return detail::api_funcs.get_player_keys(id);
+        return detail::Api().get_player_keys(id);
     }
 
     /**
@@ -767,7 +877,7 @@ namespace amxx
     */
     inline int IsPlayerAlive(const int id)
     {
-        return detail::api_funcs.is_player_alive(id);
+        return detail::Api().is_player_alive(id);
     }
 
     /**
@@ -775,7 +885,7 @@ namespace amxx
     */
     inline int GetPlayerFrags(const int id)
     {
-        return detail::api_funcs.get_player_frags(id);
+        return detail::Api().get_player_frags(id);
     }
 
     /**
@@ -783,7 +893,7 @@ namespace amxx
     */
     inline int IsPlayerConnected(const int id)
     {
-        return detail::api_funcs.is_player_connected(id);
+        return detail::Api().is_player_connected(id);
     }
 
     /**
@@ -791,7 +901,7 @@ namespace amxx
     */
     inline int IsPlayerHltv(const int id)
     {
-        return detail::api_funcs.is_player_hltv(id);
+        return detail::Api().is_player_hltv(id);
     }
 
     /**
@@ -799,7 +909,7 @@ namespace amxx
     */
     inline int GetPlayerArmor(const int id)
     {
-        return detail::api_funcs.get_player_armor(id);
+        return detail::Api().get_player_armor(id);
     }
 
     /**
@@ -807,7 +917,7 @@ namespace amxx
     */
     inline int GetPlayerHealth(const int id)
     {
-        return detail::api_funcs.get_player_health(id);
+        return detail::Api().get_player_health(id);
     }
 
     /**
@@ -815,7 +925,7 @@ namespace amxx
     */
     inline cssdk::Edict* GetPlayerEdict(const int id)
     {
-        return detail::api_funcs.get_player_edict(id);
+        return detail::Api().get_player_edict(id);
     }
 
     /**
@@ -823,7 +933,7 @@ namespace amxx
     */
     inline void* PlayerPropAddress(const int id, const PlayerProp prop)
     {
-        return detail::api_funcs.player_prop_address(id, prop);
+        return detail::Api().player_prop_address(id, prop);
     }
 
     /**
@@ -831,15 +941,24 @@ namespace amxx
     */
     inline int AmxExec(Amx* amx, cell* return_val, const int index)
     {
-        return detail::api_funcs.amx_exec(amx, return_val, index);
+#ifdef AMXX_TRACE
+        const TraceScope trace_scope{TracePublicName(amx, index), "plugin"};
+#endif
+
+        return detail::Api().amx_exec(amx, return_val, index);
     }
 
     /**
-     * @brief N/D
+     * @brief The core registers \c amx_Execv as \c amx_Exec, so \c num_params and \c params are ignored:
+     * push the arguments with \c AmxPush, last one first, before calling it.
     */
     inline int AmxExecV(Amx* amx, cell* return_val, const int index, const int num_params, cell params[])
     {
-        return detail::api_funcs.amx_exec_v(amx, return_val, index, num_params, params);
+#ifdef AMXX_TRACE
+        const TraceScope trace_scope{TracePublicName(amx, index), "plugin"};
+#endif
+
+        return detail::Api().amx_exec_v(amx, return_val, index, num_params, params);
     }
 
     /**
@@ -847,7 +966,7 @@ namespace amxx
     */
     inline int AmxAllot(Amx* amx, const int length, cell* amx_address, cell** phys_address)
     {
-        return detail::api_funcs.amx_allot(amx, length, amx_address, phys_address);
+        return detail::Api().amx_allot(amx, length, amx_address, phys_address);
     }
 
     /**
@@ -855,7 +974,7 @@ namespace amxx
     */
     inline int AmxFindPublic(Amx* amx, const char* func_name, int* index)
     {
-        return detail::api_funcs.amx_find_public(amx, func_name, index);
+        return detail::Api().amx_find_public(amx, func_name, index);
     }
 
     /**
@@ -863,7 +982,7 @@ namespace amxx
     */
     inline int AmxFindNative(Amx* amx, const char* func_name, int* index)
     {
-        return detail::api_funcs.amx_find_native(amx, func_name, index);
+        return detail::Api().amx_find_native(amx, func_name, index);
     }
 
     /**
@@ -871,7 +990,7 @@ namespace amxx
     */
     inline int LoadAmxScript(Amx* amx, void** code, const char* path, char error_info[64], const int debug)
     {
-        return detail::api_funcs.load_amx_script(amx, code, path, error_info, debug);
+        return detail::Api().load_amx_script(amx, code, path, error_info, debug);
     }
 
     /**
@@ -879,7 +998,7 @@ namespace amxx
     */
     inline int UnloadAmxScript(Amx* amx, void** code)
     {
-        return detail::api_funcs.unload_amx_script(amx, code);
+        return detail::Api().unload_amx_script(amx, code);
     }
 
     /**
@@ -887,7 +1006,7 @@ namespace amxx
     */
     // inline cell RealToCell(const real value)
     //{
-    //	return detail::api_funcs.real_to_cell(value);
+    //	return detail::Api().real_to_cell(value);
     //}
 
     /**
@@ -895,7 +1014,7 @@ namespace amxx
     */
     // inline real CellToReal(const cell value)
     //{
-    //	return detail::api_funcs.cell_to_real(value);
+    //	return detail::Api().cell_to_real(value);
     //}
 
     /**
@@ -904,7 +1023,14 @@ namespace amxx
     template <typename... TArgs>
     int RegisterSpForward(Amx* amx, const int func, TArgs&&... args)
     {
-        return detail::api_funcs.register_sp_forward(amx, func, std::forward<TArgs>(args)...);
+#ifdef AMXX_TRACE
+        const auto id = detail::Api().register_sp_forward(amx, func, std::forward<TArgs>(args)...);
+        SetTraceForwardName(id, TracePublicName(amx, func));
+
+        return id;
+#else
+        return detail::Api().register_sp_forward(amx, func, std::forward<TArgs>(args)...);
+#endif
     }
 
     /**
@@ -913,7 +1039,14 @@ namespace amxx
     template <typename... TArgs>
     int RegisterSpForwardByName(Amx* amx, const char* func_name, TArgs&&... args)
     {
-        return detail::api_funcs.register_sp_forward_by_name(amx, func_name, std::forward<TArgs>(args)...);
+#ifdef AMXX_TRACE
+        const auto id = detail::Api().register_sp_forward_by_name(amx, func_name, std::forward<TArgs>(args)...);
+        SetTraceForwardName(id, func_name);
+
+        return id;
+#else
+        return detail::Api().register_sp_forward_by_name(amx, func_name, std::forward<TArgs>(args)...);
+#endif
     }
 
     /**
@@ -921,7 +1054,7 @@ namespace amxx
     */
     inline void UnregisterSpForward(const int id)
     {
-        detail::api_funcs.unregister_sp_forward(id);
+        detail::Api().unregister_sp_forward(id);
     }
 
     /**
@@ -929,7 +1062,7 @@ namespace amxx
     */
     inline void MergeDefinitionFile(const char* file_name)
     {
-        detail::api_funcs.merge_definition_file(file_name);
+        detail::Api().merge_definition_file(file_name);
     }
 
     /**
@@ -938,7 +1071,7 @@ namespace amxx
     template <typename... TArgs>
     const char* Format(const char* format, TArgs&&... args)
     {
-        return detail::api_funcs.format(format, std::forward<TArgs>(args)...);
+        return detail::Api().format(format, std::forward<TArgs>(args)...);
     }
 
     /**
@@ -946,7 +1079,7 @@ namespace amxx
     */
     inline void RegisterFunction(void* pfn, const char* desc)
     {
-        detail::api_funcs.register_function(pfn, desc);
+        detail::Api().register_function(pfn, desc);
     }
 
     /**
@@ -954,7 +1087,7 @@ namespace amxx
     */
     inline int AmxPush(Amx* amx, const cell value)
     {
-        return detail::api_funcs.amx_push(amx, value);
+        return detail::Api().amx_push(amx, value);
     }
 
     /**
@@ -962,7 +1095,7 @@ namespace amxx
     */
     inline int SetPlayerTeamInfo(const int player, const int team_id, const char* name)
     {
-        return detail::api_funcs.set_player_team_info(player, team_id, name);
+        return detail::Api().set_player_team_info(player, team_id, name);
     }
 
     /**
@@ -970,7 +1103,7 @@ namespace amxx
     */
     inline void RegisterAuthFunc(const std::add_pointer_t<void(int, const char*)> authorize_func)
     {
-        detail::api_funcs.register_auth_func(authorize_func);
+        detail::Api().register_auth_func(authorize_func);
     }
 
     /**
@@ -978,7 +1111,7 @@ namespace amxx
     */
     inline void UnregisterAuthFunc(const std::add_pointer_t<void(int, const char*)> authorize_func)
     {
-        detail::api_funcs.unregister_auth_func(authorize_func);
+        detail::Api().unregister_auth_func(authorize_func);
     }
 
     /**
@@ -986,7 +1119,7 @@ namespace amxx
     */
     inline int FindLibrary(const char* name, const LibType type)
     {
-        return detail::api_funcs.find_library(name, type);
+        return detail::Api().find_library(name, type);
     }
 
     /**
@@ -994,7 +1127,7 @@ namespace amxx
     */
     inline std::size_t AddLibraries(const char* name, const LibType type, void* parent)
     {
-        return detail::api_funcs.add_libraries(name, type, parent);
+        return detail::Api().add_libraries(name, type, parent);
     }
 
     /**
@@ -1002,7 +1135,7 @@ namespace amxx
     */
     inline std::size_t RemoveLibraries(void* parent)
     {
-        return detail::api_funcs.remove_libraries(parent);
+        return detail::Api().remove_libraries(parent);
     }
 
     /**
@@ -1010,7 +1143,7 @@ namespace amxx
     */
     inline void OverrideNatives(AmxNativeInfo* natives, const char* my_name)
     {
-        detail::api_funcs.override_natives(natives, my_name);
+        detail::Api().override_natives(natives, my_name);
     }
 
     /**
@@ -1018,7 +1151,7 @@ namespace amxx
     */
     inline const char* GetLocalInfo(const char* name, const char* def)
     {
-        return detail::api_funcs.get_local_info(name, def);
+        return detail::Api().get_local_info(name, def);
     }
 
     /**
@@ -1026,7 +1159,7 @@ namespace amxx
     */
     inline int AmxReRegister(Amx* amx, AmxNativeInfo* list, const int number)
     {
-        return detail::api_funcs.amx_re_register(amx, list, number);
+        return detail::Api().amx_re_register(amx, list, number);
     }
 
     /**
@@ -1034,7 +1167,7 @@ namespace amxx
     */
     inline void* RegisterFunctionEx(void* pfn, const char* desc)
     {
-        return detail::api_funcs.register_function_ex(pfn, desc);
+        return detail::Api().register_function_ex(pfn, desc);
     }
 
     /**
@@ -1042,7 +1175,7 @@ namespace amxx
     */
     inline void MessageBlock(const int mode, const int message, int* opt)
     {
-        detail::api_funcs.message_block(mode, message, opt);
+        detail::Api().message_block(mode, message, opt);
     }
 
     /**
@@ -1065,7 +1198,12 @@ namespace amxx
     */
     inline char* GetAmxStringNull(Amx* amx, const cell amx_address, const int buffer_id, int* len)
     {
-        return detail::api_funcs.get_amx_string_null(amx, amx_address, buffer_id, len);
+        // AMXX 1.8.2 has no null string check.
+        if (UNLIKELY(!detail::api_funcs.get_amx_string_null)) {
+            return detail::Api().get_amx_string(amx, amx_address, buffer_id, len);
+        }
+
+        return detail::Api().get_amx_string_null(amx, amx_address, buffer_id, len);
     }
 
     /**
@@ -1073,15 +1211,19 @@ namespace amxx
     */
     inline cell* GetAmxVectorNull(Amx* amx, const cell offset)
     {
-        return detail::api_funcs.get_amx_vector_null(amx, offset);
+        if (UNLIKELY(!detail::api_funcs.get_amx_vector_null)) {
+            return amx::Address(amx, offset);
+        }
+
+        return detail::Api().get_amx_vector_null(amx, offset);
     }
 
     /**
-     * @brief N/D
+     * @brief Returns nullptr if the core has no game config manager.
     */
     inline GameConfigManager* GetConfigManager()
     {
-        return detail::api_funcs.get_config_manager();
+        return detail::api_funcs.get_config_manager ? detail::Api().get_config_manager() : nullptr;
     }
 
     /**
@@ -1090,7 +1232,18 @@ namespace amxx
     inline int LoadAmxScriptEx(Amx* amx, void** code, const char* path, char* error_info, const std::size_t max_length,
                                const int debug)
     {
-        return detail::api_funcs.load_amx_script_ex(amx, code, path, error_info, max_length, debug);
+        if (UNLIKELY(!detail::api_funcs.load_amx_script_ex)) {
+            char error[64]{};
+            const auto result = detail::Api().load_amx_script(amx, code, path, error, debug);
+
+            if (error_info && max_length) {
+                std::snprintf(error_info, max_length, "%s", error);
+            }
+
+            return result;
+        }
+
+        return detail::Api().load_amx_script_ex(amx, code, path, error_info, max_length, debug);
     }
 
     /**
@@ -1099,7 +1252,12 @@ namespace amxx
     inline int SetAmxStringUtf8Cell(Amx* amx, const cell amx_address, const cell* source, const std::size_t source_len,
                                     const std::size_t max_len)
     {
-        return detail::api_funcs.set_amx_string_utf8_cell(amx, amx_address, source, source_len, max_len);
+        if (UNLIKELY(!detail::api_funcs.set_amx_string_utf8_cell)) {
+            const std::string text(source, source + source_len);
+            return static_cast<int>(amx::SetStringUtf8(amx, amx_address, text.data(), text.size(), max_len));
+        }
+
+        return detail::Api().set_amx_string_utf8_cell(amx, amx_address, source, source_len, max_len);
     }
 
     /**
@@ -1108,7 +1266,8 @@ namespace amxx
     inline int SetAmxStringUtf8Char(Amx* amx, const cell amx_address, const char* source, const std::size_t source_len,
                                     const std::size_t max_len)
     {
-        return detail::api_funcs.set_amx_string_utf8_char(amx, amx_address, source, source_len, max_len);
+        // Zero-extends and stops at an embedded zero like the core, without the cross-module call.
+        return static_cast<int>(amx::SetStringUtf8(amx, amx_address, source, source_len, max_len));
     }
 #endif
 }
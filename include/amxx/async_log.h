@@ -0,0 +1,161 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/api.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+
+//
+// Asynchronous logging in front of Log.
+// Messages are formatted by the calling thread straight into a slot of a lock-free ring and written to the
+// module's own log file by a background thread, so a log storm never waits on disk I/O. Each call site (or, for
+// AsyncLogError, each plugin) is rate limited, identical consecutive messages are written once with a repeat
+// count, and a full ring drops messages instead of blocking. While the logger is not running the calls go
+// straight to Log.
+// Built only when the library is configured with AMXX_ASYNC_LOG ON; the logger is stopped on AMXX_Detach.
+//
+
+namespace amxx
+{
+    /**
+     * @brief Longest message kept; longer ones are truncated.
+    */
+    constexpr std::size_t ASYNC_LOG_MESSAGE_SIZE = 512;
+
+    /**
+     * @brief Settings of \c StartAsyncLog.
+    */
+    struct AsyncLogOptions
+    {
+        /**
+         * @brief Messages per second accepted from one call site or plugin; the rest are counted and dropped.
+        */
+        std::uint32_t messages_per_second = 20;
+
+        /**
+         * @brief Slots in the ring; rounded up to a power of two.
+        */
+        std::size_t queue_size = 1024;
+
+        /**
+         * @brief How often repeat counts and drop notices are written and the file is flushed.
+        */
+        std::uint32_t flush_interval_ms = 1000;
+    };
+
+    namespace detail
+    {
+        struct AsyncLogRecord
+        {
+            std::atomic<std::size_t> sequence;
+            std::size_t position;
+            const void* source;
+            std::int64_t time;
+            bool error;
+            char plugin[64];
+            char text[ASYNC_LOG_MESSAGE_SIZE];
+        };
+
+        /**
+         * @brief Claims a slot for a message from \c source; nullptr if it is rate limited or the ring is full.
+        */
+        AsyncLogRecord* AcquireLogRecord(const void* source, bool error);
+
+        /**
+         * @brief Hands a filled slot over to the writer thread.
+        */
+        void PublishLogRecord(AsyncLogRecord* record);
+
+        inline std::atomic<bool> async_log_running{};
+    }
+
+    /**
+     * @brief Opens \c path for appending and starts the writer thread.
+     * Build the path on the game thread, e.g. from \c BuildPathName and the "amxx_logs" local info.
+    */
+    bool StartAsyncLog(const char* path, const AsyncLogOptions& options = {});
+
+    /**
+     * @brief Stops the writer thread, writes what is still queued on the calling thread and closes the file.
+     * Called from \c AMXX_Detach; no other thread may log while it runs.
+    */
+    void StopAsyncLog();
+
+    /**
+     * @brief True while the writer thread runs; messages are written synchronously otherwise.
+    */
+    inline bool AsyncLogRunning()
+    {
+        return detail::async_log_running.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Messages lost to the rate limits or to a full ring since the logger was started.
+    */
+    std::uint64_t AsyncLogDropped();
+
+    /**
+     * @brief Logs a message through the async logger; rate limited per call site (per \c format).
+    */
+    template <typename... TArgs>
+    void AsyncLog(const char* format, TArgs&&... args)
+    {
+        if (!AsyncLogRunning()) {
+            Log(format, std::forward<TArgs>(args)...);
+            return;
+        }
+
+        if (auto* const record = detail::AcquireLogRecord(format, false)) {
+            std::snprintf(record->text, sizeof(record->text), format, std::forward<TArgs>(args)...);
+            detail::PublishLogRecord(record);
+        }
+    }
+
+    /**
+     * @brief Logs an error on behalf of \c amx; rate limited per plugin.
+     * Unlike \c LogError it only records the message: the plugin's error filter is not called.
+     * Call it from the game thread, as the plugin name is looked up here.
+    */
+    template <typename... TArgs>
+    void AsyncLogError(const Amx* amx, const char* format, TArgs&&... args)
+    {
+        const auto id = amx ? FindAmxScriptByAmx(amx) : -1;
+        const auto* const plugin = id >= 0 ? GetAmxScriptName(id, true) : nullptr;
+
+        if (!AsyncLogRunning()) {
+            char text[ASYNC_LOG_MESSAGE_SIZE];
+
+            std::snprintf(text, sizeof(text), format, std::forward<TArgs>(args)...);
+            Log("[%s] %s", plugin ? plugin : "?", text);
+
+            return;
+        }
+
+        if (auto* const record = detail::AcquireLogRecord(amx, true)) {
+            std::snprintf(record->plugin, sizeof(record->plugin), "%s", plugin ? plugin : "?");
+
+            std::snprintf(record->text, sizeof(record->text), format, std::forward<TArgs>(args)...);
+            detail::PublishLogRecord(record);
+        }
+    }
+}
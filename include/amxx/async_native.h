@@ -0,0 +1,138 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/task_pool.h>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+//
+// Natives that put the calling plugin to sleep while their work runs on the task pool.
+// The native hands its work to SuspendAmx and returns; the plugin stops with AmxError::Sleep, which
+// AmxExecSuspendable returns in place of the return value of the public, with the registers and stack of the
+// plugin left in place. Once the work is done, RunTaskCompletions resumes the plugin with AMX_EXEC_CONT on a later frame and
+// the native call evaluates to the result, so the plugin reads as straight-line code.
+// A script has at most one suspended call. Other publics of a suspended script may still run as long as they
+// do not suspend as well; a native that cannot suspend runs its work right away instead.
+// Only publics the module runs itself with AmxExecSuspendable can be suspended, and only while no other public
+// of the script is running and nothing is on its heap: the core logs AmxError::Sleep from the publics it runs
+// (forwards, tasks, natives of other modules) as an error and releases their array and string arguments, which
+// the resumed public would then read. Anywhere else a suspending native finishes its work right away.
+// Built only when the library is configured with AMXX_ASYNC_NATIVES ON (which needs AMXX_TASK_POOL).
+//
+
+namespace amxx
+{
+    /**
+     * @brief Receives the outcome of a resumed call: the error of \c AMX_EXEC_CONT and the return value of the
+     * public that was suspended.
+    */
+    using AmxResumeHandler = void (*)(Amx* amx, AmxError error, cell return_val);
+
+    namespace detail
+    {
+        /**
+         * @brief Records the state of the native being called and raises \c AmxError::Sleep.
+         * Returns a ticket for \c ResumeAmx, or 0 if \c amx cannot be suspended now.
+        */
+        std::uint64_t SuspendAmx(Amx* amx);
+
+        /**
+         * @brief True while the suspension \c ticket of \c amx has been neither resumed nor cancelled.
+        */
+        bool AmxSuspended(const Amx* amx, std::uint64_t ticket);
+
+        /**
+         * @brief Resumes the suspension \c ticket of \c amx; the native call evaluates to \c result.
+        */
+        void ResumeAmx(Amx* amx, std::uint64_t ticket, cell result);
+    }
+
+    /**
+     * @brief Called from a native: runs \c work on the task pool and suspends the plugin until it is done.
+     * \c finish then runs on the game thread with the result of \c work, may write into the memory of the plugin,
+     * and returns the value of the native call. Returns what the native should return.
+     *
+     * @code
+     * cell AMX_NATIVE_CALL ReadFile(Amx* amx, cell* params)
+     * {
+     *     return SuspendAmx(amx, [path = std::string{GetAmxString(amx, params[1], 0)}] { return Read(path); },
+     *                       [buffer = params[2], max = params[3]](Amx* amx, const std::string& text) {
+     *                           return SetAmxString(amx, buffer, text.c_str(), max);
+     *                       });
+     * }
+     * @endcode
+    */
+    template <typename TWork, typename TFinish>
+    cell SuspendAmx(Amx* amx, TWork&& work, TFinish&& finish)
+    {
+        using Result = std::invoke_result_t<TWork&>;
+        static_assert(!std::is_void_v<Result>, "The work of a suspended native must return its result.");
+
+        const auto ticket = detail::SuspendAmx(amx);
+
+        if (!ticket) {
+            return static_cast<cell>(finish(amx, work()));
+        }
+
+        SubmitTask(std::forward<TWork>(work), [amx, ticket, finish = std::forward<TFinish>(finish)](Result result) mutable {
+            // The plugin may have been unloaded in the meantime.
+            if (detail::AmxSuspended(amx, ticket)) {
+                detail::ResumeAmx(amx, ticket, static_cast<cell>(finish(amx, std::move(result))));
+            }
+        });
+
+        return 0;
+    }
+
+    /**
+     * @brief Called from a native: suspends the plugin until \c work, run on the task pool, returns the value of
+     * the native call.
+    */
+    template <typename TWork>
+    cell SuspendAmx(Amx* amx, TWork&& work)
+    {
+        return SuspendAmx(amx, std::forward<TWork>(work), [](Amx*, const cell result) { return result; });
+    }
+
+    /**
+     * @brief Runs the public \c index of \c amx with the arguments pushed so far, as \c AmxExec does, and lets the
+     * natives it calls suspend it. The public can be suspended only if no other public of \c amx is running and
+     * its heap is empty, so it cannot take arrays or strings; otherwise it runs as with \c AmxExec.
+     * Returns \c AmxError::Sleep if the public was suspended: the resume handler gets its outcome later.
+    */
+    AmxError AmxExecSuspendable(Amx* amx, cell* return_val, int index);
+
+    /**
+     * @brief True while \c amx has a suspended call that has been neither resumed nor cancelled.
+    */
+    bool IsAmxSuspended(const Amx* amx);
+
+    /**
+     * @brief Sets the handler of resumed calls; without one, errors of resumed calls are logged with \c LogError.
+    */
+    void SetAmxResumeHandler(AmxResumeHandler handler);
+
+    /**
+     * @brief Forgets every suspended call; their work still finishes, but nothing is resumed.
+     * Called before the plugins are unloaded.
+    */
+    void CancelSuspendedCalls();
+}
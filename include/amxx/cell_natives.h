@@ -0,0 +1,43 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+
+//
+// Natives that run the amx::simd cell kernels on plugin arrays, in place of Pawn loops over them.
+// Register them with AddNatives(CellArrayNatives()) in AMXX_Attach and declare them in the include of the module:
+//
+//     native cell_copy(dest[], const source[], count);
+//     native cell_fill(array[], value, count);
+//     native cell_compare(const first[], const second[], count);
+//     native cell_find(const array[], value, count);
+//     native cell_count(const array[], value, count);
+//
+// cell_copy and cell_fill return count. cell_compare returns the index of the first cell that differs and
+// cell_find the index of the first match, both -1 if there is none; cell_count returns the number of matches.
+// Arrays that do not fit in the plugin memory raise AmxError::Bounds and the native returns 0.
+//
+
+namespace amxx
+{
+    /**
+     * @brief Zero-terminated table of the cell array natives.
+    */
+    const AmxNativeInfo* CellArrayNatives();
+}
@@ -0,0 +1,309 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+//
+// Views over plugin arrays, made straight from the params of a native; nothing is copied.
+// Pawn passes no array sizes, so the native takes them as separate parameters. Debug builds assert that the
+// views stay inside the plugin memory and that indices stay inside the views; release builds check nothing.
+//
+
+namespace amx
+{
+    namespace detail
+    {
+        /**
+         * @brief Returns true if \c cells cells at \c address lie in the data, heap and stack of \c amx.
+        */
+        inline bool InPluginMemory(const Amx* const amx, const cell address, const std::size_t cells)
+        {
+            const auto begin = static_cast<std::size_t>(static_cast<ucell>(address));
+            const auto end = static_cast<std::size_t>(static_cast<ucell>(amx->stp));
+
+            return address >= 0 && begin <= end && cells <= (end - begin) / sizeof(cell);
+        }
+    }
+
+    /**
+     * @brief View of \c size elements of a plugin array; \c T is \c cell or \c real, optionally const.
+    */
+    template <typename T>
+    class Span
+    {
+        static_assert(std::is_same_v<std::remove_const_t<T>, cell> || std::is_same_v<std::remove_const_t<T>, real>,
+                      "A plugin array holds cells or floats.");
+
+    public:
+        constexpr Span() = default;
+
+        constexpr Span(T* const data, const std::size_t size)
+            : data_(data), size_(size)
+        {
+        }
+
+        /**
+         * @brief Read-only view of a mutable one.
+        */
+        template <typename U, typename = std::enable_if_t<!std::is_same_v<U, T> && std::is_same_v<const U, T>>>
+        // ReSharper disable once CppNonExplicitConvertingConstructor
+        constexpr Span(const Span<U>& other) // NOLINT(google-explicit-constructor)
+            : data_(other.data()), size_(other.size())
+        {
+        }
+
+        /**
+         * @brief View of the array at the plugin address \c address, e.g. \c Span{amx, params[1], params[2]}.
+         * A negative size gives an empty view.
+        */
+        Span(const Amx* const amx, const cell address, const cell size)
+            : data_(reinterpret_cast<T*>(Address(amx, address))), size_(size > 0 ? static_cast<std::size_t>(size) : 0)
+        {
+            assert(detail::InPluginMemory(amx, address, size_) && "array outside of the plugin memory");
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr T* data() const
+        {
+            return data_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr std::size_t size() const
+        {
+            return size_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr T* begin() const
+        {
+            return data_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr T* end() const
+        {
+            return data_ + size_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        T& operator[](const std::size_t index) const
+        {
+            assert(index < size_ && "array index out of bounds");
+            return data_[index];
+        }
+
+        /**
+         * @brief Elements \c start to \c start + \c count, clamped to the view.
+        */
+        [[nodiscard]] Span Subspan(const std::size_t start, const std::size_t count = static_cast<std::size_t>(-1)) const
+        {
+            if (start >= size_) {
+                return {data_ + size_, 0};
+            }
+
+            return {data_ + start, count < size_ - start ? count : size_ - start};
+        }
+
+    private:
+        T* data_{};
+        std::size_t size_{};
+    };
+
+    using CellSpan = Span<cell>;
+    using ConstCellSpan = Span<const cell>;
+    using FloatSpan = Span<real>;
+    using ConstFloatSpan = Span<const real>;
+
+    /**
+     * @brief View of a two-dimensional plugin array, \c new array[rows][columns].
+     * The array starts with an indirection table of one cell per row, holding the byte offset from that cell to
+     * the row. Rows are read through the table, so arrays whose rows are not contiguous work too.
+    */
+    template <typename T>
+    class Array2D
+    {
+    public:
+        class Iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Span<T>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = Span<T>;
+
+            Iterator(const Array2D* const array, const std::size_t row)
+                : array_(array), row_(row)
+            {
+            }
+
+            Span<T> operator*() const
+            {
+                return array_->Row(row_);
+            }
+
+            Iterator& operator++()
+            {
+                ++row_;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                auto previous = *this;
+                ++row_;
+
+                return previous;
+            }
+
+            bool operator==(const Iterator& other) const
+            {
+                return row_ == other.row_;
+            }
+
+            bool operator!=(const Iterator& other) const
+            {
+                return row_ != other.row_;
+            }
+
+        private:
+            const Array2D* array_;
+            std::size_t row_;
+        };
+
+        Array2D() = default;
+
+        /**
+         * @brief View of the array at the plugin address \c address; negative sizes give an empty view.
+        */
+        Array2D(const Amx* const amx, const cell address, const cell rows, const cell columns)
+            : table_(Address(amx, address)), rows_(rows > 0 ? static_cast<std::size_t>(rows) : 0),
+              columns_(columns > 0 ? static_cast<std::size_t>(columns) : 0)
+#ifndef NDEBUG
+              ,
+              amx_(amx), address_(address)
+#endif
+        {
+            assert(detail::InPluginMemory(amx, address, rows_) && "array outside of the plugin memory");
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] std::size_t Rows() const
+        {
+            return rows_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] std::size_t Columns() const
+        {
+            return columns_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] bool Empty() const
+        {
+            return rows_ == 0;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] Span<T> Row(const std::size_t row) const
+        {
+            assert(row < rows_ && "array row out of bounds");
+
+            auto* const data = reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(table_ + row) + table_[row]);
+
+#ifndef NDEBUG
+            const auto row_address = address_ + static_cast<cell>(row * sizeof(cell)) + table_[row];
+            assert(detail::InPluginMemory(amx_, row_address, columns_) && "array row outside of the plugin memory");
+#endif
+
+            return {data, columns_};
+        }
+
+        /**
+         * @brief N/D
+        */
+        Span<T> operator[](const std::size_t row) const
+        {
+            return Row(row);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] Iterator begin() const
+        {
+            return {this, 0};
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] Iterator end() const
+        {
+            return {this, rows_};
+        }
+
+    private:
+        cell* table_{};
+        std::size_t rows_{};
+        std::size_t columns_{};
+
+#ifndef NDEBUG
+        const Amx* amx_{};
+        cell address_{};
+#endif
+    };
+
+    using CellArray2D = Array2D<cell>;
+    using ConstCellArray2D = Array2D<const cell>;
+    using FloatArray2D = Array2D<real>;
+    using ConstFloatArray2D = Array2D<const real>;
+}
@@ -0,0 +1,383 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace amx
+{
+    /**
+     * @brief FNV-1a hash of a narrow string; equal to \c CellStringView::Hash of the same text.
+    */
+    constexpr std::size_t HashString(const std::string_view string)
+    {
+        std::uint32_t hash = 2166136261U;
+
+        for (const auto ch : string) {
+            hash = (hash ^ static_cast<unsigned char>(ch)) * 16777619U;
+        }
+
+        return hash;
+    }
+
+    /**
+     * @brief Narrows a zero-terminated cell string into \c buffer, scanning no further than the buffer allows.
+     * The result is truncated to \c size - 1 characters and always zero-terminated.
+    */
+    inline std::string_view NarrowString(const cell* const address, char* const buffer, const std::size_t size)
+    {
+        if (!size) {
+            return {};
+        }
+
+        const auto length = simd::CellStringLength(address, size - 1);
+        simd::NarrowCells(buffer, address, length);
+        buffer[length] = '\0';
+
+        return {buffer, length};
+    }
+
+    /**
+     * @brief N/D
+    */
+    template <std::size_t N>
+    std::string_view NarrowString(const cell* const address, char (&buffer)[N])
+    {
+        return NarrowString(address, buffer, N);
+    }
+
+    /**
+     * @brief Non-owning view of a plugin string kept in its cell form.
+     * Comparisons and hashing work on the cells directly, without narrowing or allocating.
+    */
+    class CellStringView
+    {
+    public:
+        constexpr CellStringView() = default;
+
+        constexpr CellStringView(const cell* const address, const std::size_t length)
+            : data_(address), length_(length)
+        {
+        }
+
+        explicit CellStringView(const cell* const address)
+            : data_(address), length_(GetStringLen(address))
+        {
+        }
+
+        CellStringView(const Amx* const amx, const cell address)
+            : CellStringView(Address(amx, address))
+        {
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr const cell* data() const
+        {
+            return data_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr std::size_t size() const
+        {
+            return length_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr bool empty() const
+        {
+            return length_ == 0;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr const cell* begin() const
+        {
+            return data_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr const cell* end() const
+        {
+            return data_ + length_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        constexpr char operator[](const std::size_t index) const
+        {
+            return static_cast<char>(data_[index]);
+        }
+
+        /**
+         * @brief Lexicographical comparison with a narrow string, with the same sign convention as \c strcmp.
+        */
+        [[nodiscard]] int Compare(const std::string_view other) const
+        {
+            const auto count = length_ < other.size() ? length_ : other.size();
+
+            for (std::size_t i = 0; i < count; ++i) {
+                const auto lhs = static_cast<unsigned char>(data_[i]);
+                const auto rhs = static_cast<unsigned char>(other[i]);
+
+                if (lhs != rhs) {
+                    return lhs < rhs ? -1 : 1;
+                }
+            }
+
+            if (length_ == other.size()) {
+                return 0;
+            }
+
+            return length_ < other.size() ? -1 : 1;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] bool Equals(const std::string_view other) const
+        {
+            if (length_ != other.size()) {
+                return false;
+            }
+
+            for (std::size_t i = 0; i < length_; ++i) {
+                if (static_cast<char>(data_[i]) != other[i]) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief ASCII case-insensitive equality.
+        */
+        [[nodiscard]] bool EqualsIgnoreCase(const std::string_view other) const
+        {
+            if (length_ != other.size()) {
+                return false;
+            }
+
+            for (std::size_t i = 0; i < length_; ++i) {
+                if (ToLower(static_cast<char>(data_[i])) != ToLower(other[i])) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] bool StartsWith(const std::string_view prefix) const
+        {
+            return length_ >= prefix.size() && CellStringView{data_, prefix.size()}.Equals(prefix);
+        }
+
+        /**
+         * @brief Returns the first index of \c ch, or \c std::string_view::npos.
+        */
+        [[nodiscard]] std::size_t Find(const char ch, const std::size_t start = 0) const
+        {
+            for (auto i = start; i < length_; ++i) {
+                if (static_cast<char>(data_[i]) == ch) {
+                    return i;
+                }
+            }
+
+            return std::string_view::npos;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] CellStringView Substr(const std::size_t start, const std::size_t count = std::string_view::npos) const
+        {
+            if (start >= length_) {
+                return {data_ + length_, 0};
+            }
+
+            return {data_ + start, count < length_ - start ? count : length_ - start};
+        }
+
+        /**
+         * @brief FNV-1a hash of the narrowed text; matches \c amx::HashString.
+        */
+        [[nodiscard]] std::size_t Hash() const
+        {
+            std::uint32_t hash = 2166136261U;
+
+            for (std::size_t i = 0; i < length_; ++i) {
+                hash = (hash ^ static_cast<unsigned char>(data_[i])) * 16777619U;
+            }
+
+            return hash;
+        }
+
+        /**
+         * @brief Narrows the string into \c buffer; see \c amx::NarrowString.
+        */
+        std::string_view Narrow(char* const buffer, const std::size_t size) const
+        {
+            if (!size) {
+                return {};
+            }
+
+            const auto length = length_ < size - 1 ? length_ : size - 1;
+            simd::NarrowCells(buffer, data_, length);
+            buffer[length] = '\0';
+
+            return {buffer, length};
+        }
+
+        /**
+         * @brief N/D
+        */
+        template <std::size_t N>
+        std::string_view Narrow(char (&buffer)[N]) const
+        {
+            return Narrow(buffer, N);
+        }
+
+        /**
+         * @brief Allocating conversion, for the cold paths that need ownership.
+        */
+        [[nodiscard]] std::string ToString() const
+        {
+            std::string string(length_, '\0');
+            simd::NarrowCells(string.data(), data_, length_);
+
+            return string;
+        }
+
+    private:
+        static constexpr char ToLower(const char ch)
+        {
+            return ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch;
+        }
+
+        const cell* data_{};
+        std::size_t length_{};
+    };
+
+    inline bool operator==(const CellStringView& lhs, const std::string_view rhs)
+    {
+        return lhs.Equals(rhs);
+    }
+
+    inline bool operator==(const std::string_view lhs, const CellStringView& rhs)
+    {
+        return rhs.Equals(lhs);
+    }
+
+    inline bool operator!=(const CellStringView& lhs, const std::string_view rhs)
+    {
+        return !lhs.Equals(rhs);
+    }
+
+    inline bool operator!=(const std::string_view lhs, const CellStringView& rhs)
+    {
+        return !rhs.Equals(lhs);
+    }
+
+    /**
+     * @brief Ring of narrowed strings for short-lived conversions.
+     * A view stays valid until the arena wraps around or is reset.
+    */
+    template <std::size_t Capacity>
+    class StringArena
+    {
+    public:
+        /**
+         * @brief Narrows \c address into the arena; strings longer than the capacity are truncated.
+        */
+        std::string_view Narrow(const cell* const address)
+        {
+            return Narrow(CellStringView{address});
+        }
+
+        /**
+         * @brief N/D
+        */
+        std::string_view Narrow(const CellStringView string)
+        {
+            const auto required = string.size() + 1;
+
+            if (required > Capacity - offset_) {
+                offset_ = 0;
+            }
+
+            const auto view = string.Narrow(buffer_ + offset_, Capacity - offset_);
+            offset_ += view.size() + 1;
+
+            return view;
+        }
+
+        /**
+         * @brief Invalidates every view handed out so far.
+        */
+        void Reset()
+        {
+            offset_ = 0;
+        }
+
+    private:
+        std::size_t offset_{};
+        char buffer_[Capacity]{};
+    };
+
+    /**
+     * @brief Per-thread scratch arena used by \c amx::ScratchString.
+    */
+    inline StringArena<65536>& ScratchArena()
+    {
+        static thread_local StringArena<65536> arena{};
+        return arena;
+    }
+
+    /**
+     * @brief Narrows a plugin string into the per-thread scratch arena without allocating.
+    */
+    inline std::string_view ScratchString(const cell* const address)
+    {
+        return ScratchArena().Narrow(address);
+    }
+
+    /**
+     * @brief N/D
+    */
+    inline std::string_view ScratchString(const Amx* const amx, const cell address)
+    {
+        return ScratchString(Address(amx, address));
+    }
+}
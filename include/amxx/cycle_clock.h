@@ -0,0 +1,107 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define AMXX_HAS_TSC
+#endif
+
+namespace amxx
+{
+    /**
+     * @brief Cheap monotonic tick counter for instrumentation: the TSC on x86, the steady clock elsewhere.
+     * Ticks are converted to nanoseconds with a ratio measured against the steady clock since the first \c Now.
+    */
+    class CycleClock
+    {
+    public:
+        /**
+         * @brief N/D
+        */
+        static std::uint64_t Now()
+        {
+#ifdef AMXX_HAS_TSC
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+                    .count());
+#endif
+        }
+
+        /**
+         * @brief Starts the calibration window; called by the instrumentation when it is set up.
+        */
+        static void Calibrate()
+        {
+            GetReference();
+        }
+
+        /**
+         * @brief Nanoseconds per tick, measured over the time since \c Calibrate was first called.
+        */
+        static double NanosecondsPerTick()
+        {
+#ifdef AMXX_HAS_TSC
+            const auto& reference = GetReference();
+            const auto ticks = Now() - reference.ticks;
+            const auto elapsed = std::chrono::steady_clock::now() - reference.time;
+
+            // Too short a window to measure; assume a 3 GHz clock.
+            if (ticks < 1000000) {
+                return 1.0 / 3.0;
+            }
+
+            return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+                static_cast<double>(ticks);
+#else
+            return 1.0;
+#endif
+        }
+
+        /**
+         * @brief N/D
+        */
+        static double ToNanoseconds(const std::uint64_t ticks)
+        {
+            return static_cast<double>(ticks) * NanosecondsPerTick();
+        }
+
+    private:
+        struct Reference
+        {
+            std::uint64_t ticks{Now()};
+            std::chrono::steady_clock::time_point time{std::chrono::steady_clock::now()};
+        };
+
+        static const Reference& GetReference()
+        {
+            static const Reference reference{};
+            return reference;
+        }
+    };
+}
@@ -0,0 +1,246 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/api.h>
+#include <type_traits>
+
+namespace amxx
+{
+    /**
+     * @brief Array argument of a forward; wraps the handle returned by \c PrepareCellArray and friends.
+    */
+    struct ForwardArray
+    {
+        cell handle{};
+    };
+
+    /**
+     * @brief N/D
+    */
+    inline ForwardArray MakeForwardArray(cell* ptr, const std::size_t size, const bool copy_back = false)
+    {
+        return {PrepareCellArrayA(ptr, size, copy_back)};
+    }
+
+    /**
+     * @brief N/D
+    */
+    inline ForwardArray MakeForwardArray(char* ptr, const std::size_t size, const bool copy_back = false)
+    {
+        return {PrepareCharArrayA(ptr, size, copy_back)};
+    }
+
+    /**
+     * @brief Maps a C++ argument type to its \c ForwardParam tag and to the value pushed through \c ExecuteForward.
+    */
+    template <typename T, typename = void>
+    struct ForwardArg
+    {
+        static_assert(!std::is_same_v<T, T>, "Unsupported forward argument type.");
+    };
+
+    /**
+     * @brief Integral and enumeration arguments.
+    */
+    template <typename T>
+    struct ForwardArg<T, std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>>>
+    {
+        static constexpr auto PARAM = ForwardParam::Cell;
+
+        static cell Pass(const T value)
+        {
+            return static_cast<cell>(value);
+        }
+    };
+
+    /**
+     * @brief Floats; the core reads them as a promoted \c double.
+    */
+    template <>
+    struct ForwardArg<real>
+    {
+        static constexpr auto PARAM = ForwardParam::Float;
+
+        static double Pass(const real value)
+        {
+            return value;
+        }
+    };
+
+    /**
+     * @brief Read-only strings; the pointer is handed to the core as is.
+    */
+    template <>
+    struct ForwardArg<const char*>
+    {
+        static constexpr auto PARAM = ForwardParam::String;
+
+        static const char* Pass(const char* value)
+        {
+            return value;
+        }
+    };
+
+    /**
+     * @brief Writable strings; updated with the value left by the last plugin.
+    */
+    template <>
+    struct ForwardArg<char*>
+    {
+        static constexpr auto PARAM = ForwardParam::StringEx;
+
+        static char* Pass(char* value)
+        {
+            return value;
+        }
+    };
+
+    /**
+     * @brief N/D
+    */
+    template <>
+    struct ForwardArg<ForwardArray>
+    {
+        static constexpr auto PARAM = ForwardParam::Array;
+
+        static cell Pass(const ForwardArray value)
+        {
+            return value.handle;
+        }
+    };
+
+    /**
+     * @brief N/D
+    */
+    template <>
+    struct ForwardArg<cell&>
+    {
+        static constexpr auto PARAM = ForwardParam::CellByRef;
+
+        static cell* Pass(cell& value)
+        {
+            return &value;
+        }
+    };
+
+    /**
+     * @brief N/D
+    */
+    template <>
+    struct ForwardArg<real&>
+    {
+        static constexpr auto PARAM = ForwardParam::FloatByRef;
+
+        static real* Pass(real& value)
+        {
+            return &value;
+        }
+    };
+
+    template <typename TSignature>
+    class Forward;
+
+    /**
+     * @brief Forward whose parameter list is deduced from a C++ signature, e.g. \c Forward<int(int, real)>.
+     * The id is cached at registration; calls push the arguments with their exact types, and the
+     * execution type given at registration decides how the core stops and combines the plugin results.
+    */
+    template <typename TRet, typename... TArgs>
+    class Forward<TRet(TArgs...)>
+    {
+        static_assert(std::is_integral_v<TRet> || std::is_enum_v<TRet>, "Forward return type must be integral.");
+
+    public:
+        Forward() = default;
+
+        /**
+         * @brief Registers a multi-plugin forward; call it from \c AMXX_PluginsLoaded.
+        */
+        bool Register(const char* func_name, const ForwardExecType exec_type)
+        {
+            Unregister();
+            id_ = RegisterForward(func_name, exec_type, ForwardArg<TArgs>::PARAM..., ForwardParam::Done);
+
+            return IsValid();
+        }
+
+        /**
+         * @brief Registers a forward to a single plugin public.
+        */
+        bool RegisterSingle(Amx* amx, const char* func_name)
+        {
+            Unregister();
+
+            id_ = RegisterSpForwardByName(amx, func_name, ForwardArg<TArgs>::PARAM..., ForwardParam::Done);
+            single_plugin_ = IsValid();
+
+            return single_plugin_;
+        }
+
+        /**
+         * @brief Releases a single plugin forward; multi-plugin forwards live until the plugins are unloaded.
+        */
+        void Unregister()
+        {
+            if (single_plugin_ && IsValid()) {
+                UnregisterSpForward(id_);
+            }
+
+            Reset();
+        }
+
+        /**
+         * @brief Forgets the id without touching the core (e.g. in \c AMXX_PluginsUnloaded).
+        */
+        void Reset()
+        {
+            id_ = -1;
+            single_plugin_ = false;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] bool IsValid() const
+        {
+            return id_ >= 0;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int Id() const
+        {
+            return id_;
+        }
+
+        /**
+         * @brief Executes the forward; returns the combined plugin result.
+        */
+        TRet operator()(TArgs... args) const
+        {
+            return static_cast<TRet>(ExecuteForward(id_, ForwardArg<TArgs>::Pass(args)...));
+        }
+
+    private:
+        int id_{-1};
+        bool single_plugin_{};
+    };
+}
@@ -0,0 +1,468 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/api.h>
+#include <amxx/cell_span.h>
+#include <amxx/cell_string.h>
+#include <amxx/os_defs.h>
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Builds an \c AmxNativeInfo entry named after the C++ function.
+*/
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define AMXX_NATIVE(F) (amxx::MakeNative<&F>(#F))
+
+namespace amxx
+{
+    /**
+     * @brief Stack buffer of a plugin string argument bound as \c std::string_view or \c const char*, including
+     * the terminating zero. Longer strings are truncated and logged with \c LogError.
+    */
+    constexpr std::size_t NATIVE_STRING_BUFFER_SIZE = 4096;
+
+    /**
+     * @brief String argument whose buffer is sized by the native: at most \c N characters, narrowed into
+     * an <tt>N + 1</tt> byte stack buffer and never allocated. Longer strings are truncated.
+    */
+    template <std::size_t N>
+    class NativeString
+    {
+    public:
+        constexpr NativeString(const char* const data, const std::size_t size)
+            : data_(data), size_(size)
+        {
+        }
+
+        /**
+         * @brief Zero-terminated.
+        */
+        [[nodiscard]] constexpr const char* data() const
+        {
+            return data_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr std::size_t size() const
+        {
+            return size_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] constexpr bool empty() const
+        {
+            return size_ == 0;
+        }
+
+        // ReSharper disable once CppNonExplicitConversionOperator
+        constexpr operator std::string_view() const // NOLINT(google-explicit-constructor)
+        {
+            return {data_, size_};
+        }
+
+    private:
+        const char* data_;
+        std::size_t size_;
+    };
+
+    /**
+     * @brief Converts a single plugin parameter to the C++ type \c T.
+     * Specialize it to bind custom types (e.g. \c Vector) to native arguments.
+    */
+    template <typename T, typename = void>
+    struct NativeArg
+    {
+        static_assert(!std::is_same_v<T, T>, "Unsupported native argument type.");
+    };
+
+    /**
+     * @brief Integral and enumeration arguments, passed by value.
+    */
+    template <typename T>
+    struct NativeArg<T, std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>>>
+    {
+        T value;
+
+        NativeArg(const Amx* /*amx*/, const cell param)
+            : value(static_cast<T>(param))
+        {
+        }
+
+        T Get() const
+        {
+            return value;
+        }
+    };
+
+    /**
+     * @brief Boolean arguments; any nonzero cell is \c true.
+    */
+    template <>
+    struct NativeArg<bool>
+    {
+        bool value;
+
+        NativeArg(const Amx* /*amx*/, const cell param)
+            : value(param != 0)
+        {
+        }
+
+        bool Get() const
+        {
+            return value;
+        }
+    };
+
+    /**
+     * @brief Floating point arguments.
+    */
+    template <>
+    struct NativeArg<real>
+    {
+        real value;
+
+        NativeArg(const Amx* /*amx*/, const cell param)
+            : value(amx::CellToFloat(param))
+        {
+        }
+
+        real Get() const
+        {
+            return value;
+        }
+    };
+
+    /**
+     * @brief Cells passed by reference.
+    */
+    template <>
+    struct NativeArg<cell&>
+    {
+        cell* address;
+
+        NativeArg(const Amx* amx, const cell param)
+            : address(amx::Address(amx, param))
+        {
+        }
+
+        cell& Get() const
+        {
+            return *address;
+        }
+    };
+
+    /**
+     * @brief Floats passed by reference.
+    */
+    template <>
+    struct NativeArg<real&>
+    {
+        real* address;
+
+        NativeArg(const Amx* amx, const cell param)
+            : address(reinterpret_cast<real*>(amx::Address(amx, param)))
+        {
+        }
+
+        real& Get() const
+        {
+            return *address;
+        }
+    };
+
+    /**
+     * @brief Cell arrays, passed as a pointer into the plugin memory.
+    */
+    template <typename T>
+    struct NativeArg<T*, std::enable_if_t<std::is_same_v<std::remove_const_t<T>, cell>>>
+    {
+        T* address;
+
+        NativeArg(const Amx* amx, const cell param)
+            : address(amx::Address(amx, param))
+        {
+        }
+
+        T* Get() const
+        {
+            return address;
+        }
+    };
+
+    /**
+     * @brief Float arrays and vectors, passed as a pointer into the plugin memory.
+    */
+    template <typename T>
+    struct NativeArg<T*, std::enable_if_t<std::is_same_v<std::remove_const_t<T>, real>>>
+    {
+        T* address;
+
+        NativeArg(const Amx* amx, const cell param)
+            : address(reinterpret_cast<T*>(amx::Address(amx, param)))
+        {
+        }
+
+        T* Get() const
+        {
+            return address;
+        }
+    };
+
+    /**
+     * @brief Plugin strings, narrowed into a stack buffer that lives until the native returns; only the
+     * characters of the string are written, and nothing is allocated.
+    */
+    template <typename T>
+    struct NativeArg<T, std::enable_if_t<std::is_same_v<T, std::string_view> || std::is_same_v<T, const char*>>>
+    {
+        char data[NATIVE_STRING_BUFFER_SIZE];
+        std::size_t length;
+
+        NativeArg(const Amx* amx, const cell param)
+        {
+            const auto* const address = amx::Address(amx, param);
+            length = amx::simd::CellStringLength(address, NATIVE_STRING_BUFFER_SIZE - 1);
+
+            if (UNLIKELY(length == NATIVE_STRING_BUFFER_SIZE - 1 && address[length] != 0)) {
+                LogError(const_cast<Amx*>(amx), AmxError::Native, "String argument truncated to %d characters.",
+                         static_cast<int>(length));
+            }
+
+            amx::simd::NarrowCells(data, address, length);
+            data[length] = '\0';
+        }
+
+        NativeArg(const NativeArg&) = delete;
+        NativeArg& operator=(const NativeArg&) = delete;
+
+        T Get() const
+        {
+            if constexpr (std::is_same_v<T, std::string_view>) {
+                return {data, length};
+            }
+            else {
+                return data;
+            }
+        }
+    };
+
+    /**
+     * @brief Plugin strings bounded by the native; see \c NativeString.
+    */
+    template <std::size_t N>
+    struct NativeArg<NativeString<N>>
+    {
+        char buffer[N + 1];
+        std::size_t length;
+
+        NativeArg(const Amx* amx, const cell param)
+            : length(amx::NarrowString(amx::Address(amx, param), buffer).size())
+        {
+        }
+
+        NativeArg(const NativeArg&) = delete;
+        NativeArg& operator=(const NativeArg&) = delete;
+
+        NativeString<N> Get() const
+        {
+            return {buffer, length};
+        }
+    };
+
+    /**
+     * @brief Plugin arrays followed by their size, as in <tt>native f(const array[], size)</tt>.
+     * Consumes both parameters; \c T is \c cell or \c real, optionally const.
+    */
+    template <typename T>
+    struct NativeArg<amx::Span<T>>
+    {
+        static constexpr std::size_t PARAMS = 2;
+
+        amx::Span<T> value;
+
+        NativeArg(const Amx* amx, const cell address, const cell size)
+            : value(amx, address, size)
+        {
+        }
+
+        amx::Span<T> Get() const
+        {
+            return value;
+        }
+    };
+
+    /**
+     * @brief Plugin strings left in their cell form; nothing is copied.
+    */
+    template <>
+    struct NativeArg<amx::CellStringView>
+    {
+        amx::CellStringView value;
+
+        NativeArg(const Amx* amx, const cell param)
+            : value(amx, param)
+        {
+        }
+
+        amx::CellStringView Get() const
+        {
+            return value;
+        }
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        cell NativeResult(const T value)
+        {
+            if constexpr (std::is_same_v<T, real>) {
+                return amx::FloatToCell(value);
+            }
+            else {
+                static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "Unsupported native return type.");
+                return static_cast<cell>(value);
+            }
+        }
+
+        /**
+         * @brief Number of plugin parameters an argument of type \c T consumes: \c NativeArg<T>::PARAMS, or 1.
+        */
+        template <typename T, typename = void>
+        struct NativeArgParams : std::integral_constant<std::size_t, 1>
+        {
+        };
+
+        template <typename T>
+        struct NativeArgParams<T, std::void_t<decltype(NativeArg<T>::PARAMS)>>
+            : std::integral_constant<std::size_t, NativeArg<T>::PARAMS>
+        {
+        };
+
+        /**
+         * @brief Index in \c params of the first parameter of each argument; the last entry is the total.
+        */
+        template <typename... TArgs>
+        constexpr std::array<std::size_t, sizeof...(TArgs) + 1> NativeParamOffsets()
+        {
+            std::array<std::size_t, sizeof...(TArgs) + 1> offsets{};
+            std::size_t index{0};
+            std::size_t offset{1};
+
+            ((offsets[index++] = offset, offset += NativeArgParams<TArgs>::value), ...);
+            offsets[index] = offset - 1;
+
+            return offsets;
+        }
+
+        template <typename T>
+        NativeArg<T> BindNativeArg(const Amx* const amx, const cell* const params)
+        {
+            if constexpr (NativeArgParams<T>::value == 2) {
+                return {amx, params[0], params[1]};
+            }
+            else {
+                return {amx, params[0]};
+            }
+        }
+
+        template <typename TFunc>
+        struct NativeTraits;
+
+        template <typename TRet, typename... TArgs>
+        struct NativeTraits<TRet (*)(Amx*, TArgs...)>
+        {
+            static constexpr bool PASS_AMX = true;
+            static constexpr std::size_t ARG_COUNT = sizeof...(TArgs);
+            static constexpr auto OFFSETS = NativeParamOffsets<TArgs...>();
+            static constexpr std::size_t PARAM_COUNT = OFFSETS[sizeof...(TArgs)];
+
+            template <auto Func, std::size_t... I>
+            static cell Call(Amx* amx, const cell* params, std::index_sequence<I...>)
+            {
+                if constexpr (std::is_void_v<TRet>) {
+                    Func(amx, BindNativeArg<TArgs>(amx, params + OFFSETS[I]).Get()...);
+                    return 0;
+                }
+                else {
+                    return NativeResult(Func(amx, BindNativeArg<TArgs>(amx, params + OFFSETS[I]).Get()...));
+                }
+            }
+        };
+
+        template <typename TRet, typename... TArgs>
+        struct NativeTraits<TRet (*)(TArgs...)>
+        {
+            static constexpr bool PASS_AMX = false;
+            static constexpr std::size_t ARG_COUNT = sizeof...(TArgs);
+            static constexpr auto OFFSETS = NativeParamOffsets<TArgs...>();
+            static constexpr std::size_t PARAM_COUNT = OFFSETS[sizeof...(TArgs)];
+
+            template <auto Func, std::size_t... I>
+            static cell Call(const Amx* amx, const cell* params, std::index_sequence<I...>)
+            {
+                if constexpr (std::is_void_v<TRet>) {
+                    Func(BindNativeArg<TArgs>(amx, params + OFFSETS[I]).Get()...);
+                    return 0;
+                }
+                else {
+                    return NativeResult(Func(BindNativeArg<TArgs>(amx, params + OFFSETS[I]).Get()...));
+                }
+            }
+        };
+    }
+
+    /**
+     * @brief \c AmxNative trampoline that decodes \c params and calls \c Func.
+     * \c Func may take \c Amx* as its first parameter; it does not consume a plugin parameter.
+    */
+    template <auto Func>
+    cell AMX_NATIVE_CALL NativeTrampoline(Amx* amx, cell* params)
+    {
+        using Traits = detail::NativeTraits<decltype(Func)>;
+        constexpr auto param_count = Traits::PARAM_COUNT;
+
+        if constexpr (param_count > 0) {
+            if (UNLIKELY(static_cast<std::size_t>(params[0]) < param_count * sizeof(cell))) {
+                LogError(amx, AmxError::Native, "Invalid number of parameters (expected %d, got %d).",
+                         static_cast<int>(param_count), static_cast<int>(params[0] / sizeof(cell)));
+                return 0;
+            }
+        }
+
+        return Traits::template Call<Func>(amx, params, std::make_index_sequence<Traits::ARG_COUNT>{});
+    }
+
+    /**
+     * @brief Creates an \c AmxNativeInfo table entry for \c Func at compile time.
+    */
+    template <auto Func>
+    constexpr AmxNativeInfo MakeNative(const char* name)
+    {
+        return {name, &NativeTrampoline<Func>};
+    }
+}
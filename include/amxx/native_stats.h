@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// Per-native call counters and latency histograms.
+// Built only when the library is configured with AMXX_NATIVE_STATS ON; AddNatives and AddNewNatives then
+// register instrumented copies of the native lists. Without the option nothing here is compiled in.
+//
+
+namespace amxx
+{
+    /**
+     * @brief Maximum number of natives that can be instrumented; the rest are registered as they are.
+    */
+    constexpr std::size_t MAX_INSTRUMENTED_NATIVES = 1024;
+
+    /**
+     * @brief Number of plugins tracked per native; calls from further plugins are counted together.
+    */
+    constexpr std::size_t NATIVE_STATS_MAX_CALLERS = 16;
+
+    /**
+     * @brief N/D
+    */
+    struct NativeCallerStats
+    {
+        const Amx* amx{};
+        std::uint64_t calls{};
+    };
+
+    /**
+     * @brief Snapshot of the counters of one native; times are in nanoseconds.
+    */
+    struct NativeStats
+    {
+        const char* name{};
+        std::uint64_t calls{};
+        double total_ns{};
+        double mean_ns{};
+        double p50_ns{};
+        double p99_ns{};
+        double max_ns{};
+
+        /**
+         * @brief Calling plugins, most calls first.
+        */
+        std::vector<NativeCallerStats> callers{};
+
+        /**
+         * @brief Calls from plugins beyond \c NATIVE_STATS_MAX_CALLERS.
+        */
+        std::uint64_t other_calls{};
+    };
+
+    /**
+     * @brief Returns a copy of \c list whose entries count their calls and latency.
+     * The copy lives until the module is unloaded, as the core keeps the pointer.
+    */
+    const AmxNativeInfo* InstrumentNatives(const AmxNativeInfo* list);
+
+    /**
+     * @brief Pauses or resumes recording; paused natives only pay for one load and a branch.
+    */
+    void SetNativeStatsEnabled(bool enabled);
+
+    /**
+     * @brief N/D
+    */
+    bool NativeStatsEnabled();
+
+    /**
+     * @brief Snapshot of every instrumented native that was called, sorted by total time.
+    */
+    std::vector<NativeStats> CollectNativeStats();
+
+    /**
+     * @brief Table of the \c max_natives most expensive natives with their main callers.
+    */
+    std::string NativeStatsReport(std::size_t max_natives = 50);
+
+    /**
+     * @brief Prints \c NativeStatsReport to the server console.
+     * Called from \c AMXX_PluginsUnloading; call it from a server command to get a report on demand.
+    */
+    void DumpNativeStats();
+
+    /**
+     * @brief Clears the counters and the caller tables.
+    */
+    void ResetNativeStats();
+}
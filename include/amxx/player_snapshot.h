@@ -0,0 +1,275 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/api.h>
+#include <amxx/forward.h>
+#include <amxx/players.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace amxx
+{
+    /**
+     * @brief Health changed.
+    */
+    constexpr std::uint32_t PLAYER_FIELD_HEALTH = 1U << 0;
+
+    /**
+     * @brief Armor changed.
+    */
+    constexpr std::uint32_t PLAYER_FIELD_ARMOR = 1U << 1;
+
+    /**
+     * @brief Frags changed.
+    */
+    constexpr std::uint32_t PLAYER_FIELD_FRAGS = 1U << 2;
+
+    /**
+     * @brief Deaths changed.
+    */
+    constexpr std::uint32_t PLAYER_FIELD_DEATHS = 1U << 3;
+
+    /**
+     * @brief Team id changed.
+    */
+    constexpr std::uint32_t PLAYER_FIELD_TEAM_ID = 1U << 4;
+
+    /**
+     * @brief Current weapon changed.
+    */
+    constexpr std::uint32_t PLAYER_FIELD_CURRENT_WEAPON = 1U << 5;
+
+    /**
+     * @brief Player is in game.
+    */
+    constexpr std::uint32_t PLAYER_FIELD_IN_GAME = 1U << 6;
+
+    /**
+     * @brief Player is connected but not in game yet.
+    */
+    constexpr std::uint32_t PLAYER_FIELD_CONNECTED_NOT_IN_GAME = 1U << 7;
+
+    /**
+     * @brief Player is alive.
+    */
+    constexpr std::uint32_t PLAYER_FIELD_ALIVE = 1U << 8;
+
+    /**
+     * @brief Player is a bot; read when the slot enters the game.
+    */
+    constexpr std::uint32_t PLAYER_FIELD_BOT = 1U << 9;
+
+    /**
+     * @brief Player is an HLTV proxy; read when the slot enters the game.
+    */
+    constexpr std::uint32_t PLAYER_FIELD_HLTV = 1U << 10;
+
+    /**
+     * @brief N/D
+    */
+    struct PlayerChange
+    {
+        /**
+         * @brief Player index.
+        */
+        int id;
+
+        /**
+         * @brief Mask of the \c PLAYER_FIELD_* bits that differ from the previous capture.
+        */
+        std::uint32_t fields;
+    };
+
+    /**
+     * @brief Structure-of-arrays capture of the state of every player slot, diffed frame to frame.
+     * Capture it once per frame and let the rest of the module read the arrays instead of calling the getters.
+     * Deaths, team and weapon are plain loads through \c PlayerView. Health, armor, frags and the alive state
+     * live in the edict, not in the player record \c PlayerPropAddress exposes, so they still cost a getter
+     * call each per in-game slot.
+    */
+    class PlayerSnapshot
+    {
+    public:
+        /**
+         * @brief N/D
+        */
+        struct Frame
+        {
+            int health[MAX_CLIENTS + 1];
+            int armor[MAX_CLIENTS + 1];
+            int frags[MAX_CLIENTS + 1];
+            int deaths[MAX_CLIENTS + 1];
+            int team_id[MAX_CLIENTS + 1];
+            int current_weapon[MAX_CLIENTS + 1];
+
+            /**
+             * @brief \c PLAYER_FIELD_IN_GAME .. \c PLAYER_FIELD_HLTV bits.
+            */
+            std::uint32_t state[MAX_CLIENTS + 1];
+        };
+
+        /**
+         * @brief Reads every slot, diffs it against the previous capture and fires the change forward if set.
+         * Returns the number of changed slots.
+        */
+        std::size_t Capture()
+        {
+            frame_index_ ^= 1;
+
+            auto& current = frames_[frame_index_];
+            const auto& previous = frames_[frame_index_ ^ 1];
+
+            change_count_ = 0;
+
+            // The core has no player record past the server's max clients.
+            const auto max_clients = MaxClients();
+
+            for (auto id = 1; id <= max_clients; ++id) {
+                Read(current, previous, id);
+
+                const auto fields = Diff(current, previous, id);
+
+                if (fields) {
+                    changes_[change_count_++] = {id, fields};
+                }
+            }
+
+            if (change_forward_.IsValid()) {
+                for (std::size_t i = 0; i < change_count_; ++i) {
+                    change_forward_(changes_[i].id, static_cast<int>(changes_[i].fields));
+                }
+            }
+
+            return change_count_;
+        }
+
+        /**
+         * @brief Registers \c func_name(id, changed_fields) as a multi-plugin forward fired for every change.
+        */
+        bool RegisterChangeForward(const char* func_name)
+        {
+            return change_forward_.Register(func_name, ForwardExecType::Ignore);
+        }
+
+        /**
+         * @brief Clears both frames; the next capture reports every occupied slot as changed.
+        */
+        void Reset()
+        {
+            frames_[0] = Frame{};
+            frames_[1] = Frame{};
+            change_count_ = 0;
+            change_forward_.Reset();
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] const Frame& Current() const
+        {
+            return frames_[frame_index_];
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] const Frame& Previous() const
+        {
+            return frames_[frame_index_ ^ 1];
+        }
+
+        /**
+         * @brief Changes found by the last capture, ordered by player index.
+        */
+        [[nodiscard]] const PlayerChange* Changes() const
+        {
+            return changes_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] std::size_t ChangeCount() const
+        {
+            return change_count_;
+        }
+
+    private:
+        static void Read(Frame& frame, const Frame& previous, const int id)
+        {
+            const auto& view = GetPlayerView(id);
+
+            if (!view.InGame()) {
+                frame.health[id] = frame.armor[id] = frame.frags[id] = 0;
+                frame.deaths[id] = frame.team_id[id] = frame.current_weapon[id] = 0;
+                frame.state[id] = IsPlayerConnected(id) ? PLAYER_FIELD_CONNECTED_NOT_IN_GAME : 0;
+                return;
+            }
+
+            frame.health[id] = GetPlayerHealth(id);
+            frame.armor[id] = GetPlayerArmor(id);
+            frame.frags[id] = GetPlayerFrags(id);
+            frame.deaths[id] = view.Deaths();
+            frame.team_id[id] = view.TeamId();
+            frame.current_weapon[id] = view.CurrentWeapon();
+
+            auto state = PLAYER_FIELD_IN_GAME;
+
+            if (IsPlayerAlive(id)) {
+                state |= PLAYER_FIELD_ALIVE;
+            }
+
+            // A client stays a bot or an HLTV proxy for as long as it is in game.
+            if (previous.state[id] & PLAYER_FIELD_IN_GAME) {
+                state |= previous.state[id] & (PLAYER_FIELD_BOT | PLAYER_FIELD_HLTV);
+            }
+            else {
+                if (IsPlayerBot(id)) {
+                    state |= PLAYER_FIELD_BOT;
+                }
+
+                if (IsPlayerHltv(id)) {
+                    state |= PLAYER_FIELD_HLTV;
+                }
+            }
+
+            frame.state[id] = state;
+        }
+
+        static std::uint32_t Diff(const Frame& current, const Frame& previous, const int id)
+        {
+            std::uint32_t fields = current.state[id] ^ previous.state[id];
+
+            fields |= current.health[id] != previous.health[id] ? PLAYER_FIELD_HEALTH : 0;
+            fields |= current.armor[id] != previous.armor[id] ? PLAYER_FIELD_ARMOR : 0;
+            fields |= current.frags[id] != previous.frags[id] ? PLAYER_FIELD_FRAGS : 0;
+            fields |= current.deaths[id] != previous.deaths[id] ? PLAYER_FIELD_DEATHS : 0;
+            fields |= current.team_id[id] != previous.team_id[id] ? PLAYER_FIELD_TEAM_ID : 0;
+            fields |= current.current_weapon[id] != previous.current_weapon[id] ? PLAYER_FIELD_CURRENT_WEAPON : 0;
+
+            return fields;
+        }
+
+        Frame frames_[2]{};
+        int frame_index_{};
+        PlayerChange changes_[MAX_CLIENTS]{};
+        std::size_t change_count_{};
+        Forward<int(int, int)> change_forward_{};
+    };
+}
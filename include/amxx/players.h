@@ -0,0 +1,367 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/api.h>
+#include <amxx/os_defs.h>
+#include <cassert>
+
+namespace amxx
+{
+    /**
+     * @brief Maximum number of player slots.
+    */
+    constexpr auto MAX_CLIENTS = 32;
+
+    /**
+     * @brief Entries of \c PlayerProp::Weapons every core version has.
+    */
+    constexpr auto MAX_PLAYER_WEAPONS = 32;
+
+    /**
+     * @brief Admin levels of \c PlayerProp::Flags.
+    */
+    constexpr auto MAX_ACCESS_LEVELS = 32;
+
+    /**
+     * @brief Layout of an entry of \c PlayerProp::Weapons.
+    */
+    struct PlayerWeapon
+    {
+        int ammo;
+        int clip;
+    };
+
+    /**
+     * @brief Typed pointers into the core player record, resolved once through \c PlayerPropAddress.
+     * Reading a property is a plain load; the view stays valid until the slot is invalidated.
+     * \c IsBound, \c Id and \c InGame work on any view; the other accessors need a bound one, which is the
+     * case whenever \c InGame is true, and only assert it in debug builds.
+    */
+    class PlayerView
+    {
+    public:
+        /**
+         * @brief Resolves every property address of the player \c id.
+         * The view stays unbound if the core has no record for \c id (past the server's max clients).
+        */
+        void Bind(const int id)
+        {
+            id_ = id;
+            in_game_ = Resolve<bool>(PlayerProp::InGame);
+
+            if (UNLIKELY(!in_game_)) {
+                Invalidate();
+                return;
+            }
+
+            authorized_ = Resolve<bool>(PlayerProp::Authorized);
+            vgui_ = Resolve<bool>(PlayerProp::Vgui);
+            time_ = Resolve<float>(PlayerProp::Time);
+            play_time_ = Resolve<float>(PlayerProp::PlayTime);
+            menu_expire_ = Resolve<float>(PlayerProp::MenuExpire);
+            weapons_ = Resolve<PlayerWeapon>(PlayerProp::Weapons);
+            current_weapon_ = Resolve<int>(PlayerProp::CurrentWeapon);
+            team_id_ = Resolve<int>(PlayerProp::TeamId);
+            deaths_ = Resolve<int>(PlayerProp::Deaths);
+            aiming_ = Resolve<int>(PlayerProp::Aiming);
+            menu_ = Resolve<int>(PlayerProp::Menu);
+            keys_ = Resolve<int>(PlayerProp::Keys);
+            flags_ = Resolve<int>(PlayerProp::Flags);
+            new_menu_ = Resolve<int>(PlayerProp::NewMenu);
+            new_menu_page_ = Resolve<int>(PlayerProp::NewMenuPage);
+            edict_ = GetPlayerEdict(id);
+        }
+
+        /**
+         * @brief Drops the cached addresses; the next access through \c GetPlayerView binds again.
+        */
+        void Invalidate()
+        {
+            *this = PlayerView{};
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] bool IsBound() const
+        {
+            return id_ != 0;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int Id() const
+        {
+            return id_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] bool InGame() const
+        {
+            return in_game_ && *in_game_;
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] bool Authorized() const
+        {
+            return Load(authorized_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] bool Vgui() const
+        {
+            return Load(vgui_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] float Time() const
+        {
+            return Load(time_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] float PlayTime() const
+        {
+            return Load(play_time_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] float MenuExpire() const
+        {
+            return Load(menu_expire_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] const PlayerWeapon& Weapon(const int weapon_id) const
+        {
+            assert(IsBound() && weapon_id >= 0 && weapon_id < MAX_PLAYER_WEAPONS);
+            return Load(weapons_ + weapon_id);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int CurrentWeapon() const
+        {
+            return Load(current_weapon_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int TeamId() const
+        {
+            return Load(team_id_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int Deaths() const
+        {
+            return Load(deaths_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int Aiming() const
+        {
+            return Load(aiming_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int Menu() const
+        {
+            return Load(menu_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int Keys() const
+        {
+            return Load(keys_);
+        }
+
+        /**
+         * @brief Access flags of the admin level \c level (0 is the default one).
+        */
+        [[nodiscard]] int Flags(const int level = 0) const
+        {
+            assert(IsBound() && level >= 0 && level < MAX_ACCESS_LEVELS);
+            return Load(flags_ + level);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int NewMenu() const
+        {
+            return Load(new_menu_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] int NewMenuPage() const
+        {
+            return Load(new_menu_page_);
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] cssdk::Edict* Edict() const
+        {
+            assert(IsBound());
+            return edict_;
+        }
+
+    private:
+        template <typename T>
+        const T& Load(const T* const address) const
+        {
+            assert(IsBound() && address);
+            return *address;
+        }
+
+        template <typename T>
+        T* Resolve(const PlayerProp prop) const
+        {
+            return static_cast<T*>(PlayerPropAddress(id_, prop));
+        }
+
+        int id_{};
+        bool* in_game_{};
+        bool* authorized_{};
+        bool* vgui_{};
+        float* time_{};
+        float* play_time_{};
+        float* menu_expire_{};
+        PlayerWeapon* weapons_{};
+        int* current_weapon_{};
+        int* team_id_{};
+        int* deaths_{};
+        int* aiming_{};
+        int* menu_{};
+        int* keys_{};
+        int* flags_{};
+        int* new_menu_{};
+        int* new_menu_page_{};
+        cssdk::Edict* edict_{};
+    };
+
+    namespace detail
+    {
+        inline PlayerView player_views[MAX_CLIENTS + 1]{};
+        inline int max_clients{};
+    }
+
+    inline void InvalidatePlayerViews();
+
+    /**
+     * @brief Number of player slots of the running server (\c gpGlobals->maxClients).
+     * The core hands out player properties only up to that index, so it is probed once through
+     * \c PlayerPropAddress and cached until \c InvalidatePlayerViews.
+    */
+    inline int MaxClients()
+    {
+        if (UNLIKELY(detail::max_clients == 0)) {
+            auto count = MAX_CLIENTS;
+
+            while (count > 0 && !PlayerPropAddress(count, PlayerProp::InGame)) {
+                --count;
+            }
+
+            detail::max_clients = count;
+            detail::AddUnloadHandler(&InvalidatePlayerViews);
+        }
+
+        return detail::max_clients;
+    }
+
+    /**
+     * @brief Returns the view of the player \c id, binding it on first use.
+     * Ids outside 1..MaxClients() get an unbound view whose \c InGame is false.
+    */
+    inline const PlayerView& GetPlayerView(const int id)
+    {
+        if (UNLIKELY(id < 1 || id > MaxClients())) {
+            return detail::player_views[0];
+        }
+
+        auto& view = detail::player_views[id];
+
+        if (UNLIKELY(!view.IsBound())) {
+            view.Bind(id);
+        }
+
+        return view;
+    }
+
+    /**
+     * @brief Rebinds the view of a player; call it when the client connects. Ids outside 1..MaxClients() are ignored.
+    */
+    inline void OnPlayerConnected(const int id)
+    {
+        if (LIKELY(id >= 1 && id <= MaxClients())) {
+            detail::player_views[id].Bind(id);
+        }
+    }
+
+    /**
+     * @brief Invalidates the view of a player; call it when the client disconnects. Invalid ids are ignored.
+    */
+    inline void OnPlayerDisconnected(const int id)
+    {
+        if (LIKELY(id >= 1 && id <= MAX_CLIENTS)) {
+            detail::player_views[id].Invalidate();
+        }
+    }
+
+    /**
+     * @brief Invalidates every player view and the cached \c MaxClients; the server may change it between maps.
+    */
+    inline void InvalidatePlayerViews()
+    {
+        for (auto& view : detail::player_views) {
+            view.Invalidate();
+        }
+
+        detail::max_clients = 0;
+    }
+}
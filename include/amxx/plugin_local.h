@@ -0,0 +1,226 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+//
+// Per-plugin state without a map keyed by Amx*.
+// Every plugin that holds any state gets one table, kept under a single Amx::user_data slot; each PluginLocal
+// owns one index into the tables. A lookup is a check of the user tag and an index, with no hashing.
+// The core keeps most user data slots for itself and leaves one free, so other per-plugin state of the library
+// (the profiler, the fake host's interpreter) is kept in a PluginLocal rather than in a slot of its own. If the
+// free slot is taken, the tables are found by a linear search instead.
+// The values are destroyed when the plugins are unloaded, or earlier with Reset and ReleasePluginLocals.
+// Game thread only.
+//
+
+namespace amxx
+{
+    namespace detail
+    {
+        constexpr auto PLUGIN_LOCAL_TAG = amx::MakeUserTag('P', 'L', 'O', 'C');
+
+        using PluginSlotDestructor = void (*)(void* value);
+
+        /**
+         * @brief Values of one plugin, indexed by slot; null where the plugin has no value.
+        */
+        struct PluginSlots
+        {
+            Amx* amx;
+            std::vector<void*> values;
+        };
+
+        /**
+         * @brief Claims a slot whose values are destroyed with \c destructor.
+        */
+        std::size_t AcquirePluginSlot(PluginSlotDestructor destructor);
+
+        /**
+         * @brief Destroys the values of \c slot in every plugin and frees the slot.
+        */
+        void ReleasePluginSlot(std::size_t slot);
+
+        /**
+         * @brief Destroys the value of \c slot in \c amx, if any.
+        */
+        void ResetPluginSlot(const Amx* amx, std::size_t slot);
+
+        /**
+         * @brief Destroys the values of \c slot in every plugin.
+        */
+        void ClearPluginSlot(std::size_t slot);
+
+        /**
+         * @brief Returns the table of \c amx, creating it if there is none.
+        */
+        PluginSlots& GetPluginSlots(Amx* amx);
+
+        /**
+         * @brief Linear search for the table of a plugin that got no user data slot.
+        */
+        PluginSlots* FindPluginSlotsSlow(const Amx* amx);
+
+        /**
+         * @brief Every table, in the order the plugins first stored a value.
+        */
+        const std::vector<std::unique_ptr<PluginSlots>>& PluginSlotTables();
+
+        /**
+         * @brief Returns the table of \c amx, or nullptr.
+        */
+        inline PluginSlots* FindPluginSlots(const Amx* const amx)
+        {
+            if (auto* const slots = static_cast<PluginSlots*>(amx::GetUserData(amx, PLUGIN_LOCAL_TAG))) {
+                return slots;
+            }
+
+            return FindPluginSlotsSlow(amx);
+        }
+    }
+
+    /**
+     * @brief One value of type \c T per plugin, created on first use.
+     * \c T is built from the \c Amx* if it has such a constructor, and value-initialized otherwise.
+     *
+     * @code
+     * PluginLocal<PluginState> g_state;
+     *
+     * cell AMX_NATIVE_CALL Native(Amx* amx, cell* params)
+     * {
+     *     auto& state = g_state.Get(amx);
+     *     ...
+     * }
+     * @endcode
+    */
+    template <typename T>
+    class PluginLocal
+    {
+    public:
+        PluginLocal()
+            : slot_(detail::AcquirePluginSlot([](void* const value) { delete static_cast<T*>(value); }))
+        {
+        }
+
+        ~PluginLocal()
+        {
+            detail::ReleasePluginSlot(slot_);
+        }
+
+        PluginLocal(const PluginLocal&) = delete;
+        PluginLocal& operator=(const PluginLocal&) = delete;
+
+        /**
+         * @brief Returns the value of \c amx, creating it if there is none.
+        */
+        T& Get(Amx* const amx)
+        {
+            if (auto* const value = Find(amx)) {
+                return *value;
+            }
+
+            auto& slots = detail::GetPluginSlots(amx);
+
+            if (slots.values.size() <= slot_) {
+                slots.values.resize(slot_ + 1);
+            }
+
+            T* value;
+
+            if constexpr (std::is_constructible_v<T, Amx*>) {
+                value = new T(amx);
+            }
+            else {
+                value = new T();
+            }
+
+            slots.values[slot_] = value;
+
+            return *value;
+        }
+
+        /**
+         * @brief Returns the value of \c amx, or nullptr if it has none.
+        */
+        [[nodiscard]] T* Find(const Amx* const amx) const
+        {
+            const auto* const slots = detail::FindPluginSlots(amx);
+
+            if (!slots || slot_ >= slots->values.size()) {
+                return nullptr;
+            }
+
+            return static_cast<T*>(slots->values[slot_]);
+        }
+
+        /**
+         * @brief Same as \c Get.
+        */
+        T& operator[](Amx* const amx)
+        {
+            return Get(amx);
+        }
+
+        /**
+         * @brief Destroys the value of \c amx; the next \c Get creates a new one.
+        */
+        void Reset(const Amx* const amx)
+        {
+            detail::ResetPluginSlot(amx, slot_);
+        }
+
+        /**
+         * @brief Destroys the values of every plugin.
+        */
+        void Clear()
+        {
+            detail::ClearPluginSlot(slot_);
+        }
+
+        /**
+         * @brief Calls \c func(Amx*, T&) for every plugin that has a value.
+        */
+        template <typename TFunc>
+        void ForEach(TFunc&& func)
+        {
+            for (const auto& slots : detail::PluginSlotTables()) {
+                if (slot_ < slots->values.size() && slots->values[slot_]) {
+                    func(slots->amx, *static_cast<T*>(slots->values[slot_]));
+                }
+            }
+        }
+
+    private:
+        std::size_t slot_;
+    };
+
+    /**
+     * @brief Destroys every value of \c amx, e.g. when a single plugin goes away.
+    */
+    void ReleasePluginLocals(Amx* amx);
+
+    /**
+     * @brief Destroys every value of every plugin; called before the plugins are unloaded.
+    */
+    void ReleasePluginLocals();
+}
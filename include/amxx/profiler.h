@@ -0,0 +1,80 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/amx_debug.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//
+// Sampling profiler for plugin code.
+// Installs itself as the debug hook of the selected scripts (chaining the hook already there) and, at most
+// \c samples_per_second times per second, walks the frame chain from \c Amx::cip and \c Amx::frm.
+// The hook runs on the BREAK instructions the compiler emits per statement in plugins built with debug info;
+// plugins built without it are never sampled. Samples are only taken at statement boundaries, so time spent
+// in a slow native is under-counted and lands on the statement that follows the call.
+// Built only when the library is configured with AMXX_PROFILER ON; profiling stops when the plugins unload.
+//
+
+namespace amxx
+{
+    /**
+     * @brief Starts sampling \c amx, e.g. a script from \c GetAmxScript.
+     * Frames are named from \c symbols if given, otherwise from the debug information of the image if it is
+     * still intact (see \c amx::DebugInfo::ParseImage), otherwise after the nearest public at or below them.
+     * Returns false if \c amx is already profiled.
+    */
+    bool StartProfiling(Amx* amx, std::uint32_t samples_per_second = 1000, const amx::DebugInfo* symbols = nullptr);
+
+    /**
+     * @brief Restores the previous debug hook of \c amx; its samples are kept for \c CollapsedStacks.
+    */
+    void StopProfiling(Amx* amx);
+
+    /**
+     * @brief Stops profiling every script; called before the plugins are unloaded.
+    */
+    void StopProfiling();
+
+    /**
+     * @brief True between \c StartProfiling and \c StopProfiling of \c amx.
+    */
+    bool IsProfiling(const Amx* amx);
+
+    /**
+     * @brief Number of samples taken since the last reset.
+    */
+    std::uint64_t ProfilerSampleCount();
+
+    /**
+     * @brief Samples in collapsed-stack format ("plugin.amxx;outer;inner count" per line), ready for flamegraph.pl.
+    */
+    std::string CollapsedStacks();
+
+    /**
+     * @brief Writes \c CollapsedStacks to \c path; returns false if the file cannot be written.
+    */
+    bool WriteCollapsedStacks(const char* path);
+
+    /**
+     * @brief Drops every sample; profiling goes on.
+    */
+    void ResetProfiler();
+}
@@ -0,0 +1,646 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/amx_heap.h>
+#include <amxx/amx_index.h>
+#include <amxx/api.h>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace amxx
+{
+    /**
+     * @brief Read-only array argument of a public; copied into the plugin heap.
+    */
+    struct InArray
+    {
+        const cell* data;
+        std::size_t size;
+    };
+
+    /**
+     * @brief Array argument whose contents are copied back after the call.
+    */
+    struct InOutArray
+    {
+        cell* data;
+        std::size_t size;
+    };
+
+    /**
+     * @brief Module-owned array passed to publics as \c SharedArray&, e.g. by a \c PublicBroadcast.
+     * Every call still copies it into the heap of the plugin, as plugins cannot address module memory, but it is
+     * only copied back when the plugin changed it, and \c Dirty tells whether any plugin wrote to it. It needs
+     * no \c PrepareCellArray, so the same array can be passed to several broadcasts in a frame as it is.
+    */
+    class SharedArray
+    {
+    public:
+        SharedArray(cell* const data, const std::size_t size, const bool copy_back = true)
+            : data_(data), size_(size), copy_back_(copy_back)
+        {
+        }
+
+        /**
+         * @brief Module memory of the array.
+        */
+        [[nodiscard]] cell* Data() const
+        {
+            return data_;
+        }
+
+        /**
+         * @brief Number of cells of the array.
+        */
+        [[nodiscard]] std::size_t Size() const
+        {
+            return size_;
+        }
+
+        /**
+         * @brief True if changes made by the plugins are copied back into the array.
+        */
+        [[nodiscard]] bool CopiesBack() const
+        {
+            return copy_back_;
+        }
+
+        /**
+         * @brief True once a plugin has changed the array, until \c ClearDirty.
+        */
+        [[nodiscard]] bool Dirty() const
+        {
+            return dirty_;
+        }
+
+        /**
+         * @brief Forgets the changes seen so far, e.g. before the next broadcast.
+        */
+        void ClearDirty()
+        {
+            dirty_ = false;
+        }
+
+        /**
+         * @brief Takes the contents left by a plugin if they differ; comparing only reads the plugin copy.
+        */
+        void Update(const cell* const phys)
+        {
+            if (std::memcmp(phys, data_, size_ * sizeof(cell)) == 0) {
+                return;
+            }
+
+            dirty_ = true;
+
+            if (copy_back_) {
+                std::memcpy(data_, phys, size_ * sizeof(cell));
+            }
+        }
+
+    private:
+        cell* data_;
+        std::size_t size_;
+        bool copy_back_;
+        bool dirty_{};
+    };
+
+    /**
+     * @brief Marshals a C++ argument of a public call.
+     * \c HeapCells tells how much plugin heap the argument needs, \c Marshal writes it and returns the cell
+     * to push, and \c CopyBack reads it back after the call.
+    */
+    template <typename T, typename = void>
+    struct PublicArg
+    {
+        static_assert(!std::is_same_v<T, T>, "Unsupported public argument type.");
+    };
+
+    /**
+     * @brief Integral and enumeration arguments.
+    */
+    template <typename T>
+    struct PublicArg<T, std::enable_if_t<std::is_integral_v<T> || std::is_enum_v<T>>>
+    {
+        static std::size_t HeapCells(T /*value*/)
+        {
+            return 0;
+        }
+
+        static cell Marshal(const T value, cell /*address*/, cell* /*phys*/)
+        {
+            return static_cast<cell>(value);
+        }
+
+        static void CopyBack(T /*value*/, const cell* /*phys*/)
+        {
+        }
+    };
+
+    /**
+     * @brief Float arguments, passed by value.
+    */
+    template <>
+    struct PublicArg<real>
+    {
+        static std::size_t HeapCells(real /*value*/)
+        {
+            return 0;
+        }
+
+        static cell Marshal(const real value, cell /*address*/, cell* /*phys*/)
+        {
+            return amx::FloatToCell(value);
+        }
+
+        static void CopyBack(real /*value*/, const cell* /*phys*/)
+        {
+        }
+    };
+
+    /**
+     * @brief Strings, widened into the plugin heap.
+    */
+    template <>
+    struct PublicArg<std::string_view>
+    {
+        static std::size_t HeapCells(const std::string_view value)
+        {
+            return value.size() + 1;
+        }
+
+        static cell Marshal(const std::string_view value, const cell address, cell* const phys)
+        {
+            amx::simd::WidenChars(phys, value.data(), value.size());
+            phys[value.size()] = 0;
+
+            return address;
+        }
+
+        static void CopyBack(std::string_view /*value*/, const cell* /*phys*/)
+        {
+        }
+    };
+
+    /**
+     * @brief C strings; a null pointer is passed as an empty string.
+    */
+    template <>
+    struct PublicArg<const char*>
+    {
+        static std::size_t HeapCells(const char* const value)
+        {
+            return PublicArg<std::string_view>::HeapCells(value ? value : "");
+        }
+
+        static cell Marshal(const char* const value, const cell address, cell* const phys)
+        {
+            return PublicArg<std::string_view>::Marshal(value ? value : "", address, phys);
+        }
+
+        static void CopyBack(const char* /*value*/, const cell* /*phys*/)
+        {
+        }
+    };
+
+    /**
+     * @brief Read-only arrays, copied into the plugin heap.
+    */
+    template <>
+    struct PublicArg<InArray>
+    {
+        static std::size_t HeapCells(const InArray value)
+        {
+            return value.size;
+        }
+
+        static cell Marshal(const InArray value, const cell address, cell* const phys)
+        {
+            std::memcpy(phys, value.data, value.size * sizeof(cell));
+            return address;
+        }
+
+        static void CopyBack(InArray /*value*/, const cell* /*phys*/)
+        {
+        }
+    };
+
+    /**
+     * @brief Arrays copied into the plugin heap and back after the call.
+    */
+    template <>
+    struct PublicArg<InOutArray>
+    {
+        static std::size_t HeapCells(const InOutArray value)
+        {
+            return value.size;
+        }
+
+        static cell Marshal(const InOutArray value, const cell address, cell* const phys)
+        {
+            std::memcpy(phys, value.data, value.size * sizeof(cell));
+            return address;
+        }
+
+        static void CopyBack(const InOutArray value, const cell* const phys)
+        {
+            std::memcpy(value.data, phys, value.size * sizeof(cell));
+        }
+    };
+
+    /**
+     * @brief Shared arrays; copied back only when the plugin changed them.
+    */
+    template <>
+    struct PublicArg<SharedArray&>
+    {
+        static std::size_t HeapCells(const SharedArray& value)
+        {
+            return value.Size();
+        }
+
+        static cell Marshal(const SharedArray& value, const cell address, cell* const phys)
+        {
+            std::memcpy(phys, value.Data(), value.Size() * sizeof(cell));
+            return address;
+        }
+
+        static void CopyBack(SharedArray& value, const cell* const phys)
+        {
+            value.Update(phys);
+        }
+    };
+
+    /**
+     * @brief Cells passed by reference.
+    */
+    template <>
+    struct PublicArg<cell&>
+    {
+        static std::size_t HeapCells(const cell& /*value*/)
+        {
+            return 1;
+        }
+
+        static cell Marshal(const cell& value, const cell address, cell* const phys)
+        {
+            *phys = value;
+            return address;
+        }
+
+        static void CopyBack(cell& value, const cell* const phys)
+        {
+            value = *phys;
+        }
+    };
+
+    /**
+     * @brief Floats passed by reference.
+    */
+    template <>
+    struct PublicArg<real&>
+    {
+        static std::size_t HeapCells(const real& /*value*/)
+        {
+            return 1;
+        }
+
+        static cell Marshal(const real& value, const cell address, cell* const phys)
+        {
+            *phys = amx::FloatToCell(value);
+            return address;
+        }
+
+        static void CopyBack(real& value, const cell* const phys)
+        {
+            value = amx::CellToFloat(*phys);
+        }
+    };
+
+    namespace detail
+    {
+        /**
+         * @brief Lays out the arguments of a public call in one \c AmxHeapScope allocation, runs
+         * \c exec(params, result) and copies the results back if it succeeded. \c Amx::hea and \c Amx::stk are
+         * restored afterwards whatever the outcome.
+        */
+        template <typename... TArgs>
+        struct PublicArgs
+        {
+            template <typename TExec>
+            static AmxError Run(Amx* const amx, cell& result, TExec&& exec, TArgs... args)
+            {
+                cell params[sizeof...(TArgs) + 1];
+                [[maybe_unused]] std::size_t offsets[sizeof...(TArgs) + 1];
+                std::size_t heap_cells{0};
+                std::size_t arg{0};
+
+                ((offsets[arg++] = heap_cells, heap_cells += PublicArg<TArgs>::HeapCells(args)), ...);
+
+                const auto saved_stk = amx->stk;
+                AmxHeapScope heap{amx};
+                const auto block = heap.Allocate(heap_cells);
+
+                if (UNLIKELY(!block)) {
+                    return AmxError::Memory;
+                }
+
+                arg = 0;
+                ((params[arg] = PublicArg<TArgs>::Marshal(args, block.address + static_cast<cell>(offsets[arg] * sizeof(cell)),
+                                                          block.phys + offsets[arg]),
+                  ++arg),
+                 ...);
+
+                const auto error = exec(params, result);
+
+                if (error == AmxError::None) {
+                    arg = 0;
+                    (PublicArg<TArgs>::CopyBack(args, block.phys + offsets[arg++]), ...);
+                }
+
+                amx->stk = saved_stk;
+
+                return error;
+            }
+        };
+    }
+
+    template <typename TSignature>
+    class PublicCall;
+
+    /**
+     * @brief Reusable call of a plugin public with a fixed C++ signature, e.g. \c PublicCall<int(int, const char*)>.
+     * All heap arguments are laid out in one \c AmxHeapScope allocation and pushed with \c AmxPush before
+     * \c AmxExec; \c Amx::hea and \c Amx::stk are restored afterwards whatever the outcome.
+    */
+    template <typename TRet, typename... TArgs>
+    class PublicCall<TRet(TArgs...)>
+    {
+    public:
+        PublicCall() = default;
+
+        PublicCall(Amx* amx, const int index)
+            : amx_(amx), index_(index)
+        {
+        }
+
+        /**
+         * @brief Binds to the public \c name of \c amx; returns false if the plugin has no such public.
+        */
+        bool Bind(Amx* amx, const std::string_view name)
+        {
+            amx_ = amx;
+            index_ = FindPublicIndex(amx, name);
+
+            return IsValid();
+        }
+
+        /**
+         * @brief True if the public was found.
+        */
+        [[nodiscard]] bool IsValid() const
+        {
+            return amx_ && index_ >= 0;
+        }
+
+        /**
+         * @brief Plugin the public belongs to.
+        */
+        [[nodiscard]] Amx* GetAmx() const
+        {
+            return amx_;
+        }
+
+        /**
+         * @brief Index of the public in the plugin.
+        */
+        [[nodiscard]] int Index() const
+        {
+            return index_;
+        }
+
+        /**
+         * @brief Error code of the last call (\c AmxError::None on success).
+        */
+        [[nodiscard]] AmxError Error() const
+        {
+            return error_;
+        }
+
+        /**
+         * @brief Calls the public; returns 0 and sets \c Error on failure.
+        */
+        TRet operator()(TArgs... args)
+        {
+            cell result{};
+
+            error_ = detail::PublicArgs<TArgs...>::Run(
+                amx_, result,
+                [this](const cell* const params, cell& return_val) {
+                    // The core registers amx_Execv as plain amx_Exec, so the arguments have to be pushed.
+                    for (auto i = sizeof...(TArgs); i > 0; --i) {
+                        if (UNLIKELY(AmxPush(amx_, params[i - 1]) != static_cast<int>(AmxError::None))) {
+                            amx_->param_count = 0;
+                            return AmxError::StackErr;
+                        }
+                    }
+
+                    return static_cast<AmxError>(AmxExec(amx_, &return_val, index_));
+                },
+                args...);
+
+            return Result(error_ == AmxError::None ? result : 0);
+        }
+
+    private:
+        static TRet Result([[maybe_unused]] const cell value)
+        {
+            if constexpr (std::is_same_v<TRet, real>) {
+                return amx::CellToFloat(value);
+            }
+            else if constexpr (!std::is_void_v<TRet>) {
+                return static_cast<TRet>(value);
+            }
+        }
+
+        Amx* amx_{};
+        int index_{-1};
+        AmxError error_{AmxError::None};
+    };
+
+    template <typename TSignature>
+    class PublicBroadcast;
+
+    /**
+     * @brief Module-side multi-plugin forward: calls the public of every plugin that has it, in load order.
+     * Combines the results the way the core does for \c ForwardExecType. Unlike \c Forward, arrays can be
+     * passed as \c SharedArray& and skip the copy back when a plugin left them unchanged.
+     * Each plugin is called through a single-plugin forward of plain cells that point into the heap block laid
+     * out by the module, so the core skips paused and stopped plugins as it does for its own forwards; the
+     * arguments are therefore laid out once per plugin and call, not once per broadcast.
+    */
+    template <typename TRet, typename... TArgs>
+    class PublicBroadcast<TRet(TArgs...)>
+    {
+        static_assert(std::is_integral_v<TRet> || std::is_enum_v<TRet>, "Broadcast return type must be integral.");
+
+    public:
+        PublicBroadcast() = default;
+        PublicBroadcast(const PublicBroadcast&) = delete;
+        PublicBroadcast& operator=(const PublicBroadcast&) = delete;
+
+        /**
+         * @brief Finds the public \c name in the loaded plugins; call it from \c AMXX_PluginsLoaded.
+         * Returns false if no plugin has it.
+        */
+        bool Bind(const std::string_view name, const ForwardExecType exec_type)
+        {
+            Reset();
+            exec_type_ = exec_type;
+
+            for (auto id = 0;; ++id) {
+                auto* const amx = GetAmxScript(id);
+
+                if (!amx) {
+                    break;
+                }
+
+                const auto index = FindPublicIndex(amx, name);
+
+                if (index < 0) {
+                    continue;
+                }
+
+                const auto forward = RegisterSpForward(amx, index, (static_cast<void>(sizeof(TArgs)), ForwardParam::Cell)...,
+                                                       ForwardParam::Done);
+
+                if (forward >= 0) {
+                    targets_.push_back({amx, forward});
+                }
+            }
+
+            return !targets_.empty();
+        }
+
+        /**
+         * @brief Releases the forwards and forgets the plugins (e.g. in \c AMXX_PluginsUnloading).
+        */
+        void Reset()
+        {
+            for (const auto& target : targets_) {
+                UnregisterSpForward(target.forward);
+            }
+
+            targets_.clear();
+        }
+
+        /**
+         * @brief Number of plugins with the public.
+        */
+        [[nodiscard]] std::size_t Count() const
+        {
+            return targets_.size();
+        }
+
+        /**
+         * @brief Error of the last plugin that failed in the last call (\c AmxError::None if none did).
+         * The core logs run time errors of forwards and returns 0, so only errors raised by natives and failures
+         * to lay out the arguments are seen here.
+        */
+        [[nodiscard]] AmxError Error() const
+        {
+            return error_;
+        }
+
+        /**
+         * @brief Calls the public of each plugin; a plugin that fails is skipped, as with the core's forwards,
+         * and its error is kept for \c Error.
+        */
+        TRet operator()(TArgs... args)
+        {
+            cell result{};
+            error_ = AmxError::None;
+
+            for (const auto& target : targets_) {
+                cell value{};
+                const auto error = detail::PublicArgs<TArgs...>::Run(
+                    target.amx, value,
+                    [amx = target.amx, forward = target.forward](const cell* const params, cell& return_val) {
+                        // ExecuteForward returns 0 on failure; an error raised by a native stays in Amx::error.
+                        amx->error = static_cast<int>(AmxError::None);
+                        return_val = Execute(forward, params, std::index_sequence_for<TArgs...>{});
+
+                        return static_cast<AmxError>(amx->error);
+                    },
+                    args...);
+
+                if (error != AmxError::None) {
+                    error_ = error;
+                    continue;
+                }
+
+                switch (exec_type_) {
+                case ForwardExecType::Stop:
+                    if (value > 0) {
+                        return static_cast<TRet>(value);
+                    }
+
+                    break;
+
+                case ForwardExecType::Stop2:
+                    if (value == 1) {
+                        return static_cast<TRet>(value);
+                    }
+
+                    [[fallthrough]];
+
+                case ForwardExecType::Continue:
+                    result = value > result ? value : result;
+                    break;
+
+                default:
+                    break;
+                }
+            }
+
+            return static_cast<TRet>(result);
+        }
+
+    private:
+        struct Target
+        {
+            Amx* amx;
+            int forward;
+        };
+
+        template <std::size_t... I>
+        static cell Execute(const int forward, [[maybe_unused]] const cell* const params, std::index_sequence<I...>)
+        {
+            return ExecuteForward(forward, params[I]...);
+        }
+
+        std::vector<Target> targets_{};
+        ForwardExecType exec_type_{ForwardExecType::Ignore};
+        AmxError error_{AmxError::None};
+    };
+}
@@ -0,0 +1,142 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+//
+// Worker threads for work that does not need the core, and a completion queue back to the game thread.
+// Work runs on a pool of threads with a queue each; idle workers steal from the others. Completions are
+// queued from any thread and run by RunTaskCompletions, which the module calls once per frame on the game
+// thread (e.g. from its StartFrame hook); only there may they call ExecuteForward, AmxExec and the rest of
+// the API. Debug builds assert on API calls from other threads.
+// Built only when the library is configured with AMXX_TASK_POOL ON; the pool is stopped on AMXX_Detach.
+//
+
+namespace amxx
+{
+    /**
+     * @brief Move-only \c void() callable.
+    */
+    class Task
+    {
+    public:
+        Task() = default;
+
+        template <typename TFunc, typename = std::enable_if_t<!std::is_same_v<std::decay_t<TFunc>, Task>>>
+        // ReSharper disable once CppNonExplicitConvertingConstructor
+        Task(TFunc&& func) // NOLINT(google-explicit-constructor)
+            : callable_(std::make_unique<Callable<std::decay_t<TFunc>>>(std::forward<TFunc>(func)))
+        {
+        }
+
+        void operator()() const
+        {
+            callable_->Call();
+        }
+
+        explicit operator bool() const
+        {
+            return callable_ != nullptr;
+        }
+
+    private:
+        struct Base
+        {
+            virtual ~Base() = default;
+            virtual void Call() = 0;
+        };
+
+        template <typename TFunc>
+        struct Callable final : Base
+        {
+            template <typename TArg>
+            explicit Callable(TArg&& arg)
+                : func(std::forward<TArg>(arg))
+            {
+            }
+
+            void Call() override
+            {
+                func();
+            }
+
+            TFunc func;
+        };
+
+        std::unique_ptr<Base> callable_{};
+    };
+
+    /**
+     * @brief Starts \c threads workers; 0 uses one less than the number of hardware threads.
+    */
+    bool StartTaskPool(unsigned threads = 0);
+
+    /**
+     * @brief Finishes the queued work and joins the workers; completions still queued are dropped.
+     * Called from \c AMXX_Detach.
+    */
+    void StopTaskPool();
+
+    /**
+     * @brief True between \c StartTaskPool and \c StopTaskPool.
+    */
+    bool TaskPoolRunning();
+
+    /**
+     * @brief Number of worker threads; 0 when the pool is not running.
+    */
+    std::size_t TaskPoolSize();
+
+    /**
+     * @brief Queues \c work for a worker; without a running pool it runs right away on the calling thread.
+    */
+    void SubmitTask(Task work);
+
+    /**
+     * @brief Queues \c completion for the next \c RunTaskCompletions; callable from any thread.
+    */
+    void PostToGameThread(Task completion);
+
+    /**
+     * @brief Runs \c work on a worker, then \c done on the game thread with the result of \c work, if any.
+    */
+    template <typename TWork, typename TDone>
+    void SubmitTask(TWork&& work, TDone&& done)
+    {
+        SubmitTask([work = std::forward<TWork>(work), done = std::forward<TDone>(done)]() mutable {
+            if constexpr (std::is_void_v<std::invoke_result_t<TWork&>>) {
+                work();
+                PostToGameThread(std::move(done));
+            }
+            else {
+                PostToGameThread([done = std::move(done), result = work()]() mutable { done(std::move(result)); });
+            }
+        });
+    }
+
+    /**
+     * @brief Runs up to \c max_completions queued completions in order; call it on the game thread once per frame.
+     * Returns the number that ran.
+    */
+    std::size_t RunTaskCompletions(std::size_t max_completions = SIZE_MAX);
+}
@@ -0,0 +1,142 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/cycle_clock.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+//
+// Timeline tracing in the Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+// Built only when the library is configured with AMXX_TRACE ON; ExecuteForward, AmxExec, AmxExecV, the module
+// callbacks and, with AMXX_NATIVE_STATS, the instrumented natives then record a slice each. Slices go to a ring
+// buffer of the calling thread, so the newest TRACE_BUFFER_EVENTS of each thread are kept until written out.
+// Each ring has a single writer and no lock; writing the trace copies a snapshot while the threads keep running.
+//
+
+namespace amxx
+{
+    /**
+     * @brief Slices kept per thread.
+    */
+    constexpr std::size_t TRACE_BUFFER_EVENTS = 65536;
+
+    /**
+     * @brief Forward ids above this are traced without their name.
+    */
+    constexpr int MAX_TRACED_FORWARDS = 4096;
+
+    namespace detail
+    {
+        inline std::atomic<bool> trace_enabled{true};
+    }
+
+    /**
+     * @brief Records a slice that ran from \c start to \c end (\c CycleClock ticks) on the calling thread.
+     * \c name and \c category must outlive the trace: literals or strings from \c TraceIntern.
+    */
+    void TraceComplete(const char* name, const char* category, std::uint64_t start, std::uint64_t end);
+
+    /**
+     * @brief Returns a copy of \c name that lives as long as the module.
+    */
+    const char* TraceIntern(std::string_view name);
+
+    /**
+     * @brief "plugin.amxx::public" name of the public \c index of \c amx, cached per thread.
+     * Returns a placeholder without looking anything up while recording is paused.
+    */
+    const char* TracePublicName(const Amx* amx, int index);
+
+    /**
+     * @brief Names the forward \c id in the trace; called by the \c RegisterForward wrappers.
+    */
+    void SetTraceForwardName(int id, const char* name);
+
+    /**
+     * @brief Name recorded for the forward \c id, or "forward" if it has none.
+    */
+    const char* TraceForwardName(int id);
+
+    /**
+     * @brief Forgets the cached plugin and forward names; called before the plugins are unloaded.
+    */
+    void ResetTraceNames();
+
+    /**
+     * @brief Names the calling thread in the trace.
+    */
+    void SetTraceThreadName(const char* name);
+
+    /**
+     * @brief Pauses or resumes recording.
+    */
+    inline void SetTraceEnabled(const bool enabled)
+    {
+        detail::trace_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief True while tracing is on; a relaxed load, cheap enough for every traced call.
+    */
+    inline bool TraceEnabled()
+    {
+        return detail::trace_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Writes the slices of every thread to \c path as a Chrome JSON trace; returns false if the file
+     * cannot be written. The buffers are left as they are.
+    */
+    bool WriteChromeTrace(const char* path);
+
+    /**
+     * @brief Empties the buffers of every thread.
+    */
+    void ClearTrace();
+
+    /**
+     * @brief Records a slice for its own lifetime.
+    */
+    class TraceScope
+    {
+    public:
+        TraceScope(const char* const name, const char* const category)
+            : name_(name), category_(category), start_(TraceEnabled() ? CycleClock::Now() : 0)
+        {
+        }
+
+        ~TraceScope()
+        {
+            if (start_) {
+                TraceComplete(name_, category_, start_, CycleClock::Now());
+            }
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        const char* name_;
+        const char* category_;
+        std::uint64_t start_;
+    };
+}
@@ -0,0 +1,210 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/amx_debug.h>
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    /**
+     * @brief Symbol kind of a function in the symbol table.
+    */
+    constexpr char IDENT_FUNCTION = 9;
+
+    /**
+     * @brief Bounds-checked reader over the debug information.
+    */
+    class Reader
+    {
+    public:
+        Reader(const unsigned char* const data, const std::size_t size)
+            : data_(data), size_(size)
+        {
+        }
+
+        template <typename T>
+        bool Read(T& value)
+        {
+            if (size_ - offset_ < sizeof(T)) {
+                return false;
+            }
+
+            std::memcpy(&value, data_ + offset_, sizeof(T));
+            offset_ += sizeof(T);
+
+            return true;
+        }
+
+        bool ReadString(std::string& value)
+        {
+            const auto* const begin = reinterpret_cast<const char*>(data_ + offset_);
+            const auto* const end = static_cast<const char*>(std::memchr(begin, '\0', size_ - offset_));
+
+            if (!end) {
+                return false;
+            }
+
+            value.assign(begin, end);
+            offset_ += value.size() + 1;
+
+            return true;
+        }
+
+        bool Skip(const std::size_t size)
+        {
+            if (size_ - offset_ < size) {
+                return false;
+            }
+
+            offset_ += size;
+            return true;
+        }
+
+    private:
+        const unsigned char* data_;
+        std::size_t size_;
+        std::size_t offset_{};
+    };
+}
+
+namespace amx
+{
+    bool DebugInfo::Parse(const unsigned char* const data, const std::size_t size)
+    {
+        Clear();
+
+        Reader reader{data, size};
+        DebugHeader header{};
+
+        if (!reader.Read(header) || header.magic != AMX_DBG_MAGIC || header.size < static_cast<std::int32_t>(sizeof(header)) ||
+            static_cast<std::size_t>(header.size) > size) {
+            return false;
+        }
+
+        reader = Reader{data, static_cast<std::size_t>(header.size)};
+        reader.Skip(sizeof(header));
+
+        const auto fail = [this] {
+            Clear();
+            return false;
+        };
+
+        for (auto i = 0; i < header.files; ++i) {
+            auto& file = files_.emplace_back();
+
+            if (!reader.Read(file.address) || !reader.ReadString(file.name)) {
+                return fail();
+            }
+        }
+
+        for (auto i = 0; i < header.lines; ++i) {
+            auto& line = lines_.emplace_back();
+
+            if (!reader.Read(line.address) || !reader.Read(line.line)) {
+                return fail();
+            }
+        }
+
+        for (auto i = 0; i < header.symbols; ++i) {
+            ucell address{};
+            std::int16_t tag{};
+            ucell start{};
+            ucell end{};
+            char ident{};
+            char var_class{};
+            std::int16_t dimensions{};
+            std::string name{};
+
+            if (!reader.Read(address) || !reader.Read(tag) || !reader.Read(start) || !reader.Read(end) ||
+                !reader.Read(ident) || !reader.Read(var_class) || !reader.Read(dimensions) || !reader.ReadString(name) ||
+                !reader.Skip(static_cast<std::size_t>(std::max<std::int16_t>(dimensions, 0)) *
+                             (sizeof(std::int16_t) + sizeof(ucell)))) {
+                return fail();
+            }
+
+            if (ident == IDENT_FUNCTION && start < end) {
+                functions_.push_back({start, end, std::move(name)});
+            }
+        }
+
+        const auto by_start = [](const auto& a, const auto& b) { return a.start < b.start; };
+        const auto by_address = [](const auto& a, const auto& b) { return a.address < b.address; };
+
+        std::sort(functions_.begin(), functions_.end(), by_start);
+        std::stable_sort(files_.begin(), files_.end(), by_address);
+        std::stable_sort(lines_.begin(), lines_.end(), by_address);
+
+        return true;
+    }
+
+    bool DebugInfo::ParseImage(const Amx* const amx)
+    {
+        Clear();
+
+        if (!amx || !amx->base || amx->data) {
+            return false;
+        }
+
+        AmxHeader header{};
+        std::memcpy(&header, amx->base, sizeof(header));
+
+        // The image memory ends at the stack top; the debug information must fit below it.
+        if (!(header.flags & AMX_FLAG_DEBUG) || header.size <= 0 || header.stp <= header.size) {
+            return false;
+        }
+
+        return Parse(amx->base + header.size, static_cast<std::size_t>(header.stp - header.size));
+    }
+
+    void DebugInfo::Clear()
+    {
+        functions_.clear();
+        files_.clear();
+        lines_.clear();
+    }
+
+    const char* DebugInfo::FunctionAt(const ucell address) const
+    {
+        // Functions do not nest, so only the last one starting at or before the address can contain it.
+        auto it = std::upper_bound(functions_.begin(), functions_.end(), address,
+                                   [](const ucell value, const Function& function) { return value < function.start; });
+
+        if (it == functions_.begin() || address >= (--it)->end) {
+            return nullptr;
+        }
+
+        return it->name.c_str();
+    }
+
+    const char* DebugInfo::FileAt(const ucell address) const
+    {
+        auto it = std::upper_bound(files_.begin(), files_.end(), address,
+                                   [](const ucell value, const File& file) { return value < file.address; });
+
+        return it == files_.begin() ? nullptr : (--it)->name.c_str();
+    }
+
+    int DebugInfo::LineAt(const ucell address) const
+    {
+        auto it = std::upper_bound(lines_.begin(), lines_.end(), address,
+                                   [](const ucell value, const Line& line) { return value < line.address; });
+
+        // The table is 0-based.
+        return it == lines_.begin() ? 0 : (--it)->line + 1;
+    }
+}
@@ -0,0 +1,376 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/amx_format.h>
+#include <amxx/api.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using namespace amx;
+
+    /**
+     * @brief Plugin formats remembered; a direct-mapped table indexed by script and address.
+    */
+    constexpr std::size_t FORMAT_CACHE_SIZE = 256;
+
+    /**
+     * @brief Largest precision handled without \c snprintf.
+    */
+    constexpr int MAX_FAST_PRECISION = 9;
+
+    class Output
+    {
+    public:
+        Output(char* const buffer, const std::size_t size)
+            : data_(buffer), capacity_(size ? size - 1 : 0)
+        {
+        }
+
+        void Put(const char ch)
+        {
+            if (length_ < capacity_) {
+                data_[length_++] = ch;
+            }
+        }
+
+        void Put(const char* const text, const std::size_t length)
+        {
+            const auto count = std::min(length, capacity_ - length_);
+            std::memcpy(data_ + length_, text, count);
+            length_ += count;
+        }
+
+        void Put(const cell* const text, const std::size_t length)
+        {
+            const auto count = std::min(length, capacity_ - length_);
+            simd::NarrowCells(data_ + length_, text, count);
+            length_ += count;
+        }
+
+        void Fill(const char ch, std::size_t count)
+        {
+            count = std::min(count, capacity_ - length_);
+            std::memset(data_ + length_, ch, count);
+            length_ += count;
+        }
+
+        std::size_t Finish(const std::size_t size) const
+        {
+            if (size) {
+                data_[length_] = '\0';
+            }
+
+            return length_;
+        }
+
+    private:
+        char* data_;
+        std::size_t capacity_;
+        std::size_t length_{};
+    };
+
+    struct CachedFormat
+    {
+        const Amx* amx{};
+        cell address{};
+        std::string text{};
+        std::vector<FormatSpec> specs{};
+        bool supported{};
+    };
+
+    /**
+     * @brief Game thread only, as is the memory of the plugins.
+    */
+    CachedFormat g_format_cache[FORMAT_CACHE_SIZE]{};
+
+    /**
+     * @brief Writes \c body padded to the width of \c spec; \c sign goes before any zero padding.
+    */
+    void PutPadded(Output& output, const FormatSpec& spec, const char* const sign, const char* const body,
+                   const std::size_t length)
+    {
+        const auto sign_length = std::strlen(sign);
+        const auto total = sign_length + length;
+        const auto padding = spec.width > total ? spec.width - total : 0;
+
+        if (spec.left_align) {
+            output.Put(sign, sign_length);
+            output.Put(body, length);
+            output.Fill(' ', padding);
+        }
+        else if (spec.zero_pad) {
+            output.Put(sign, sign_length);
+            output.Fill('0', padding);
+            output.Put(body, length);
+        }
+        else {
+            output.Fill(' ', padding);
+            output.Put(sign, sign_length);
+            output.Put(body, length);
+        }
+    }
+
+    /**
+     * @brief Writes \c value in \c base into the end of \c digits; returns the first digit.
+    */
+    char* PutDigits(char* end, std::uint64_t value, const unsigned base, const bool upper)
+    {
+        const auto* const alphabet = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+
+        do {
+            *--end = alphabet[value % base];
+            value /= base;
+        } while (value);
+
+        return end;
+    }
+
+    void PutInteger(Output& output, const FormatSpec& spec, const FormatArg& arg)
+    {
+        char digits[65];
+        auto* const end = digits + sizeof(digits);
+        const char* first{};
+        const char* sign = "";
+
+        switch (spec.conversion) {
+        case FormatConversion::Integer:
+            if (arg.integer < 0) {
+                sign = "-";
+                first = PutDigits(end, 0 - static_cast<std::uint64_t>(arg.integer), 10, false);
+            }
+            else {
+                first = PutDigits(end, static_cast<std::uint64_t>(arg.integer), 10, false);
+            }
+
+            break;
+
+        case FormatConversion::Unsigned:
+            first = PutDigits(end, arg.bits, 10, false);
+            break;
+
+        case FormatConversion::Hex:
+        case FormatConversion::HexUpper:
+            first = PutDigits(end, arg.bits, 16, spec.conversion == FormatConversion::HexUpper);
+            break;
+
+        default:
+            first = PutDigits(end, arg.bits, 2, false);
+            break;
+        }
+
+        PutPadded(output, spec, sign, first, static_cast<std::size_t>(end - first));
+    }
+
+    void PutFloat(Output& output, const FormatSpec& spec, const double value)
+    {
+        const auto precision = spec.precision < 0 ? 6 : static_cast<int>(spec.precision);
+        const auto* const sign = std::signbit(value) && value != 0.0 ? "-" : "";
+        const auto magnitude = std::fabs(value);
+
+        if (std::isnan(value) || std::isinf(value)) {
+            PutPadded(output, spec, std::isnan(value) ? "" : sign, std::isnan(value) ? "nan" : "inf", 3);
+            return;
+        }
+
+        std::uint64_t scale = 1;
+
+        for (auto i = 0; i < precision && i < MAX_FAST_PRECISION; ++i) {
+            scale *= 10;
+        }
+
+        // Rounds half away from zero, like the core's %f.
+        const auto scaled = magnitude * static_cast<double>(scale) + 0.5;
+
+        if (precision > MAX_FAST_PRECISION || scaled >= 9.0e18) {
+            char text[400];
+            const auto length = std::snprintf(text, sizeof(text), "%.*f", precision, magnitude);
+            PutPadded(output, spec, sign, text, length > 0 ? std::min(static_cast<std::size_t>(length), sizeof(text) - 1) : 0);
+
+            return;
+        }
+
+        const auto fixed = static_cast<std::uint64_t>(scaled);
+        char text[32];
+        auto* const end = text + sizeof(text);
+        auto* first = end;
+
+        if (precision) {
+            first = PutDigits(end, fixed % scale + scale, 10, false) + 1;
+            *--first = '.';
+        }
+
+        first = PutDigits(first, fixed / scale, 10, false);
+
+        PutPadded(output, spec, fixed ? sign : "", first, static_cast<std::size_t>(end - first));
+    }
+
+    void PutString(Output& output, const FormatSpec& spec, const FormatArg& arg)
+    {
+        const auto length = spec.precision >= 0 ? std::min(arg.length, static_cast<std::size_t>(spec.precision)) : arg.length;
+        const auto padding = spec.width > length ? spec.width - length : 0;
+
+        if (!spec.left_align) {
+            output.Fill(' ', padding);
+        }
+
+        if (arg.kind == FormatArgKind::Cells) {
+            output.Put(arg.cells, length);
+        }
+        else {
+            output.Put(arg.chars, length);
+        }
+
+        if (spec.left_align) {
+            output.Fill(' ', padding);
+        }
+    }
+
+    void PutSpec(Output& output, const std::string_view format, const FormatSpec& spec, const FormatArg& arg)
+    {
+        switch (spec.conversion) {
+        case FormatConversion::Text:
+            output.Put(format.data() + spec.offset, spec.length);
+            break;
+
+        case FormatConversion::Float:
+            PutFloat(output, spec, arg.real);
+            break;
+
+        case FormatConversion::String:
+            PutString(output, spec, arg);
+            break;
+
+        case FormatConversion::Char:
+        {
+            const auto ch = static_cast<char>(arg.integer);
+            PutPadded(output, spec, "", &ch, ch ? 1 : 0);
+            break;
+        }
+
+        case FormatConversion::Unsupported:
+            output.Put(format.data() + spec.offset, spec.length);
+            break;
+
+        default:
+            PutInteger(output, spec, arg);
+            break;
+        }
+    }
+
+    CachedFormat& FindFormat(const Amx* const amx, const cell address)
+    {
+        const auto key = reinterpret_cast<std::uintptr_t>(amx) >> 4 ^ static_cast<std::uintptr_t>(address) * 0x9E3779B9U;
+        auto& entry = g_format_cache[key % FORMAT_CACHE_SIZE];
+        const CellStringView format{Address(amx, address)};
+
+        // The text is compared as well: the format may be a buffer the plugin rewrites between calls.
+        if (entry.amx == amx && entry.address == address && format.Equals(entry.text)) {
+            return entry;
+        }
+
+        entry.amx = amx;
+        entry.address = address;
+        entry.text = format.ToString();
+        entry.specs.resize(ParseFormat(entry.text, nullptr, 0));
+        ParseFormat(entry.text, entry.specs.data(), entry.specs.size());
+        entry.supported = std::none_of(entry.specs.begin(), entry.specs.end(), [](const FormatSpec& spec) {
+            return spec.conversion == FormatConversion::Unsupported;
+        });
+
+        return entry;
+    }
+}
+
+namespace amx
+{
+    std::size_t FormatPieces(char* const buffer, const std::size_t size, const std::string_view format,
+                             const FormatSpec* const specs, const std::size_t count, const FormatArg* const args)
+    {
+        Output output{buffer, size};
+        std::size_t arg = 0;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const auto& spec = specs[i];
+            PutSpec(output, format, spec, spec.conversion == FormatConversion::Text ? FormatArg{} : args[arg++]);
+        }
+
+        return output.Finish(size);
+    }
+
+    std::size_t FormatAmxString(Amx* const amx, cell* const params, const int start_param, char* const buffer,
+                                const std::size_t size)
+    {
+        const auto& format = FindFormat(amx, params[start_param]);
+
+        if (!format.supported) {
+            auto length = 0;
+            const auto* const text = amxx::FormatAmxString(amx, params, start_param, &length);
+            Output output{buffer, size};
+
+            if (text) {
+                output.Put(text, static_cast<std::size_t>(std::max(length, 0)));
+            }
+
+            return output.Finish(size);
+        }
+
+        Output output{buffer, size};
+        const auto param_count = static_cast<int>(params[0] / sizeof(cell));
+        auto param = start_param + 1;
+
+        for (const auto& spec : format.specs) {
+            if (spec.conversion == FormatConversion::Text) {
+                PutSpec(output, format.text, spec, {});
+                continue;
+            }
+
+            if (param > param_count) {
+                amxx::LogError(amx, AmxError::Native, "String formatted incorrectly - parameter %d (total %d)", param,
+                               param_count);
+                break;
+            }
+
+            // Variadic arguments are passed by reference.
+            const auto* const value = Address(amx, params[param++]);
+            FormatArg arg{};
+
+            if (spec.conversion == FormatConversion::Float) {
+                arg.kind = FormatArgKind::Float;
+                arg.real = static_cast<double>(CellToFloat(*value));
+            }
+            else if (spec.conversion == FormatConversion::String) {
+                arg.kind = FormatArgKind::Cells;
+                arg.cells = value;
+                arg.length = simd::CellStringLength(value, spec.precision >= 0 ? static_cast<std::size_t>(spec.precision) : SIZE_MAX);
+            }
+            else {
+                arg.integer = *value;
+                arg.bits = static_cast<ucell>(*value);
+            }
+
+            PutSpec(output, format.text, spec, arg);
+        }
+
+        return output.Finish(size);
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/amx_index.h>
+#include <amxx/plugin_local.h>
+
+namespace
+{
+    /**
+     * @brief Index of each plugin, built on first use.
+    */
+    amxx::PluginLocal<amxx::AmxIndex> g_indices{};
+
+    const char* EntryName(const AmxHeader* const header, const unsigned char* const entry)
+    {
+        // File version 7+ stores names in a name table; older images keep them inline.
+        if (header->definition_size == sizeof(AmxFuncStubNt)) {
+            return reinterpret_cast<const char*>(header) + reinterpret_cast<const AmxFuncStubNt*>(entry)->name_offset;
+        }
+
+        return reinterpret_cast<const AmxFuncStub*>(entry)->name;
+    }
+
+    ucell EntryAddress(const unsigned char* const entry)
+    {
+        return reinterpret_cast<const AmxFuncStubNt*>(entry)->address;
+    }
+}
+
+namespace amxx
+{
+    AmxIndex::AmxIndex(const Amx* const amx)
+        : amx_(amx)
+    {
+        const auto* const header = reinterpret_cast<const AmxHeader*>(amx->base);
+        const auto* const base = amx->base;
+        const auto entry_size = static_cast<std::size_t>(header->definition_size);
+
+        const auto public_count = static_cast<std::size_t>(header->natives - header->publics) / entry_size;
+        const auto native_count = static_cast<std::size_t>(header->libraries - header->natives) / entry_size;
+
+        publics_.names.reserve(public_count);
+        public_addresses_.reserve(public_count);
+
+        for (std::size_t i = 0; i < public_count; ++i) {
+            const auto* const entry = base + header->publics + i * entry_size;
+            publics_.names.push_back(EntryName(header, entry));
+            public_addresses_.push_back(EntryAddress(entry));
+        }
+
+        natives_.names.reserve(native_count);
+
+        for (std::size_t i = 0; i < native_count; ++i) {
+            natives_.names.push_back(EntryName(header, base + header->natives + i * entry_size));
+        }
+
+        publics_.Build();
+        natives_.Build();
+    }
+
+    void AmxIndex::Table::Build()
+    {
+        if (names.empty()) {
+            return;
+        }
+
+        // Power of two, at most half full.
+        std::uint32_t capacity = 4;
+
+        while (capacity < names.size() * 2) {
+            capacity <<= 1;
+        }
+
+        mask = capacity - 1;
+        entries.assign(capacity, {0, -1});
+
+        for (std::size_t i = 0; i < names.size(); ++i) {
+            const auto hash = static_cast<std::uint32_t>(amx::HashString(names[i]));
+            auto slot = hash & mask;
+
+            while (entries[slot].index >= 0) {
+                slot = (slot + 1) & mask;
+            }
+
+            entries[slot] = {hash, static_cast<int>(i)};
+        }
+    }
+
+    const AmxIndex& GetAmxIndex(Amx* const amx)
+    {
+        return g_indices.Get(amx);
+    }
+
+    void ReleaseAmxIndex(Amx* const amx)
+    {
+        g_indices.Reset(amx);
+    }
+
+    void ReleaseAmxIndices()
+    {
+        g_indices.Clear();
+    }
+}
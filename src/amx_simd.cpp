@@ -0,0 +1,849 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/amx.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+
+#if PAWN_CELL_SIZE == 32 && (defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64))
+#define AMX_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AMX_TARGET_SSE2
+#define AMX_TARGET_AVX2
+#define AMX_NO_SANITIZE_ADDRESS __declspec(no_sanitize_address)
+#else
+#define AMX_TARGET_SSE2 __attribute__((target("sse2")))
+#define AMX_TARGET_AVX2 __attribute__((target("avx2")))
+#define AMX_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#endif
+#endif
+
+namespace
+{
+    using CellStringLengthFn = std::size_t (*)(const cell*, std::size_t);
+    using NarrowCellsFn = void (*)(char*, const cell*, std::size_t);
+    using WidenCharsFn = void (*)(cell*, const char*, std::size_t);
+    using WidenBytesFn = void (*)(cell*, const char*, std::size_t);
+    using ValidateUtf8Fn = bool (*)(const char*, std::size_t);
+    using FillCellsFn = void (*)(cell*, cell, std::size_t);
+    using CompareCellsFn = std::size_t (*)(const cell*, const cell*, std::size_t);
+    using FindCellFn = std::size_t (*)(const cell*, cell, std::size_t);
+    using CountCellFn = std::size_t (*)(const cell*, cell, std::size_t);
+
+    struct Kernels
+    {
+        CellStringLengthFn cell_string_length;
+        NarrowCellsFn narrow_cells;
+        WidenCharsFn widen_chars;
+        WidenBytesFn widen_bytes;
+        ValidateUtf8Fn validate_utf8;
+        FillCellsFn fill_cells;
+        CompareCellsFn compare_cells;
+        FindCellFn find_cell;
+        CountCellFn count_cell;
+    };
+
+    /*
+     * -------------------------------------------------------------------------------------------
+     *	Scalar kernels.
+     * -------------------------------------------------------------------------------------------
+     */
+
+    std::size_t CellStringLengthScalar(const cell* const address, const std::size_t max_length)
+    {
+        std::size_t length{0};
+
+        while (length < max_length && address[length]) {
+            ++length;
+        }
+
+        return length;
+    }
+
+    void NarrowCellsScalar(char* const dest, const cell* const src, const std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i) {
+            dest[i] = static_cast<char>(src[i]);
+        }
+    }
+
+    void WidenCharsScalar(cell* const dest, const char* const src, const std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i) {
+            dest[i] = static_cast<cell>(src[i]);
+        }
+    }
+
+    void WidenBytesScalar(cell* const dest, const char* const src, const std::size_t count)
+    {
+        const auto* const bytes = reinterpret_cast<const unsigned char*>(src);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            dest[i] = static_cast<cell>(bytes[i]);
+        }
+    }
+
+    void FillCellsScalar(cell* const dest, const cell value, const std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i) {
+            dest[i] = value;
+        }
+    }
+
+    std::size_t CompareCellsScalar(const cell* const first, const cell* const second, const std::size_t count)
+    {
+        std::size_t i = 0;
+
+        while (i < count && first[i] == second[i]) {
+            ++i;
+        }
+
+        return i;
+    }
+
+    std::size_t FindCellScalar(const cell* const src, const cell value, const std::size_t count)
+    {
+        std::size_t i = 0;
+
+        while (i < count && src[i] != value) {
+            ++i;
+        }
+
+        return i;
+    }
+
+    std::size_t CountCellScalar(const cell* const src, const cell value, const std::size_t count)
+    {
+        std::size_t matches = 0;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            matches += src[i] == value;
+        }
+
+        return matches;
+    }
+
+    /**
+     * @brief Returns the length of the well-formed UTF-8 sequence at \c src, or 0 if it is malformed.
+    */
+    std::size_t Utf8SequenceLength(const unsigned char* const src, const std::size_t remaining)
+    {
+        const auto lead = src[0];
+
+        if (lead < 0x80) {
+            return 1;
+        }
+
+        std::size_t length;
+        unsigned char min = 0x80;
+        unsigned char max = 0xBF;
+
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF) {
+            length = 3;
+            min = lead == 0xE0 ? 0xA0 : 0x80; // Overlong.
+            max = lead == 0xED ? 0x9F : 0xBF; // Surrogates.
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+            min = lead == 0xF0 ? 0x90 : 0x80; // Overlong.
+            max = lead == 0xF4 ? 0x8F : 0xBF; // Above U+10FFFF.
+        }
+        else {
+            return 0;
+        }
+
+        if (remaining < length || src[1] < min || src[1] > max) {
+            return 0;
+        }
+
+        for (std::size_t i = 2; i < length; ++i) {
+            if ((src[i] & 0xC0) != 0x80) {
+                return 0;
+            }
+        }
+
+        return length;
+    }
+
+    bool ValidateUtf8From(const unsigned char* const src, std::size_t index, const std::size_t length)
+    {
+        while (index < length) {
+            const auto sequence = Utf8SequenceLength(src + index, length - index);
+
+            if (!sequence) {
+                return false;
+            }
+
+            index += sequence;
+        }
+
+        return true;
+    }
+
+    bool ValidateUtf8Scalar(const char* const src, const std::size_t length)
+    {
+        return ValidateUtf8From(reinterpret_cast<const unsigned char*>(src), 0, length);
+    }
+
+    /**
+     * @brief Validates the sequences that start in [index, block_end); returns the index after them, or 0 on error.
+    */
+    std::size_t ValidateUtf8Block(const unsigned char* const src, std::size_t index, const std::size_t block_end,
+                                  const std::size_t length)
+    {
+        while (index < block_end) {
+            const auto sequence = Utf8SequenceLength(src + index, length - index);
+
+            if (!sequence) {
+                return 0;
+            }
+
+            index += sequence;
+        }
+
+        return index;
+    }
+
+#ifdef AMX_SIMD_X86
+    inline unsigned CountTrailingZeros(const unsigned value)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, value);
+        return index;
+#else
+        return static_cast<unsigned>(__builtin_ctz(value));
+#endif
+    }
+
+    /*
+     * -------------------------------------------------------------------------------------------
+     *	SSE2 kernels.
+     * -------------------------------------------------------------------------------------------
+     */
+
+    // Aligned loads never cross a page boundary, so reading past the terminator is safe; AddressSanitizer
+    // does not know that and would report strings that end inside a load.
+    AMX_TARGET_SSE2 AMX_NO_SANITIZE_ADDRESS std::size_t CellStringLengthSse2(const cell* const address,
+                                                                             const std::size_t max_length)
+    {
+        if (reinterpret_cast<std::uintptr_t>(address) % sizeof(cell)) {
+            return CellStringLengthScalar(address, max_length);
+        }
+
+        std::size_t i = 0;
+
+        for (; i < max_length && reinterpret_cast<std::uintptr_t>(address + i) % 16; ++i) {
+            if (!address[i]) {
+                return i;
+            }
+        }
+
+        const auto zero = _mm_setzero_si128();
+
+        for (; i < max_length; i += 4) {
+            const auto cells = _mm_load_si128(reinterpret_cast<const __m128i*>(address + i));
+            const auto mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(cells, zero)));
+
+            if (mask) {
+                i += CountTrailingZeros(static_cast<unsigned>(mask));
+                return i < max_length ? i : max_length;
+            }
+        }
+
+        return max_length;
+    }
+
+    AMX_TARGET_SSE2 void NarrowCellsSse2(char* const dest, const cell* const src, const std::size_t count)
+    {
+        const auto low_byte = _mm_set1_epi32(0xFF);
+        std::size_t i = 0;
+
+        for (; i + 16 <= count; i += 16) {
+            const auto* const block = reinterpret_cast<const __m128i*>(src + i);
+            const auto a = _mm_and_si128(_mm_loadu_si128(block + 0), low_byte);
+            const auto b = _mm_and_si128(_mm_loadu_si128(block + 1), low_byte);
+            const auto c = _mm_and_si128(_mm_loadu_si128(block + 2), low_byte);
+            const auto d = _mm_and_si128(_mm_loadu_si128(block + 3), low_byte);
+            const auto bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), bytes);
+        }
+
+        NarrowCellsScalar(dest + i, src + i, count - i);
+    }
+
+    AMX_TARGET_SSE2 void WidenCharsSse2(cell* const dest, const char* const src, const std::size_t count)
+    {
+        const auto zero = _mm_setzero_si128();
+        std::size_t i = 0;
+
+        for (; i + 16 <= count; i += 16) {
+            const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128i lo, hi;
+
+            if constexpr (std::is_signed_v<char>) {
+                lo = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+                hi = _mm_srai_epi16(_mm_unpackhi_epi8(bytes, bytes), 8);
+            }
+            else {
+                lo = _mm_unpacklo_epi8(bytes, zero);
+                hi = _mm_unpackhi_epi8(bytes, zero);
+            }
+
+            auto* const block = reinterpret_cast<__m128i*>(dest + i);
+            _mm_storeu_si128(block + 0, _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16));
+            _mm_storeu_si128(block + 1, _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16));
+            _mm_storeu_si128(block + 2, _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16));
+            _mm_storeu_si128(block + 3, _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16));
+        }
+
+        WidenCharsScalar(dest + i, src + i, count - i);
+    }
+
+    AMX_TARGET_SSE2 void WidenBytesSse2(cell* const dest, const char* const src, const std::size_t count)
+    {
+        const auto zero = _mm_setzero_si128();
+        std::size_t i = 0;
+
+        for (; i + 16 <= count; i += 16) {
+            const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const auto lo = _mm_unpacklo_epi8(bytes, zero);
+            const auto hi = _mm_unpackhi_epi8(bytes, zero);
+
+            auto* const block = reinterpret_cast<__m128i*>(dest + i);
+            _mm_storeu_si128(block + 0, _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128(block + 1, _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128(block + 2, _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128(block + 3, _mm_unpackhi_epi16(hi, zero));
+        }
+
+        WidenBytesScalar(dest + i, src + i, count - i);
+    }
+
+    AMX_TARGET_SSE2 bool ValidateUtf8Sse2(const char* const src, const std::size_t length)
+    {
+        const auto* const bytes = reinterpret_cast<const unsigned char*>(src);
+        std::size_t i = 0;
+
+        while (i + 16 <= length) {
+            if (!_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i)))) {
+                i += 16;
+                continue;
+            }
+
+            if (!(i = ValidateUtf8Block(bytes, i, i + 16, length))) {
+                return false;
+            }
+        }
+
+        return ValidateUtf8From(bytes, i, length);
+    }
+
+    AMX_TARGET_SSE2 void FillCellsSse2(cell* const dest, const cell value, const std::size_t count)
+    {
+        const auto cells = _mm_set1_epi32(value);
+        std::size_t i = 0;
+
+        for (; i + 16 <= count; i += 16) {
+            auto* const block = reinterpret_cast<__m128i*>(dest + i);
+            _mm_storeu_si128(block + 0, cells);
+            _mm_storeu_si128(block + 1, cells);
+            _mm_storeu_si128(block + 2, cells);
+            _mm_storeu_si128(block + 3, cells);
+        }
+
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), cells);
+        }
+
+        FillCellsScalar(dest + i, value, count - i);
+    }
+
+    AMX_TARGET_SSE2 std::size_t CompareCellsSse2(const cell* const first, const cell* const second, const std::size_t count)
+    {
+        std::size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            const auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+            const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + i));
+            const auto mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(a, b)));
+
+            if (mask != 0xF) {
+                return i + CountTrailingZeros(~static_cast<unsigned>(mask));
+            }
+        }
+
+        return i + CompareCellsScalar(first + i, second + i, count - i);
+    }
+
+    AMX_TARGET_SSE2 std::size_t FindCellSse2(const cell* const src, const cell value, const std::size_t count)
+    {
+        const auto needle = _mm_set1_epi32(value);
+        std::size_t i = 0;
+
+        for (; i + 4 <= count; i += 4) {
+            const auto cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            const auto mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(cells, needle)));
+
+            if (mask) {
+                return i + CountTrailingZeros(static_cast<unsigned>(mask));
+            }
+        }
+
+        return i + FindCellScalar(src + i, value, count - i);
+    }
+
+    AMX_TARGET_SSE2 std::size_t CountCellSse2(const cell* const src, const cell value, const std::size_t count)
+    {
+        const auto needle = _mm_set1_epi32(value);
+        auto totals = _mm_setzero_si128();
+        std::size_t i = 0;
+
+        // A match compares as -1, so subtracting the comparison counts it; lanes cannot overflow below 2^34 cells.
+        for (; i + 4 <= count; i += 4) {
+            const auto cells = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            totals = _mm_sub_epi32(totals, _mm_cmpeq_epi32(cells, needle));
+        }
+
+        alignas(16) std::uint32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), totals);
+
+        return std::size_t{lanes[0]} + lanes[1] + lanes[2] + lanes[3] + CountCellScalar(src + i, value, count - i);
+    }
+
+    /*
+     * -------------------------------------------------------------------------------------------
+     *	AVX2 kernels.
+     * -------------------------------------------------------------------------------------------
+     */
+
+    AMX_TARGET_AVX2 AMX_NO_SANITIZE_ADDRESS std::size_t CellStringLengthAvx2(const cell* const address,
+                                                                             const std::size_t max_length)
+    {
+        if (reinterpret_cast<std::uintptr_t>(address) % sizeof(cell)) {
+            return CellStringLengthScalar(address, max_length);
+        }
+
+        std::size_t i = 0;
+
+        for (; i < max_length && reinterpret_cast<std::uintptr_t>(address + i) % 32; ++i) {
+            if (!address[i]) {
+                return i;
+            }
+        }
+
+        const auto zero = _mm256_setzero_si256();
+
+        for (; i < max_length; i += 8) {
+            const auto cells = _mm256_load_si256(reinterpret_cast<const __m256i*>(address + i));
+            const auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(cells, zero)));
+
+            if (mask) {
+                i += CountTrailingZeros(static_cast<unsigned>(mask));
+                return i < max_length ? i : max_length;
+            }
+        }
+
+        return max_length;
+    }
+
+    AMX_TARGET_AVX2 void NarrowCellsAvx2(char* const dest, const cell* const src, const std::size_t count)
+    {
+        const auto low_byte = _mm256_set1_epi32(0xFF);
+        const auto lane_order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        std::size_t i = 0;
+
+        for (; i + 32 <= count; i += 32) {
+            const auto* const block = reinterpret_cast<const __m256i*>(src + i);
+            const auto a = _mm256_and_si256(_mm256_loadu_si256(block + 0), low_byte);
+            const auto b = _mm256_and_si256(_mm256_loadu_si256(block + 1), low_byte);
+            const auto c = _mm256_and_si256(_mm256_loadu_si256(block + 2), low_byte);
+            const auto d = _mm256_and_si256(_mm256_loadu_si256(block + 3), low_byte);
+
+            // Packing works within 128-bit lanes; the permutation restores the source order.
+            const auto bytes = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_permutevar8x32_epi32(bytes, lane_order));
+        }
+
+        NarrowCellsSse2(dest + i, src + i, count - i);
+    }
+
+    AMX_TARGET_AVX2 void WidenCharsAvx2(cell* const dest, const char* const src, const std::size_t count)
+    {
+        std::size_t i = 0;
+
+        for (; i + 32 <= count; i += 32) {
+            auto* const block = reinterpret_cast<__m256i*>(dest + i);
+
+            for (auto j = 0; j < 4; ++j) {
+                const auto bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i + j * 8));
+
+                if constexpr (std::is_signed_v<char>) {
+                    _mm256_storeu_si256(block + j, _mm256_cvtepi8_epi32(bytes));
+                }
+                else {
+                    _mm256_storeu_si256(block + j, _mm256_cvtepu8_epi32(bytes));
+                }
+            }
+        }
+
+        WidenCharsSse2(dest + i, src + i, count - i);
+    }
+
+    AMX_TARGET_AVX2 void WidenBytesAvx2(cell* const dest, const char* const src, const std::size_t count)
+    {
+        std::size_t i = 0;
+
+        for (; i + 32 <= count; i += 32) {
+            auto* const block = reinterpret_cast<__m256i*>(dest + i);
+
+            for (auto j = 0; j < 4; ++j) {
+                const auto bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i + j * 8));
+                _mm256_storeu_si256(block + j, _mm256_cvtepu8_epi32(bytes));
+            }
+        }
+
+        WidenBytesSse2(dest + i, src + i, count - i);
+    }
+
+    AMX_TARGET_AVX2 bool ValidateUtf8Avx2(const char* const src, const std::size_t length)
+    {
+        const auto* const bytes = reinterpret_cast<const unsigned char*>(src);
+        std::size_t i = 0;
+
+        while (i + 32 <= length) {
+            if (!_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i)))) {
+                i += 32;
+                continue;
+            }
+
+            if (!(i = ValidateUtf8Block(bytes, i, i + 32, length))) {
+                return false;
+            }
+        }
+
+        return ValidateUtf8From(bytes, i, length);
+    }
+
+    AMX_TARGET_AVX2 void FillCellsAvx2(cell* const dest, const cell value, const std::size_t count)
+    {
+        const auto cells = _mm256_set1_epi32(value);
+        std::size_t i = 0;
+
+        for (; i + 32 <= count; i += 32) {
+            auto* const block = reinterpret_cast<__m256i*>(dest + i);
+            _mm256_storeu_si256(block + 0, cells);
+            _mm256_storeu_si256(block + 1, cells);
+            _mm256_storeu_si256(block + 2, cells);
+            _mm256_storeu_si256(block + 3, cells);
+        }
+
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), cells);
+        }
+
+        FillCellsSse2(dest + i, value, count - i);
+    }
+
+    AMX_TARGET_AVX2 std::size_t CompareCellsAvx2(const cell* const first, const cell* const second, const std::size_t count)
+    {
+        std::size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            const auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+            const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(second + i));
+            const auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b)));
+
+            if (mask != 0xFF) {
+                return i + CountTrailingZeros(~static_cast<unsigned>(mask));
+            }
+        }
+
+        return i + CompareCellsSse2(first + i, second + i, count - i);
+    }
+
+    AMX_TARGET_AVX2 std::size_t FindCellAvx2(const cell* const src, const cell value, const std::size_t count)
+    {
+        const auto needle = _mm256_set1_epi32(value);
+        std::size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            const auto cells = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            const auto mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(cells, needle)));
+
+            if (mask) {
+                return i + CountTrailingZeros(static_cast<unsigned>(mask));
+            }
+        }
+
+        return i + FindCellSse2(src + i, value, count - i);
+    }
+
+    AMX_TARGET_AVX2 std::size_t CountCellAvx2(const cell* const src, const cell value, const std::size_t count)
+    {
+        const auto needle = _mm256_set1_epi32(value);
+        auto totals = _mm256_setzero_si256();
+        std::size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            const auto cells = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            totals = _mm256_sub_epi32(totals, _mm256_cmpeq_epi32(cells, needle));
+        }
+
+        alignas(32) std::uint32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), totals);
+        std::size_t matches = 0;
+
+        for (const auto lane : lanes) {
+            matches += lane;
+        }
+
+        return matches + CountCellSse2(src + i, value, count - i);
+    }
+
+    amx::simd::Level DetectLevel()
+    {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        const auto max_leaf = info[0];
+
+        __cpuid(info, 1);
+        const bool sse2 = info[3] & (1 << 26);
+        const bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 0x6) == 0x6;
+        bool avx2 = false;
+
+        if (os_avx && max_leaf >= 7) {
+            __cpuidex(info, 7, 0);
+            avx2 = info[1] & (1 << 5);
+        }
+#else
+        __builtin_cpu_init();
+        const bool sse2 = __builtin_cpu_supports("sse2");
+        const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        if (avx2) {
+            return amx::simd::Level::Avx2;
+        }
+
+        return sse2 ? amx::simd::Level::Sse2 : amx::simd::Level::Scalar;
+    }
+#else
+    amx::simd::Level DetectLevel()
+    {
+        return amx::simd::Level::Scalar;
+    }
+#endif
+
+#ifdef AMX_SIMD_X86
+    constexpr Kernels AVX2_KERNELS = {CellStringLengthAvx2, NarrowCellsAvx2, WidenCharsAvx2, WidenBytesAvx2,
+                                      ValidateUtf8Avx2, FillCellsAvx2, CompareCellsAvx2, FindCellAvx2, CountCellAvx2};
+
+    constexpr Kernels SSE2_KERNELS = {CellStringLengthSse2, NarrowCellsSse2, WidenCharsSse2, WidenBytesSse2,
+                                      ValidateUtf8Sse2, FillCellsSse2, CompareCellsSse2, FindCellSse2, CountCellSse2};
+#endif
+
+    constexpr Kernels SCALAR_KERNELS = {CellStringLengthScalar, NarrowCellsScalar,  WidenCharsScalar,
+                                        WidenBytesScalar,       ValidateUtf8Scalar, FillCellsScalar,
+                                        CompareCellsScalar,     FindCellScalar,     CountCellScalar};
+
+    const Kernels* SelectKernels(const amx::simd::Level level)
+    {
+        switch (level) {
+#ifdef AMX_SIMD_X86
+        case amx::simd::Level::Avx2:
+            return &AVX2_KERNELS;
+
+        case amx::simd::Level::Sse2:
+            return &SSE2_KERNELS;
+#endif
+        default:
+            return &SCALAR_KERNELS;
+        }
+    }
+
+    std::size_t CellStringLengthResolve(const cell* address, std::size_t max_length);
+    void NarrowCellsResolve(char* dest, const cell* src, std::size_t count);
+    void WidenCharsResolve(cell* dest, const char* src, std::size_t count);
+    void WidenBytesResolve(cell* dest, const char* src, std::size_t count);
+    bool ValidateUtf8Resolve(const char* src, std::size_t length);
+    void FillCellsResolve(cell* dest, cell value, std::size_t count);
+    std::size_t CompareCellsResolve(const cell* first, const cell* second, std::size_t count);
+    std::size_t FindCellResolve(const cell* src, cell value, std::size_t count);
+    std::size_t CountCellResolve(const cell* src, cell value, std::size_t count);
+
+    constexpr Kernels RESOLVE_KERNELS = {CellStringLengthResolve, NarrowCellsResolve,  WidenCharsResolve,
+                                         WidenBytesResolve,       ValidateUtf8Resolve, FillCellsResolve,
+                                         CompareCellsResolve,     FindCellResolve,     CountCellResolve};
+
+    // Constant-initialized, so the kernels are usable from static constructors of other translation units.
+    // Tables are immutable and published whole through the pointer, so task pool workers never see a torn set.
+    std::atomic<const Kernels*> g_kernels{&RESOLVE_KERNELS};
+    std::atomic<amx::simd::Level> g_active_level{amx::simd::Level::Scalar};
+    amx::simd::Level g_cpu_level = amx::simd::Level::Scalar;
+    std::once_flag g_resolve_once{};
+
+    void Resolve()
+    {
+        std::call_once(g_resolve_once, [] {
+            g_cpu_level = DetectLevel();
+            g_active_level.store(g_cpu_level, std::memory_order_relaxed);
+
+            // A SetLevel racing with the first resolve wins; only the trampoline table is replaced here.
+            auto* expected = &RESOLVE_KERNELS;
+            g_kernels.compare_exchange_strong(expected, SelectKernels(g_cpu_level), std::memory_order_release);
+        });
+    }
+
+    const Kernels& Active()
+    {
+        return *g_kernels.load(std::memory_order_acquire);
+    }
+
+    std::size_t CellStringLengthResolve(const cell* const address, const std::size_t max_length)
+    {
+        Resolve();
+        return Active().cell_string_length(address, max_length);
+    }
+
+    void NarrowCellsResolve(char* const dest, const cell* const src, const std::size_t count)
+    {
+        Resolve();
+        Active().narrow_cells(dest, src, count);
+    }
+
+    void WidenCharsResolve(cell* const dest, const char* const src, const std::size_t count)
+    {
+        Resolve();
+        Active().widen_chars(dest, src, count);
+    }
+
+    void WidenBytesResolve(cell* const dest, const char* const src, const std::size_t count)
+    {
+        Resolve();
+        Active().widen_bytes(dest, src, count);
+    }
+
+    bool ValidateUtf8Resolve(const char* const src, const std::size_t length)
+    {
+        Resolve();
+        return Active().validate_utf8(src, length);
+    }
+
+    void FillCellsResolve(cell* const dest, const cell value, const std::size_t count)
+    {
+        Resolve();
+        Active().fill_cells(dest, value, count);
+    }
+
+    std::size_t CompareCellsResolve(const cell* const first, const cell* const second, const std::size_t count)
+    {
+        Resolve();
+        return Active().compare_cells(first, second, count);
+    }
+
+    std::size_t FindCellResolve(const cell* const src, const cell value, const std::size_t count)
+    {
+        Resolve();
+        return Active().find_cell(src, value, count);
+    }
+
+    std::size_t CountCellResolve(const cell* const src, const cell value, const std::size_t count)
+    {
+        Resolve();
+        return Active().count_cell(src, value, count);
+    }
+}
+
+namespace amx::simd
+{
+    Level ActiveLevel()
+    {
+        Resolve();
+        return g_active_level.load(std::memory_order_relaxed);
+    }
+
+    Level SetLevel(const Level level)
+    {
+        Resolve();
+
+        const auto active = level < g_cpu_level ? level : g_cpu_level;
+        g_active_level.store(active, std::memory_order_relaxed);
+        g_kernels.store(SelectKernels(active), std::memory_order_release);
+
+        return active;
+    }
+
+    std::size_t CellStringLength(const cell* const address, const std::size_t max_length)
+    {
+        return Active().cell_string_length(address, max_length);
+    }
+
+    void NarrowCells(char* const dest, const cell* const src, const std::size_t count)
+    {
+        Active().narrow_cells(dest, src, count);
+    }
+
+    void WidenChars(cell* const dest, const char* const src, const std::size_t count)
+    {
+        Active().widen_chars(dest, src, count);
+    }
+
+    void WidenBytes(cell* const dest, const char* const src, const std::size_t count)
+    {
+        Active().widen_bytes(dest, src, count);
+    }
+
+    bool ValidateUtf8(const char* const src, const std::size_t length)
+    {
+        return Active().validate_utf8(src, length);
+    }
+
+    void CopyCells(cell* const dest, const cell* const src, const std::size_t count)
+    {
+        // The vectorised memmove of the C library beats anything dispatched here, so copying is not a kernel.
+        std::memmove(dest, src, count * sizeof(cell));
+    }
+
+    void FillCells(cell* const dest, const cell value, const std::size_t count)
+    {
+        Active().fill_cells(dest, value, count);
+    }
+
+    std::size_t CompareCells(const cell* const first, const cell* const second, const std::size_t count)
+    {
+        return Active().compare_cells(first, second, count);
+    }
+
+    std::size_t FindCell(const cell* const src, const cell value, const std::size_t count)
+    {
+        return Active().find_cell(src, value, count);
+    }
+
+    std::size_t CountCell(const cell* const src, const cell value, const std::size_t count)
+    {
+        return Active().count_cell(src, value, count);
+    }
+}
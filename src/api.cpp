@@ -16,11 +16,62 @@
  */
 
 #include <amxx/api.h>
+
+#ifdef AMXX_ASYNC_LOG
+#include <amxx/async_log.h>
+#endif
+
+#ifdef AMXX_ASYNC_NATIVES
+#include <amxx/async_native.h>
+#endif
+
+#ifdef AMXX_PROFILER
+#include <amxx/profiler.h>
+#endif
+
+#ifdef AMXX_TASK_POOL
+#include <amxx/task_pool.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstring>
+#include <string>
+#include <string_view>
 
 // NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
 #define AMXX_API_PTR_PTR(F) (reinterpret_cast<void**>(&amxx::detail::api_funcs.F))
 
+#ifndef AMXX_OPTIONAL_FUNCTIONS
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define AMXX_OPTIONAL_FUNCTIONS
+#endif
+
+namespace
+{
+    /**
+     * @brief API functions the module declared it can run without (AMXX_OPTIONAL_FUNCTIONS in CMake).
+    */
+    constexpr std::string_view OPTIONAL_FUNCTIONS[] = {"", AMXX_OPTIONAL_FUNCTIONS};
+
+    bool IsDeclaredOptional(const std::string_view name)
+    {
+        for (const auto& optional : OPTIONAL_FUNCTIONS) {
+            if (optional == name) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Handlers added by \c amxx::detail::AddUnloadHandler; a handful of subsystems at most.
+    */
+    std::array<amxx::detail::UnloadHandler, 8> g_unload_handlers{};
+}
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 extern "C" amxx::Status DLLEXPORT AMXX_Query(int* interface_version, amxx::ModuleInfo* module_info)
 {
@@ -67,10 +118,18 @@ extern "C" amxx::Status DLLEXPORT AMXX_Attach(const std::add_pointer_t<void*(con
         return amxx::Status::InvalidParameter;
     }
 
+    amxx::detail::on_game_thread = true;
+    amxx::detail::game_thread_known = true;
+
     struct AmxxFuncs
     {
         const char* name;
         void** pointer;
+
+        /**
+         * @brief The module attaches without it; the pointer stays null.
+        */
+        bool optional{};
     } amxx_functions[] = {{"amx_Allot", AMXX_API_PTR_PTR(amx_allot)},
                           {"amx_Exec", AMXX_API_PTR_PTR(amx_exec)},
                           {"amx_Execv", AMXX_API_PTR_PTR(amx_exec_v)},
@@ -148,22 +207,64 @@ extern "C" amxx::Status DLLEXPORT AMXX_Attach(const std::add_pointer_t<void*(con
                           {"UnregisterSPForward", AMXX_API_PTR_PTR(unregister_sp_forward)},
 
 #ifndef AMXX_182_COMPATIBILITY
-                          {"GetAmxStringNull", AMXX_API_PTR_PTR(get_amx_string_null)},
-                          {"GetAmxVectorNull", AMXX_API_PTR_PTR(get_amx_vector_null)},
-                          {"GetConfigManager", AMXX_API_PTR_PTR(get_config_manager)},
-                          {"LoadAmxScriptEx", AMXX_API_PTR_PTR(load_amx_script_ex)},
-                          {"SetAmxStringUTF8Cell", AMXX_API_PTR_PTR(set_amx_string_utf8_cell)},
-                          {"SetAmxStringUTF8Char", AMXX_API_PTR_PTR(set_amx_string_utf8_char)}
+                          // Added in AMXX 1.8.3; optional, so the module still attaches to older cores.
+                          {"GetAmxStringNull", AMXX_API_PTR_PTR(get_amx_string_null), true},
+                          {"GetAmxVectorNull", AMXX_API_PTR_PTR(get_amx_vector_null), true},
+                          {"GetConfigManager", AMXX_API_PTR_PTR(get_config_manager), true},
+                          {"LoadAmxScriptEx", AMXX_API_PTR_PTR(load_amx_script_ex), true},
+                          {"SetAmxStringUTF8Cell", AMXX_API_PTR_PTR(set_amx_string_utf8_cell), true},
+                          {"SetAmxStringUTF8Char", AMXX_API_PTR_PTR(set_amx_string_utf8_char), true}
 #endif
     };
 
+    // A single pass over the whole table; a miss does not stop it, so the counts are complete.
+    const auto start = std::chrono::steady_clock::now();
+    auto& info = amxx::detail::api_resolve_info;
+    info = {};
+    std::string missing_optional{};
+
     for (const auto& function : amxx_functions) {
-        if ((*function.pointer = request_function(function.name)) == nullptr) {
-            return amxx::Status::FuncNotPresent;
+        if ((*function.pointer = request_function(function.name)) != nullptr) {
+            ++info.resolved;
+        }
+        else if (function.optional || IsDeclaredOptional(function.name)) {
+            ++info.missing_optional;
+            missing_optional += missing_optional.empty() ? ": " : ", ";
+            missing_optional += function.name;
         }
+        else if (!info.missing_required) {
+            info.missing_required = function.name;
+        }
+    }
+
+    info.nanoseconds =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if (info.missing_required) {
+        if (amxx::detail::api_funcs.print_console) {
+            amxx::detail::api_funcs.print_console("[%s] Required AMXX function \"%s\" is not available.\n",
+                                                  amxx::MODULE_LOG_TAG, info.missing_required);
+        }
+
+        return amxx::Status::FuncNotPresent;
+    }
+
+    if (amxx::detail::api_funcs.print_console) {
+        amxx::detail::api_funcs.print_console("[%s] Resolved %d AMXX functions in %lld us; %d optional missing%s.\n",
+                                              amxx::MODULE_LOG_TAG, info.resolved,
+                                              static_cast<long long>(info.nanoseconds / 1000), info.missing_optional,
+                                              missing_optional.c_str());
     }
 
+#ifdef AMXX_TRACE
+    amxx::SetTraceThreadName("main");
+#endif
+
 #ifdef AMXX_ATTACH
+#ifdef AMXX_TRACE
+    const amxx::TraceScope trace_scope{"AMXX_Attach", "module"};
+#endif
+
     return AMXX_ATTACH();
 #else
     return amxx::Status::Ok;
@@ -177,12 +278,24 @@ extern "C" amxx::Status DLLEXPORT AMXX_Detach()
     AMXX_DETACH();
 #endif
 
+#ifdef AMXX_TASK_POOL
+    amxx::StopTaskPool();
+#endif
+
+#ifdef AMXX_ASYNC_LOG
+    amxx::StopAsyncLog();
+#endif
+
     return amxx::Status::Ok;
 }
 
 // NOLINTNEXTLINE(readability-identifier-naming)
 extern "C" amxx::Status DLLEXPORT AMXX_PluginsLoaded() //-V524
 {
+#ifdef AMXX_TRACE
+    const amxx::TraceScope trace_scope{"AMXX_PluginsLoaded", "module"};
+#endif
+
 #ifdef AMXX_PLUGINS_LOADED
     AMXX_PLUGINS_LOADED();
 #endif
@@ -193,6 +306,10 @@ extern "C" amxx::Status DLLEXPORT AMXX_PluginsLoaded() //-V524
 // NOLINTNEXTLINE(readability-identifier-naming)
 extern "C" void DLLEXPORT AMXX_PluginsUnloaded()
 {
+#ifdef AMXX_TRACE
+    const amxx::TraceScope trace_scope{"AMXX_PluginsUnloaded", "module"};
+#endif
+
 #ifdef AMXX_PLUGINS_UNLOADED
     AMXX_PLUGINS_UNLOADED();
 #endif
@@ -201,13 +318,59 @@ extern "C" void DLLEXPORT AMXX_PluginsUnloaded()
 // NOLINTNEXTLINE(readability-identifier-naming)
 extern "C" void DLLEXPORT AMXX_PluginsUnloading()
 {
+#ifdef AMXX_TRACE
+    const amxx::TraceScope trace_scope{"AMXX_PluginsUnloading", "module"};
+#endif
+
 #ifdef AMXX_PLUGINS_UNLOADING
     AMXX_PLUGINS_UNLOADING();
 #endif
+
+#ifdef AMXX_NATIVE_STATS
+    amxx::DumpNativeStats();
+    amxx::ResetNativeStats();
+#endif
+
+#ifdef AMXX_TRACE
+    amxx::ResetTraceNames();
+#endif
+
+#ifdef AMXX_ASYNC_NATIVES
+    amxx::CancelSuspendedCalls();
+#endif
+
+#ifdef AMXX_PROFILER
+    amxx::StopProfiling();
+#endif
+
+    for (const auto handler : g_unload_handlers) {
+        if (handler) {
+            handler();
+        }
+    }
 }
 
 namespace amxx
 {
+    namespace detail
+    {
+        void AddUnloadHandler(const UnloadHandler handler)
+        {
+            const auto end = g_unload_handlers.end();
+
+            if (std::find(g_unload_handlers.begin(), end, handler) != end) {
+                return;
+            }
+
+            const auto free = std::find(g_unload_handlers.begin(), end, nullptr);
+            assert(free != end && "too many unload handlers");
+
+            if (free != end) {
+                *free = handler;
+            }
+        }
+    }
+
     const char* FilenameFromPath(const char* const path)
     {
         if (!path) {
@@ -0,0 +1,374 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_ASYNC_LOG
+
+#include <amxx/async_log.h>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+    using namespace amxx;
+    using detail::AsyncLogRecord;
+
+    /**
+     * @brief Call sites and plugins tracked by the rate limiter; further ones are not limited.
+    */
+    constexpr std::size_t RATE_LIMIT_SOURCES = 256;
+
+    /**
+     * @brief How long the writer sleeps when the ring is empty.
+    */
+    constexpr std::chrono::milliseconds IDLE_SLEEP{10};
+
+    struct RateLimit
+    {
+        std::atomic<const void*> source{};
+        std::atomic<std::int64_t> second{};
+        std::atomic<std::uint32_t> count{};
+        std::atomic<std::uint32_t> suppressed{};
+    };
+
+    struct Logger
+    {
+        std::unique_ptr<AsyncLogRecord[]> records{};
+        std::size_t mask{};
+        std::atomic<std::size_t> enqueue_position{};
+        RateLimit limits[RATE_LIMIT_SOURCES]{};
+        std::atomic<std::uint64_t> queue_drops{};
+        std::uint32_t messages_per_second{};
+        std::chrono::milliseconds flush_interval{};
+        std::FILE* file{};
+        std::thread thread{};
+        std::atomic<bool> stop{};
+
+        //
+        // Writer thread only.
+        //
+
+        std::size_t dequeue_position{};
+        const void* last_source{};
+        bool last_error{};
+        std::string last_plugin{};
+        std::string last_text{};
+        std::uint64_t repeats{};
+
+        /**
+         * @brief Last message of each source, quoted in the rate limit notices.
+        */
+        std::unordered_map<const void*, std::string> source_texts{};
+    };
+
+    std::unique_ptr<Logger> g_logger{};
+    std::atomic<std::uint64_t> g_dropped{};
+
+    std::int64_t CurrentSecond()
+    {
+        return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    RateLimit* FindRateLimit(Logger& logger, const void* const source)
+    {
+        const auto start = (reinterpret_cast<std::uintptr_t>(source) >> 4) % RATE_LIMIT_SOURCES;
+
+        for (std::size_t i = 0; i < RATE_LIMIT_SOURCES; ++i) {
+            auto& limit = logger.limits[(start + i) % RATE_LIMIT_SOURCES];
+            const void* key = limit.source.load(std::memory_order_acquire);
+
+            if (!key && limit.source.compare_exchange_strong(key, source, std::memory_order_acq_rel)) {
+                key = source;
+            }
+
+            if (key == source) {
+                return &limit;
+            }
+        }
+
+        return nullptr;
+    }
+
+    bool Admit(Logger& logger, const void* const source)
+    {
+        auto* const limit = FindRateLimit(logger, source);
+
+        if (!limit) {
+            return true;
+        }
+
+        // Fixed one-second windows; whoever moves the window on resets the count.
+        const auto second = CurrentSecond();
+
+        if (auto current = limit->second.load(std::memory_order_relaxed);
+            current != second && limit->second.compare_exchange_strong(current, second, std::memory_order_relaxed)) {
+            limit->count.store(0, std::memory_order_relaxed);
+        }
+
+        if (limit->count.fetch_add(1, std::memory_order_relaxed) < logger.messages_per_second) {
+            return true;
+        }
+
+        limit->suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void WriteLine(const Logger& logger, const std::time_t time, const char* const plugin, const char* const text)
+    {
+        std::tm local{};
+
+#ifdef _WIN32
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+
+        char date[32];
+        std::strftime(date, sizeof(date), "%m/%d/%Y - %H:%M:%S", &local);
+
+        std::fprintf(logger.file, "L %s: ", date);
+
+        if (*MODULE_LOG_TAG) {
+            std::fprintf(logger.file, "[%s] ", MODULE_LOG_TAG);
+        }
+
+        if (plugin) {
+            std::fprintf(logger.file, "[%s] ", plugin);
+        }
+
+        std::fprintf(logger.file, "%s\n", text);
+    }
+
+    void FlushRepeats(Logger& logger)
+    {
+        if (!logger.repeats) {
+            return;
+        }
+
+        const auto text = "Last message repeated " + std::to_string(logger.repeats) + " times";
+        WriteLine(logger, std::time(nullptr), logger.last_error ? logger.last_plugin.c_str() : nullptr, text.c_str());
+        logger.repeats = 0;
+    }
+
+    void Write(Logger& logger, const AsyncLogRecord& record)
+    {
+        // Identical consecutive messages are counted and written once.
+        if (record.source == logger.last_source && record.error == logger.last_error && logger.last_text == record.text) {
+            ++logger.repeats;
+            return;
+        }
+
+        FlushRepeats(logger);
+        WriteLine(logger, static_cast<std::time_t>(record.time), record.error ? record.plugin : nullptr, record.text);
+
+        logger.last_source = record.source;
+        logger.last_error = record.error;
+        logger.last_plugin = record.plugin;
+        logger.last_text = record.text;
+        logger.source_texts[record.source] = record.text;
+    }
+
+    bool Drain(Logger& logger)
+    {
+        auto drained = false;
+
+        for (;;) {
+            auto& record = logger.records[logger.dequeue_position & logger.mask];
+
+            if (record.sequence.load(std::memory_order_acquire) != logger.dequeue_position + 1) {
+                return drained;
+            }
+
+            Write(logger, record);
+
+            // Free the slot for the producer one lap ahead.
+            record.sequence.store(logger.dequeue_position + logger.mask + 1, std::memory_order_release);
+            ++logger.dequeue_position;
+            drained = true;
+        }
+    }
+
+    void WriteNotices(Logger& logger)
+    {
+        FlushRepeats(logger);
+
+        for (auto& limit : logger.limits) {
+            const auto suppressed = limit.suppressed.exchange(0, std::memory_order_relaxed);
+
+            if (!suppressed) {
+                continue;
+            }
+
+            auto text = std::to_string(suppressed) + " messages suppressed by the rate limit";
+
+            if (const auto it = logger.source_texts.find(limit.source.load(std::memory_order_relaxed));
+                it != logger.source_texts.end()) {
+                text += ", last: " + it->second;
+            }
+
+            WriteLine(logger, std::time(nullptr), nullptr, text.c_str());
+        }
+
+        if (const auto drops = logger.queue_drops.exchange(0, std::memory_order_relaxed)) {
+            const auto text = std::to_string(drops) + " messages dropped, the log queue was full";
+            WriteLine(logger, std::time(nullptr), nullptr, text.c_str());
+        }
+
+        std::fflush(logger.file);
+    }
+
+    void WriterThread(Logger& logger)
+    {
+        auto next_flush = std::chrono::steady_clock::now() + logger.flush_interval;
+
+        while (!logger.stop.load(std::memory_order_acquire)) {
+            if (!Drain(logger)) {
+                std::this_thread::sleep_for(IDLE_SLEEP);
+            }
+
+            if (const auto now = std::chrono::steady_clock::now(); now >= next_flush) {
+                WriteNotices(logger);
+                next_flush = now + logger.flush_interval;
+            }
+        }
+    }
+}
+
+namespace amxx
+{
+    bool StartAsyncLog(const char* const path, const AsyncLogOptions& options)
+    {
+        if (g_logger || !path) {
+            return false;
+        }
+
+        auto* const file = std::fopen(path, "a");
+
+        if (!file) {
+            return false;
+        }
+
+        std::size_t size = 2;
+
+        while (size < options.queue_size) {
+            size <<= 1;
+        }
+
+        auto logger = std::make_unique<Logger>();
+        logger->records = std::make_unique<AsyncLogRecord[]>(size);
+        logger->mask = size - 1;
+        logger->messages_per_second = options.messages_per_second;
+        logger->flush_interval = std::chrono::milliseconds{options.flush_interval_ms};
+        logger->file = file;
+
+        // A slot is free for the producer at position p when its sequence is p, and ready to read when it is p + 1.
+        for (std::size_t i = 0; i < size; ++i) {
+            logger->records[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        g_logger = std::move(logger);
+        g_dropped.store(0, std::memory_order_relaxed);
+        g_logger->thread = std::thread{WriterThread, std::ref(*g_logger)};
+        detail::async_log_running.store(true, std::memory_order_release);
+
+        return true;
+    }
+
+    void StopAsyncLog()
+    {
+        if (!g_logger) {
+            return;
+        }
+
+        detail::async_log_running.store(false, std::memory_order_release);
+        g_logger->stop.store(true, std::memory_order_release);
+
+        if (g_logger->thread.joinable()) {
+            g_logger->thread.join();
+        }
+
+        // Whatever is still queued is written synchronously.
+        Drain(*g_logger);
+        WriteNotices(*g_logger);
+
+        std::fclose(g_logger->file);
+        g_logger.reset();
+    }
+
+    std::uint64_t AsyncLogDropped()
+    {
+        return g_dropped.load(std::memory_order_relaxed);
+    }
+
+    namespace detail
+    {
+        AsyncLogRecord* AcquireLogRecord(const void* const source, const bool error)
+        {
+            auto* const logger = g_logger.get();
+
+            if (!logger) {
+                return nullptr;
+            }
+
+            if (!Admit(*logger, source)) {
+                g_dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            auto position = logger->enqueue_position.load(std::memory_order_relaxed);
+
+            for (;;) {
+                auto& record = logger->records[position & logger->mask];
+                const auto sequence = record.sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+                if (difference == 0) {
+                    if (logger->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        record.position = position;
+                        record.source = source;
+                        record.time = static_cast<std::int64_t>(std::time(nullptr));
+                        record.error = error;
+                        record.plugin[0] = '\0';
+                        record.text[0] = '\0';
+
+                        return &record;
+                    }
+                }
+                else if (difference < 0) {
+                    // The writer is a full lap behind: drop rather than wait.
+                    logger->queue_drops.fetch_add(1, std::memory_order_relaxed);
+                    g_dropped.fetch_add(1, std::memory_order_relaxed);
+
+                    return nullptr;
+                }
+                else {
+                    position = logger->enqueue_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void PublishLogRecord(AsyncLogRecord* const record)
+        {
+            record->sequence.store(record->position + 1, std::memory_order_release);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,238 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_ASYNC_NATIVES
+
+#include <amxx/async_native.h>
+#include <amxx/api.h>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    using namespace amxx;
+
+    /**
+     * @brief State of a suspended call, as the interpreter saved it before calling the native.
+     * Publics of the script that run before the call is resumed overwrite \c Amx::cip, so it is kept here.
+    */
+    struct Suspension
+    {
+        Amx* amx;
+        std::uint64_t ticket;
+
+        /**
+         * @brief Frame of the script when \c AmxExecSuspendable started the public.
+        */
+        cell entry_frm;
+
+        cell cip;
+        cell frm;
+        cell stk;
+        cell hea;
+    };
+
+    /**
+     * @brief A public run by \c AmxExecSuspendable, or resumed, that has not returned yet.
+    */
+    struct SuspendableCall
+    {
+        Amx* amx;
+        cell entry_frm;
+    };
+
+    /**
+     * @brief Game thread only.
+    */
+    std::vector<Suspension> g_suspensions{};
+
+    /**
+     * @brief Innermost last; game thread only.
+    */
+    std::vector<SuspendableCall> g_suspendable_calls{};
+
+    std::uint64_t g_last_ticket{};
+    AmxResumeHandler g_resume_handler{};
+
+    std::vector<Suspension>::iterator FindSuspension(const Amx* const amx)
+    {
+        return std::find_if(g_suspensions.begin(), g_suspensions.end(),
+                            [amx](const Suspension& suspension) { return suspension.amx == amx; });
+    }
+
+    /**
+     * @brief True if no public of \c amx is running and nothing is on its heap, counting the arguments pushed.
+    */
+    bool AmxIdle(const Amx* const amx)
+    {
+        const auto pushed = static_cast<cell>(amx->param_count * sizeof(cell));
+        return amx->hea == amx->hlw && amx->stk + pushed == amx->stp;
+    }
+
+    /**
+     * @brief Walks the frames of the native being called up to the first one that returns to address 0, i.e.
+     * the public that \c AmxExec started, and returns the frame it was started with; -1 on a corrupt chain.
+    */
+    cell EntryFrame(const Amx* const amx)
+    {
+        const auto* const header = reinterpret_cast<const AmxHeader*>(amx->base);
+        const auto* const data = amx->data ? amx->data : amx->base + header->dat;
+        auto frame = amx->frm;
+
+        while (frame >= 0 && frame + static_cast<cell>(2 * sizeof(cell)) <= amx->stp) {
+            cell caller_frame{};
+            cell return_address{};
+            std::memcpy(&caller_frame, data + frame, sizeof(cell));
+            std::memcpy(&return_address, data + frame + sizeof(cell), sizeof(cell));
+
+            if (return_address == 0) {
+                return caller_frame;
+            }
+
+            // The stack grows down, so callers sit higher; anything else is a corrupt chain.
+            if (caller_frame <= frame) {
+                break;
+            }
+
+            frame = caller_frame;
+        }
+
+        return -1;
+    }
+
+    /**
+     * @brief True if the native being called runs straight from the innermost public of \c AmxExecSuspendable,
+     * not from a public that a native of it ran in turn.
+    */
+    bool InSuspendableCall(const Amx* const amx)
+    {
+        if (g_suspendable_calls.empty() || g_suspendable_calls.back().amx != amx) {
+            return false;
+        }
+
+        return EntryFrame(amx) == g_suspendable_calls.back().entry_frm;
+    }
+
+    /**
+     * @brief Runs \c index of \c amx (or continues it with \c AMX_EXEC_CONT) as a suspendable call.
+    */
+    AmxError ExecSuspendable(Amx* const amx, cell* const return_val, const int index, const cell entry_frm)
+    {
+        g_suspendable_calls.push_back({amx, entry_frm});
+        const auto error = static_cast<AmxError>(AmxExec(amx, return_val, index));
+        g_suspendable_calls.pop_back();
+
+        return error;
+    }
+}
+
+namespace amxx
+{
+    namespace detail
+    {
+        std::uint64_t SuspendAmx(Amx* const amx)
+        {
+            assert(IsGameThread() || !game_thread_known);
+
+            // Nothing would wake the plugin up, or a second sleep would reuse the stack of the first.
+            if (!TaskPoolRunning() || FindSuspension(amx) != g_suspensions.end()) {
+                return 0;
+            }
+
+            // The core would log the sleep as an error and free the heap the public reads after resuming.
+            if (!InSuspendableCall(amx)) {
+                return 0;
+            }
+
+            const auto ticket = ++g_last_ticket;
+            const auto entry_frm = g_suspendable_calls.back().entry_frm;
+            g_suspensions.push_back({amx, ticket, entry_frm, amx->cip, amx->frm, amx->stk, amx->hea});
+            RaiseAmxError(amx, AmxError::Sleep);
+
+            return ticket;
+        }
+
+        bool AmxSuspended(const Amx* const amx, const std::uint64_t ticket)
+        {
+            const auto it = FindSuspension(amx);
+            return it != g_suspensions.end() && it->ticket == ticket;
+        }
+
+        void ResumeAmx(Amx* const amx, const std::uint64_t ticket, const cell result)
+        {
+            const auto it = FindSuspension(amx);
+
+            if (it == g_suspensions.end() || it->ticket != ticket) {
+                return;
+            }
+
+            // PRI holds the return value of the native once the plugin continues; ALT is not
+            // preserved across calls by the compiler. reset_stk and reset_hea are only written on sleep.
+            amx->cip = it->cip;
+            amx->frm = it->frm;
+            amx->stk = it->stk;
+            amx->hea = it->hea;
+            amx->pri = result;
+
+            const auto entry_frm = it->entry_frm;
+            g_suspensions.erase(it);
+
+            cell return_val{};
+            const auto error = ExecSuspendable(amx, &return_val, AMX_EXEC_CONT, entry_frm);
+
+            // The plugin went back to sleep in another suspending native.
+            if (error == AmxError::Sleep && IsAmxSuspended(amx)) {
+                return;
+            }
+
+            if (g_resume_handler) {
+                g_resume_handler(amx, error, return_val);
+            }
+            else if (error != AmxError::None) {
+                LogError(amx, error, "Error while resuming a suspended call");
+            }
+        }
+    }
+
+    AmxError AmxExecSuspendable(Amx* const amx, cell* const return_val, const int index)
+    {
+        if (!AmxIdle(amx)) {
+            return static_cast<AmxError>(AmxExec(amx, return_val, index));
+        }
+
+        return ExecSuspendable(amx, return_val, index, amx->frm);
+    }
+
+    bool IsAmxSuspended(const Amx* const amx)
+    {
+        return FindSuspension(amx) != g_suspensions.end();
+    }
+
+    void SetAmxResumeHandler(const AmxResumeHandler handler)
+    {
+        g_resume_handler = handler;
+    }
+
+    void CancelSuspendedCalls()
+    {
+        g_suspensions.clear();
+    }
+}
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/cell_natives.h>
+#include <amxx/api.h>
+#include <amxx/cell_span.h>
+
+namespace
+{
+    using namespace amx;
+
+    /**
+     * @brief Checks the parameter count and that \c count cells at each of \c addresses lie in the plugin memory.
+     * Unlike the debug asserts of \c Span, this holds in release builds: the plugin controls every value here.
+    */
+    template <std::size_t N>
+    bool CheckArrays(Amx* const amx, const cell* const params, const cell (&addresses)[N], const cell count)
+    {
+        if (params[0] < static_cast<cell>(3 * sizeof(cell))) {
+            amxx::LogError(amx, AmxError::Native, "Invalid number of parameters (expected %d, got %d).", 3,
+                           static_cast<int>(params[0] / sizeof(cell)));
+            return false;
+        }
+
+        if (count < 0) {
+            amxx::LogError(amx, AmxError::Bounds, "Invalid array size (%d).", count);
+            return false;
+        }
+
+        for (const auto address : addresses) {
+            if (!detail::InPluginMemory(amx, address, static_cast<std::size_t>(count))) {
+                amxx::LogError(amx, AmxError::Bounds, "Array of %d cells is outside of the plugin memory.", count);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // native cell_copy(dest[], const source[], count);
+    cell AMX_NATIVE_CALL CellCopy(Amx* const amx, cell* const params)
+    {
+        if (!CheckArrays(amx, params, {params[1], params[2]}, params[3])) {
+            return 0;
+        }
+
+        simd::CopyCells(Address(amx, params[1]), Address(amx, params[2]), static_cast<std::size_t>(params[3]));
+
+        return params[3];
+    }
+
+    // native cell_fill(array[], value, count);
+    cell AMX_NATIVE_CALL CellFill(Amx* const amx, cell* const params)
+    {
+        if (!CheckArrays(amx, params, {params[1]}, params[3])) {
+            return 0;
+        }
+
+        simd::FillCells(Address(amx, params[1]), params[2], static_cast<std::size_t>(params[3]));
+
+        return params[3];
+    }
+
+    // native cell_compare(const first[], const second[], count);
+    cell AMX_NATIVE_CALL CellCompare(Amx* const amx, cell* const params)
+    {
+        if (!CheckArrays(amx, params, {params[1], params[2]}, params[3])) {
+            return 0;
+        }
+
+        const auto count = static_cast<std::size_t>(params[3]);
+        const auto index = simd::CompareCells(Address(amx, params[1]), Address(amx, params[2]), count);
+
+        return index < count ? static_cast<cell>(index) : -1;
+    }
+
+    // native cell_find(const array[], value, count);
+    cell AMX_NATIVE_CALL CellFind(Amx* const amx, cell* const params)
+    {
+        if (!CheckArrays(amx, params, {params[1]}, params[3])) {
+            return 0;
+        }
+
+        const auto count = static_cast<std::size_t>(params[3]);
+        const auto index = simd::FindCell(Address(amx, params[1]), params[2], count);
+
+        return index < count ? static_cast<cell>(index) : -1;
+    }
+
+    // native cell_count(const array[], value, count);
+    cell AMX_NATIVE_CALL CellCount(Amx* const amx, cell* const params)
+    {
+        if (!CheckArrays(amx, params, {params[1]}, params[3])) {
+            return 0;
+        }
+
+        return static_cast<cell>(simd::CountCell(Address(amx, params[1]), params[2], static_cast<std::size_t>(params[3])));
+    }
+
+    constexpr AmxNativeInfo CELL_ARRAY_NATIVES[] = {
+        {"cell_copy", CellCopy},
+        {"cell_fill", CellFill},
+        {"cell_compare", CellCompare},
+        {"cell_find", CellFind},
+        {"cell_count", CellCount},
+        {nullptr, nullptr}
+    };
+}
+
+namespace amxx
+{
+    const AmxNativeInfo* CellArrayNatives()
+    {
+        return CELL_ARRAY_NATIVES;
+    }
+}
@@ -0,0 +1,357 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_NATIVE_STATS
+
+#include <amxx/api.h>
+#include <amxx/cycle_clock.h>
+#include <amxx/native_stats.h>
+
+#ifdef AMXX_TRACE
+#include <amxx/trace.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <utility>
+
+namespace
+{
+    using namespace amxx;
+
+    /**
+     * @brief Linear sub-buckets per power of two: buckets are at most 25% wide.
+    */
+    constexpr std::size_t SUB_BUCKET_BITS = 2;
+    constexpr std::size_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    constexpr std::size_t HISTOGRAM_BUCKETS = 64 * SUB_BUCKETS;
+
+    struct NativeSlot
+    {
+        const char* name{};
+        AmxNative func{};
+        std::atomic<std::uint64_t> calls{};
+        std::atomic<std::uint64_t> ticks{};
+        std::atomic<std::uint64_t> max_ticks{};
+        std::atomic<std::uint64_t> histogram[HISTOGRAM_BUCKETS]{};
+        std::atomic<const Amx*> callers[NATIVE_STATS_MAX_CALLERS]{};
+        std::atomic<std::uint64_t> caller_calls[NATIVE_STATS_MAX_CALLERS]{};
+        std::atomic<std::uint64_t> other_calls{};
+    };
+
+    std::unique_ptr<NativeSlot> g_slots[MAX_INSTRUMENTED_NATIVES]{};
+    std::size_t g_slot_count{};
+    std::atomic<bool> g_enabled{true};
+
+    /**
+     * @brief Instrumented lists handed to the core; a deque keeps them in place.
+    */
+    std::deque<std::vector<AmxNativeInfo>> g_lists{};
+
+    int HighestBit(const std::uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value);
+#else
+        auto bit = 0;
+
+        for (auto v = value; v >>= 1;) {
+            ++bit;
+        }
+
+        return bit;
+#endif
+    }
+
+    /**
+     * @brief Log-linear bucket of \c ticks: values below SUB_BUCKETS get their own bucket, larger ones are split
+     * into SUB_BUCKETS linear steps per power of two.
+    */
+    std::size_t BucketOf(const std::uint64_t ticks)
+    {
+        if (ticks < SUB_BUCKETS) {
+            return static_cast<std::size_t>(ticks);
+        }
+
+        const auto exponent = static_cast<std::size_t>(HighestBit(ticks));
+        const auto sub = static_cast<std::size_t>(ticks >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+
+        return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+    }
+
+    /**
+     * @brief Middle of the range of ticks that falls into \c bucket.
+    */
+    double BucketMiddle(const std::size_t bucket)
+    {
+        if (bucket < SUB_BUCKETS) {
+            return static_cast<double>(bucket);
+        }
+
+        const auto exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+        const auto sub = bucket % SUB_BUCKETS;
+        const auto width = static_cast<double>(std::uint64_t{1} << (exponent - SUB_BUCKET_BITS));
+
+        return static_cast<double>(SUB_BUCKETS + sub) * width + width / 2;
+    }
+
+    void CountCaller(NativeSlot& slot, const Amx* const amx)
+    {
+        // Open addressing on the Amx address; slots are claimed once and never freed until a reset.
+        const auto start = (reinterpret_cast<std::uintptr_t>(amx) >> 4) % NATIVE_STATS_MAX_CALLERS;
+
+        for (std::size_t i = 0; i < NATIVE_STATS_MAX_CALLERS; ++i) {
+            const auto index = (start + i) % NATIVE_STATS_MAX_CALLERS;
+            const Amx* key = slot.callers[index].load(std::memory_order_acquire);
+
+            if (!key && slot.callers[index].compare_exchange_strong(key, amx, std::memory_order_acq_rel)) {
+                key = amx;
+            }
+
+            if (key == amx) {
+                slot.caller_calls[index].fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        slot.other_calls.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Record(NativeSlot& slot, const Amx* const amx, const std::uint64_t ticks)
+    {
+        slot.calls.fetch_add(1, std::memory_order_relaxed);
+        slot.ticks.fetch_add(ticks, std::memory_order_relaxed);
+        slot.histogram[BucketOf(ticks)].fetch_add(1, std::memory_order_relaxed);
+
+        auto max = slot.max_ticks.load(std::memory_order_relaxed);
+
+        while (ticks > max && !slot.max_ticks.compare_exchange_weak(max, ticks, std::memory_order_relaxed)) {
+        }
+
+        CountCaller(slot, amx);
+    }
+
+    /**
+     * @brief Native of slot \c Index: a native has no context argument, so every slot gets its own function.
+    */
+    template <std::size_t Index>
+    cell AMX_NATIVE_CALL Trampoline(Amx* const amx, cell* const params)
+    {
+        auto& slot = *g_slots[Index];
+
+        if (!g_enabled.load(std::memory_order_relaxed)) {
+            return slot.func(amx, params);
+        }
+
+        const auto start = CycleClock::Now();
+        const auto result = slot.func(amx, params);
+        const auto end = CycleClock::Now();
+        Record(slot, amx, end - start);
+
+#ifdef AMXX_TRACE
+        if (TraceEnabled()) {
+            TraceComplete(slot.name, "native", start, end);
+        }
+#endif
+
+        return result;
+    }
+
+    template <std::size_t... Indices>
+    constexpr std::array<AmxNative, sizeof...(Indices)> MakeTrampolines(std::index_sequence<Indices...>)
+    {
+        return {Trampoline<Indices>...};
+    }
+
+    constexpr auto TRAMPOLINES = MakeTrampolines(std::make_index_sequence<MAX_INSTRUMENTED_NATIVES>{});
+
+    double Percentile(const NativeSlot& slot, const std::uint64_t calls, const double fraction)
+    {
+        const auto target = static_cast<std::uint64_t>(static_cast<double>(calls) * fraction);
+        std::uint64_t seen = 0;
+
+        for (std::size_t bucket = 0; bucket < HISTOGRAM_BUCKETS; ++bucket) {
+            seen += slot.histogram[bucket].load(std::memory_order_relaxed);
+
+            if (seen > target) {
+                return BucketMiddle(bucket);
+            }
+        }
+
+        return 0;
+    }
+
+    std::string PluginName(const Amx* const amx)
+    {
+        const auto id = FindAmxScriptByAmx(amx);
+        const auto* const name = id >= 0 ? GetAmxScriptName(id, true) : nullptr;
+
+        return name ? name : "?";
+    }
+}
+
+namespace amxx
+{
+    const AmxNativeInfo* InstrumentNatives(const AmxNativeInfo* const list)
+    {
+        if (!list) {
+            return list;
+        }
+
+        CycleClock::Calibrate();
+
+        auto& copy = g_lists.emplace_back();
+
+        for (auto* entry = list; entry->name; ++entry) {
+            if (!entry->func || g_slot_count == MAX_INSTRUMENTED_NATIVES) {
+                copy.push_back(*entry);
+                continue;
+            }
+
+            auto& slot = g_slots[g_slot_count] = std::make_unique<NativeSlot>();
+            slot->name = entry->name;
+            slot->func = entry->func;
+            copy.push_back({entry->name, TRAMPOLINES[g_slot_count++]});
+        }
+
+        copy.push_back({nullptr, nullptr});
+
+        return copy.data();
+    }
+
+    void SetNativeStatsEnabled(const bool enabled)
+    {
+        g_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool NativeStatsEnabled()
+    {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    std::vector<NativeStats> CollectNativeStats()
+    {
+        std::vector<NativeStats> result{};
+        const auto ns_per_tick = CycleClock::NanosecondsPerTick();
+
+        for (std::size_t i = 0; i < g_slot_count; ++i) {
+            const auto& slot = *g_slots[i];
+            const auto calls = slot.calls.load(std::memory_order_relaxed);
+
+            if (!calls) {
+                continue;
+            }
+
+            auto& stats = result.emplace_back();
+            stats.name = slot.name;
+            stats.calls = calls;
+            stats.total_ns = static_cast<double>(slot.ticks.load(std::memory_order_relaxed)) * ns_per_tick;
+            stats.mean_ns = stats.total_ns / static_cast<double>(calls);
+            stats.p50_ns = Percentile(slot, calls, 0.50) * ns_per_tick;
+            stats.p99_ns = Percentile(slot, calls, 0.99) * ns_per_tick;
+            stats.max_ns = static_cast<double>(slot.max_ticks.load(std::memory_order_relaxed)) * ns_per_tick;
+            stats.other_calls = slot.other_calls.load(std::memory_order_relaxed);
+
+            for (std::size_t k = 0; k < NATIVE_STATS_MAX_CALLERS; ++k) {
+                if (const auto* const amx = slot.callers[k].load(std::memory_order_acquire)) {
+                    stats.callers.push_back({amx, slot.caller_calls[k].load(std::memory_order_relaxed)});
+                }
+            }
+
+            std::sort(stats.callers.begin(), stats.callers.end(),
+                      [](const auto& a, const auto& b) { return a.calls > b.calls; });
+        }
+
+        std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) { return a.total_ns > b.total_ns; });
+
+        return result;
+    }
+
+    std::string NativeStatsReport(const std::size_t max_natives)
+    {
+        const auto stats = CollectNativeStats();
+        std::string report{};
+        char line[256];
+
+        std::snprintf(line, sizeof(line), "%-32s %10s %10s %9s %9s %9s %9s  %s\n", "native", "calls", "total ms",
+                      "mean us", "p50 us", "p99 us", "max us", "top callers");
+        report += line;
+
+        for (std::size_t i = 0; i < stats.size() && i < max_natives; ++i) {
+            const auto& native = stats[i];
+
+            std::snprintf(line, sizeof(line), "%-32s %10llu %10.3f %9.3f %9.3f %9.3f %9.3f ", native.name,
+                          static_cast<unsigned long long>(native.calls), native.total_ns / 1e6, native.mean_ns / 1e3,
+                          native.p50_ns / 1e3, native.p99_ns / 1e3, native.max_ns / 1e3);
+            report += line;
+
+            for (std::size_t k = 0; k < native.callers.size() && k < 3; ++k) {
+                const auto share = 100.0 * static_cast<double>(native.callers[k].calls) / static_cast<double>(native.calls);
+                std::snprintf(line, sizeof(line), " %s %.0f%%", PluginName(native.callers[k].amx).c_str(), share);
+                report += line;
+            }
+
+            report += '\n';
+        }
+
+        return report;
+    }
+
+    void DumpNativeStats()
+    {
+        if (!g_slot_count || !detail::api_funcs.print_console) {
+            return;
+        }
+
+        const auto report = NativeStatsReport();
+        std::size_t begin = 0;
+
+        // The console prints through a fixed-size buffer, so go line by line.
+        while (begin < report.size()) {
+            const auto end = report.find('\n', begin);
+            PrintConsole("[%s] %s\n", MODULE_LOG_TAG, report.substr(begin, end - begin).c_str());
+            begin = end + 1;
+        }
+    }
+
+    void ResetNativeStats()
+    {
+        for (std::size_t i = 0; i < g_slot_count; ++i) {
+            auto& slot = *g_slots[i];
+
+            slot.calls.store(0, std::memory_order_relaxed);
+            slot.ticks.store(0, std::memory_order_relaxed);
+            slot.max_ticks.store(0, std::memory_order_relaxed);
+            slot.other_calls.store(0, std::memory_order_relaxed);
+
+            for (auto& bucket : slot.histogram) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+
+            for (std::size_t k = 0; k < NATIVE_STATS_MAX_CALLERS; ++k) {
+                slot.callers[k].store(nullptr, std::memory_order_relaxed);
+                slot.caller_calls[k].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/api.h>
+#include <amxx/plugin_local.h>
+#include <algorithm>
+
+namespace
+{
+    using namespace amxx::detail;
+
+    struct Registry
+    {
+        /**
+         * @brief Destructor of each slot; null for a free slot.
+        */
+        std::vector<PluginSlotDestructor> destructors{};
+
+        std::vector<std::unique_ptr<PluginSlots>> tables{};
+    };
+
+    /**
+     * @brief Built on first use, so PluginLocal objects may be constructed from static constructors.
+    */
+    Registry& GetRegistry()
+    {
+        static Registry registry{};
+        return registry;
+    }
+
+    void DestroyValue(PluginSlots& slots, const std::size_t slot)
+    {
+        if (slot >= slots.values.size() || !slots.values[slot]) {
+            return;
+        }
+
+        // Cleared first: the destructor may look the slot up again.
+        auto* const value = slots.values[slot];
+        slots.values[slot] = nullptr;
+        GetRegistry().destructors[slot](value);
+    }
+
+    void DestroyValues(PluginSlots& slots)
+    {
+        for (std::size_t slot = 0; slot < slots.values.size(); ++slot) {
+            DestroyValue(slots, slot);
+        }
+    }
+}
+
+namespace amxx
+{
+    namespace detail
+    {
+        std::size_t AcquirePluginSlot(const PluginSlotDestructor destructor)
+        {
+            auto& destructors = GetRegistry().destructors;
+            const auto free = std::find(destructors.begin(), destructors.end(), nullptr);
+
+            if (free != destructors.end()) {
+                *free = destructor;
+                return static_cast<std::size_t>(free - destructors.begin());
+            }
+
+            destructors.push_back(destructor);
+
+            return destructors.size() - 1;
+        }
+
+        void ReleasePluginSlot(const std::size_t slot)
+        {
+            ClearPluginSlot(slot);
+            GetRegistry().destructors[slot] = nullptr;
+        }
+
+        void ResetPluginSlot(const Amx* const amx, const std::size_t slot)
+        {
+            if (auto* const slots = FindPluginSlots(amx)) {
+                DestroyValue(*slots, slot);
+            }
+        }
+
+        void ClearPluginSlot(const std::size_t slot)
+        {
+            for (const auto& slots : GetRegistry().tables) {
+                DestroyValue(*slots, slot);
+            }
+        }
+
+        PluginSlots& GetPluginSlots(Amx* const amx)
+        {
+            if (auto* const slots = FindPluginSlots(amx)) {
+                return *slots;
+            }
+
+            auto& tables = GetRegistry().tables;
+
+            if (tables.empty()) {
+                AddUnloadHandler(static_cast<void (*)()>(&amxx::ReleasePluginLocals));
+            }
+
+            auto& slots = *tables.emplace_back(std::make_unique<PluginSlots>(PluginSlots{amx, {}}));
+            amx::SetUserData(amx, PLUGIN_LOCAL_TAG, &slots);
+
+            return slots;
+        }
+
+        PluginSlots* FindPluginSlotsSlow(const Amx* const amx)
+        {
+            for (const auto& slots : GetRegistry().tables) {
+                if (slots->amx == amx) {
+                    return slots.get();
+                }
+            }
+
+            return nullptr;
+        }
+
+        const std::vector<std::unique_ptr<PluginSlots>>& PluginSlotTables()
+        {
+            return GetRegistry().tables;
+        }
+    }
+
+    void ReleasePluginLocals(Amx* const amx)
+    {
+        auto& tables = GetRegistry().tables;
+        const auto it = std::find_if(tables.begin(), tables.end(), [amx](const auto& slots) { return slots->amx == amx; });
+
+        if (it == tables.end()) {
+            return;
+        }
+
+        DestroyValues(**it);
+        amx::RemoveUserData(amx, detail::PLUGIN_LOCAL_TAG);
+        tables.erase(it);
+    }
+
+    void ReleasePluginLocals()
+    {
+        auto& tables = GetRegistry().tables;
+
+        for (const auto& slots : tables) {
+            DestroyValues(*slots);
+            amx::RemoveUserData(slots->amx, detail::PLUGIN_LOCAL_TAG);
+        }
+
+        tables.clear();
+    }
+}
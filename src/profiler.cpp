@@ -0,0 +1,408 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_PROFILER
+
+#include <amxx/profiler.h>
+#include <amxx/amx_index.h>
+#include <amxx/api.h>
+#include <amxx/cycle_clock.h>
+#include <amxx/plugin_local.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace
+{
+    using namespace amxx;
+
+    /**
+     * @brief Deeper stacks are cut at the outermost frames.
+    */
+    constexpr std::size_t MAX_STACK_DEPTH = 64;
+
+    /**
+     * @brief Distinct call stacks of a plugin, each under a small dense id.
+     * Samples are counted per id in a flat array; only a stack seen for the first time allocates.
+    */
+    class StackTable
+    {
+    public:
+        /**
+         * @brief Returns the id of \c stack, adding it on first sight.
+        */
+        std::uint32_t Intern(const ucell* const stack, const std::size_t depth)
+        {
+            if (entries_.size() * 2 >= slots_.size()) {
+                Grow();
+            }
+
+            const auto hash = Hash(stack, depth);
+            const auto mask = slots_.size() - 1;
+
+            for (auto slot = static_cast<std::size_t>(hash) & mask;; slot = (slot + 1) & mask) {
+                const auto stored = slots_[slot];
+
+                if (stored == 0) {
+                    const auto id = static_cast<std::uint32_t>(entries_.size());
+                    entries_.push_back({hash, static_cast<std::uint32_t>(frames_.size()), static_cast<std::uint32_t>(depth)});
+                    frames_.insert(frames_.end(), stack, stack + depth);
+                    slots_[slot] = id + 1;
+
+                    return id;
+                }
+
+                const auto& entry = entries_[stored - 1];
+
+                if (entry.hash == hash && entry.depth == depth &&
+                    std::equal(stack, stack + depth, frames_.begin() + entry.offset)) {
+                    return stored - 1;
+                }
+            }
+        }
+
+        /**
+         * @brief Number of distinct stacks.
+        */
+        [[nodiscard]] std::size_t Count() const
+        {
+            return entries_.size();
+        }
+
+        /**
+         * @brief Code addresses of the stack \c id, innermost frame first.
+        */
+        [[nodiscard]] const ucell* Frames(const std::uint32_t id) const
+        {
+            return frames_.data() + entries_[id].offset;
+        }
+
+        /**
+         * @brief Number of frames of the stack \c id.
+        */
+        [[nodiscard]] std::size_t Depth(const std::uint32_t id) const
+        {
+            return entries_[id].depth;
+        }
+
+    private:
+        struct Entry
+        {
+            std::uint64_t hash;
+            std::uint32_t offset;
+            std::uint32_t depth;
+        };
+
+        static std::uint64_t Hash(const ucell* const stack, const std::size_t depth)
+        {
+            std::uint64_t hash = 14695981039346656037ULL;
+
+            for (std::size_t i = 0; i < depth; ++i) {
+                hash = (hash ^ stack[i]) * 1099511628211ULL;
+            }
+
+            return hash;
+        }
+
+        void Grow()
+        {
+            slots_.assign(slots_.empty() ? 64 : slots_.size() * 2, 0);
+            const auto mask = slots_.size() - 1;
+
+            for (std::size_t id = 0; id < entries_.size(); ++id) {
+                auto slot = static_cast<std::size_t>(entries_[id].hash) & mask;
+
+                while (slots_[slot] != 0) {
+                    slot = (slot + 1) & mask;
+                }
+
+                slots_[slot] = static_cast<std::uint32_t>(id + 1);
+            }
+        }
+
+        std::vector<ucell> frames_{};
+        std::vector<Entry> entries_{};
+
+        /**
+         * @brief Open-addressed index into \c entries_, holding id + 1; 0 marks an empty slot.
+        */
+        std::vector<std::uint32_t> slots_{};
+    };
+
+    struct Profile
+    {
+        Amx* amx{};
+        AmxDebug previous_hook{};
+        std::string plugin{};
+        amx::DebugInfo symbols{};
+        std::uint64_t period_ticks{};
+        std::uint64_t next_sample{};
+
+        /**
+         * @brief Code addresses of the last sample, innermost frame first.
+        */
+        ucell stack[MAX_STACK_DEPTH]{};
+        std::size_t stack_depth{};
+        StackTable stacks{};
+
+        /**
+         * @brief Sample count per stack id of \c stacks.
+        */
+        std::vector<std::uint64_t> samples{};
+    };
+
+    /**
+     * @brief Profile of every profiled plugin; kept in a PluginLocal so that the registry holds the only
+     * Amx::user_data slot the library uses.
+    */
+    PluginLocal<Profile> g_profiles{};
+
+    /**
+     * @brief Folded samples of the scripts that are no longer profiled.
+    */
+    std::map<std::string, std::uint64_t> g_stopped_samples{};
+
+    std::uint64_t g_sample_count{};
+
+    Profile* FindProfile(const Amx* const amx)
+    {
+        return g_profiles.Find(amx);
+    }
+
+    void WalkStack(Profile& profile)
+    {
+        const auto* const amx = profile.amx;
+        const auto* const header = reinterpret_cast<const AmxHeader*>(amx->base);
+        const auto* const data = amx->data ? amx->data : amx->base + header->dat;
+        const auto code_size = static_cast<std::uint64_t>(header->dat - header->cod);
+        const auto memory_size = static_cast<std::uint64_t>(header->stp - header->dat);
+
+        profile.stack_depth = 0;
+        profile.stack[profile.stack_depth++] = static_cast<ucell>(amx->cip);
+
+        // A frame holds the caller's frame and the return address; the entry frame returns to address 0.
+        auto frame = static_cast<std::uint64_t>(static_cast<ucell>(amx->frm));
+
+        while (profile.stack_depth < MAX_STACK_DEPTH && frame + 2 * sizeof(cell) <= memory_size) {
+            cell caller_frame{};
+            cell return_address{};
+            std::memcpy(&caller_frame, data + frame, sizeof(cell));
+            std::memcpy(&return_address, data + frame + sizeof(cell), sizeof(cell));
+
+            if (return_address <= 0 || static_cast<std::uint64_t>(return_address) >= code_size) {
+                break;
+            }
+
+            profile.stack[profile.stack_depth++] = static_cast<ucell>(return_address);
+
+            // The stack grows down, so callers sit higher; anything else is a corrupt chain.
+            if (static_cast<std::uint64_t>(static_cast<ucell>(caller_frame)) <= frame) {
+                break;
+            }
+
+            frame = static_cast<ucell>(caller_frame);
+        }
+    }
+
+    int AMXAPI DebugHook(Amx* const amx)
+    {
+        auto* const profile = FindProfile(amx);
+
+        if (!profile) {
+            return static_cast<int>(AmxError::None);
+        }
+
+        if (const auto now = CycleClock::Now(); now >= profile->next_sample) {
+            profile->next_sample = now + profile->period_ticks;
+
+            WalkStack(*profile);
+            const auto id = profile->stacks.Intern(profile->stack, profile->stack_depth);
+
+            if (id == profile->samples.size()) {
+                profile->samples.push_back(0);
+            }
+
+            ++profile->samples[id];
+            ++g_sample_count;
+        }
+
+        return profile->previous_hook ? profile->previous_hook(amx) : static_cast<int>(AmxError::None);
+    }
+
+    std::string FrameName(const Profile& profile, const ucell address)
+    {
+        if (const auto* const name = profile.symbols.FunctionAt(address)) {
+            return name;
+        }
+
+        // Without debug information the nearest public at or below the address is the best guess.
+        const auto& index = GetAmxIndex(profile.amx);
+        int best = -1;
+
+        for (auto i = 0; i < index.PublicCount(); ++i) {
+            if (index.PublicAddress(i) <= address && (best < 0 || index.PublicAddress(i) > index.PublicAddress(best))) {
+                best = i;
+            }
+        }
+
+        if (best >= 0) {
+            return index.PublicName(best);
+        }
+
+        char name[16];
+        std::snprintf(name, sizeof(name), "0x%08x", static_cast<unsigned>(address));
+
+        return name;
+    }
+
+    void FoldSamples(const Profile& profile, std::map<std::string, std::uint64_t>& folded)
+    {
+        for (std::uint32_t id = 0; id < profile.samples.size(); ++id) {
+            if (!profile.samples[id]) {
+                continue;
+            }
+
+            const auto* const frames = profile.stacks.Frames(id);
+            auto line = profile.plugin;
+
+            for (auto depth = profile.stacks.Depth(id); depth > 0; --depth) {
+                line += ';';
+                line += FrameName(profile, frames[depth - 1]);
+            }
+
+            folded[line] += profile.samples[id];
+        }
+    }
+
+    /**
+     * @brief Restores the previous debug hook of \c amx and keeps the samples of \c profile.
+    */
+    void Unhook(Amx* const amx, const Profile& profile)
+    {
+        // A hook installed after ours keeps calling it; it then just returns.
+        if (amx->debug == DebugHook) {
+            amx->debug = profile.previous_hook;
+        }
+
+        FoldSamples(profile, g_stopped_samples);
+    }
+}
+
+namespace amxx
+{
+    bool StartProfiling(Amx* const amx, const std::uint32_t samples_per_second, const amx::DebugInfo* const symbols)
+    {
+        if (!amx || FindProfile(amx)) {
+            return false;
+        }
+
+        CycleClock::Calibrate();
+
+        auto& profile = g_profiles.Get(amx);
+        profile.amx = amx;
+        profile.previous_hook = amx->debug;
+        // Converted once here; the hook only adds it to the clock.
+        const auto period_ns = 1e9 / std::max<std::uint32_t>(samples_per_second, 1);
+        profile.period_ticks = std::max<std::uint64_t>(
+            static_cast<std::uint64_t>(period_ns / CycleClock::NanosecondsPerTick()), 1);
+
+        if (symbols) {
+            profile.symbols = *symbols;
+        }
+        else {
+            profile.symbols.ParseImage(amx);
+        }
+
+        const auto id = FindAmxScriptByAmx(amx);
+        const auto* const name = id >= 0 ? GetAmxScriptName(id, true) : nullptr;
+        profile.plugin = name && *name ? name : "plugin";
+
+        amx->debug = DebugHook;
+
+        return true;
+    }
+
+    void StopProfiling(Amx* const amx)
+    {
+        if (auto* const profile = FindProfile(amx)) {
+            Unhook(amx, *profile);
+            g_profiles.Reset(amx);
+        }
+    }
+
+    void StopProfiling()
+    {
+        g_profiles.ForEach(Unhook);
+        g_profiles.Clear();
+    }
+
+    bool IsProfiling(const Amx* const amx)
+    {
+        return FindProfile(amx) != nullptr;
+    }
+
+    std::uint64_t ProfilerSampleCount()
+    {
+        return g_sample_count;
+    }
+
+    std::string CollapsedStacks()
+    {
+        auto folded = g_stopped_samples;
+
+        g_profiles.ForEach([&folded](Amx*, const Profile& profile) { FoldSamples(profile, folded); });
+
+        std::string result{};
+
+        for (const auto& [line, count] : folded) {
+            result += line;
+            result += ' ';
+            result += std::to_string(count);
+            result += '\n';
+        }
+
+        return result;
+    }
+
+    bool WriteCollapsedStacks(const char* const path)
+    {
+        auto* const file = std::fopen(path, "w");
+
+        if (!file) {
+            return false;
+        }
+
+        const auto stacks = CollapsedStacks();
+        const auto written = std::fwrite(stacks.data(), 1, stacks.size(), file) == stacks.size();
+
+        return std::fclose(file) == 0 && written;
+    }
+
+    void ResetProfiler()
+    {
+        g_profiles.ForEach([](Amx*, Profile& profile) {
+            std::fill(profile.samples.begin(), profile.samples.end(), 0);
+        });
+
+        g_stopped_samples.clear();
+        g_sample_count = 0;
+    }
+}
+
+#endif
@@ -0,0 +1,290 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_TASK_POOL
+
+#include <amxx/task_pool.h>
+#include <amxx/api.h>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace amxx;
+
+    struct WorkerQueue
+    {
+        std::mutex mutex{};
+        std::deque<Task> tasks{};
+    };
+
+    struct Pool
+    {
+        std::vector<std::unique_ptr<WorkerQueue>> queues{};
+        std::vector<std::thread> threads{};
+
+        /**
+         * @brief Tasks queued and not yet taken by a worker.
+        */
+        std::atomic<std::size_t> pending{};
+
+        /**
+         * @brief Round-robin queue for tasks submitted from outside the pool.
+        */
+        std::atomic<std::size_t> next_queue{};
+
+        std::mutex sleep_mutex{};
+        std::condition_variable wake{};
+        bool stop{};
+    };
+
+    /**
+     * @brief Node of the completion queue, an intrusive MPSC list: producers swap the head, the game thread
+     * follows the next links from the tail.
+    */
+    struct Completion
+    {
+        std::atomic<Completion*> next{};
+        Task task{};
+    };
+
+    std::unique_ptr<Pool> g_pool{};
+
+    /**
+     * @brief Queue of the calling worker; -1 outside the pool.
+    */
+    thread_local int t_worker = -1;
+
+    Completion g_stub{};
+    std::atomic<Completion*> g_head{&g_stub};
+    Completion* g_tail = &g_stub;
+
+    void Push(Pool& pool, Task task)
+    {
+        // Work spawned by a task stays on its worker; the rest is spread over the queues.
+        const auto index = t_worker >= 0 ? static_cast<std::size_t>(t_worker)
+                                         : pool.next_queue.fetch_add(1, std::memory_order_relaxed) % pool.queues.size();
+
+        {
+            auto& queue = *pool.queues[index];
+            const std::lock_guard lock{queue.mutex};
+            queue.tasks.push_back(std::move(task));
+        }
+
+        pool.pending.fetch_add(1, std::memory_order_release);
+
+        {
+            // Taking the lock orders this wake-up after a worker's check of \c pending.
+            const std::lock_guard lock{pool.sleep_mutex};
+        }
+
+        pool.wake.notify_one();
+    }
+
+    bool TryPop(Pool& pool, const std::size_t self, Task& task)
+    {
+        const auto count = pool.queues.size();
+
+        for (std::size_t i = 0; i < count; ++i) {
+            auto& queue = *pool.queues[(self + i) % count];
+            const std::lock_guard lock{queue.mutex};
+
+            if (queue.tasks.empty()) {
+                continue;
+            }
+
+            // Own work oldest first; stolen work from the other end, away from its owner.
+            if (i == 0) {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            else {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+
+            pool.pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+    void WorkerThread(Pool& pool, const std::size_t self)
+    {
+        t_worker = static_cast<int>(self);
+
+        for (;;) {
+            if (Task task; TryPop(pool, self, task)) {
+                task();
+                continue;
+            }
+
+            std::unique_lock lock{pool.sleep_mutex};
+            pool.wake.wait(lock, [&pool] { return pool.stop || pool.pending.load(std::memory_order_acquire) > 0; });
+
+            if (pool.stop && pool.pending.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+        }
+    }
+
+    Completion* PopCompletion()
+    {
+        auto* tail = g_tail;
+        auto* next = tail->next.load(std::memory_order_acquire);
+
+        if (tail == &g_stub) {
+            if (!next) {
+                return nullptr;
+            }
+
+            g_tail = tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next) {
+            g_tail = next;
+            return tail;
+        }
+
+        // The tail is the last node; a producer may be half way through linking a new one.
+        if (tail != g_head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        // Put the stub back behind it, so the tail can be handed out.
+        g_stub.next.store(nullptr, std::memory_order_relaxed);
+
+        g_head.exchange(&g_stub, std::memory_order_acq_rel)->next.store(&g_stub, std::memory_order_release);
+
+        next = tail->next.load(std::memory_order_acquire);
+
+        if (next) {
+            g_tail = next;
+            return tail;
+        }
+
+        return nullptr;
+    }
+}
+
+namespace amxx
+{
+    bool StartTaskPool(unsigned threads)
+    {
+        if (g_pool) {
+            return false;
+        }
+
+        if (!threads) {
+            threads = std::max(std::thread::hardware_concurrency(), 2U) - 1;
+        }
+
+        g_pool = std::make_unique<Pool>();
+
+        for (unsigned i = 0; i < threads; ++i) {
+            g_pool->queues.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        for (unsigned i = 0; i < threads; ++i) {
+            g_pool->threads.emplace_back(WorkerThread, std::ref(*g_pool), i);
+        }
+
+        return true;
+    }
+
+    void StopTaskPool()
+    {
+        if (g_pool) {
+            {
+                const std::lock_guard lock{g_pool->sleep_mutex};
+                g_pool->stop = true;
+            }
+
+            g_pool->wake.notify_all();
+
+            for (auto& thread : g_pool->threads) {
+                thread.join();
+            }
+
+            g_pool.reset();
+        }
+
+        // Nothing may run a completion once the module is going away.
+        while (auto* const completion = PopCompletion()) {
+            delete completion;
+        }
+    }
+
+    bool TaskPoolRunning()
+    {
+        return g_pool != nullptr;
+    }
+
+    std::size_t TaskPoolSize()
+    {
+        return g_pool ? g_pool->threads.size() : 0;
+    }
+
+    void SubmitTask(Task work)
+    {
+        if (g_pool) {
+            Push(*g_pool, std::move(work));
+        }
+        else {
+            work();
+        }
+    }
+
+    void PostToGameThread(Task completion)
+    {
+        auto* const node = new Completion{};
+        node->task = std::move(completion);
+
+        auto* const previous = g_head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    std::size_t RunTaskCompletions(const std::size_t max_completions)
+    {
+        assert(IsGameThread() || !detail::game_thread_known);
+
+        std::size_t count = 0;
+
+        while (count < max_completions) {
+            const std::unique_ptr<Completion> completion{PopCompletion()};
+
+            if (!completion) {
+                break;
+            }
+
+            completion->task();
+            ++count;
+        }
+
+        return count;
+    }
+}
+
+#endif
@@ -0,0 +1,352 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_TRACE
+
+#include <amxx/trace.h>
+#include <amxx/amx_index.h>
+#include <amxx/api.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    using namespace amxx;
+
+    struct Event
+    {
+        const char* name;
+        const char* category;
+        std::uint64_t start;
+        std::uint64_t end;
+    };
+
+    /**
+     * @brief Ring entry; the fields are atomic so the flush can copy them while the owner writes.
+    */
+    struct Slot
+    {
+        std::atomic<const char*> name{};
+        std::atomic<const char*> category{};
+        std::atomic<std::uint64_t> start{};
+        std::atomic<std::uint64_t> end{};
+    };
+
+    /**
+     * @brief Single-writer ring: only the owning thread stores events, the flush copies a snapshot without a lock.
+    */
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Slot[]> events{std::make_unique<Slot[]>(TRACE_BUFFER_EVENTS)};
+
+        /**
+         * @brief Events started by the writer; a slot below \c claimed - \c TRACE_BUFFER_EVENTS is being reused.
+        */
+        std::atomic<std::uint64_t> claimed{};
+
+        /**
+         * @brief Events fully stored.
+        */
+        std::atomic<std::uint64_t> written{};
+
+        /**
+         * @brief Events up to here were dropped by \c ClearTrace.
+        */
+        std::atomic<std::uint64_t> cleared{};
+
+        std::size_t tid{};
+        std::string name{};
+    };
+
+    /**
+     * @brief Guards the buffer list and the interned names.
+    */
+    std::mutex g_mutex{};
+
+    /**
+     * @brief Buffers outlive their threads, so the slices of finished threads are still written out.
+    */
+    std::vector<std::shared_ptr<ThreadBuffer>> g_buffers{};
+    std::unordered_set<std::string> g_names{};
+    std::atomic<const char*> g_forward_names[MAX_TRACED_FORWARDS]{};
+
+    /**
+     * @brief Bumped by \c ResetTraceNames to drop the per-thread public name caches.
+    */
+    std::atomic<std::uint32_t> g_name_generation{};
+
+    ThreadBuffer& LocalBuffer()
+    {
+        thread_local const auto buffer = [] {
+            CycleClock::Calibrate();
+
+            auto created = std::make_shared<ThreadBuffer>();
+
+            const std::lock_guard lock{g_mutex};
+            created->tid = g_buffers.size() + 1;
+            created->name = "thread " + std::to_string(created->tid);
+            g_buffers.push_back(created);
+
+            return created;
+        }();
+
+        return *buffer;
+    }
+
+    void WriteJsonString(std::FILE* const file, const char* text)
+    {
+        std::fputc('"', file);
+
+        for (; *text; ++text) {
+            const auto ch = static_cast<unsigned char>(*text);
+
+            if (ch == '"' || ch == '\\') {
+                std::fputc('\\', file);
+                std::fputc(ch, file);
+            }
+            else if (ch < 0x20) {
+                std::fprintf(file, "\\u%04x", ch);
+            }
+            else {
+                std::fputc(ch, file);
+            }
+        }
+
+        std::fputc('"', file);
+    }
+}
+
+namespace amxx
+{
+    void TraceComplete(const char* const name, const char* const category, const std::uint64_t start,
+                       const std::uint64_t end)
+    {
+        auto& buffer = LocalBuffer();
+        const auto index = buffer.written.load(std::memory_order_relaxed);
+        auto& slot = buffer.events[index % TRACE_BUFFER_EVENTS];
+
+        // Claim first, so a flush copying this slot meanwhile sees it was being overwritten.
+        buffer.claimed.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.category.store(category, std::memory_order_relaxed);
+        slot.start.store(start, std::memory_order_relaxed);
+        slot.end.store(end, std::memory_order_relaxed);
+
+        buffer.written.store(index + 1, std::memory_order_release);
+    }
+
+    const char* TraceIntern(const std::string_view name)
+    {
+        const std::lock_guard lock{g_mutex};
+        return g_names.emplace(name).first->c_str();
+    }
+
+    const char* TracePublicName(const Amx* const amx, const int index)
+    {
+        struct Key
+        {
+            const Amx* amx;
+            int index;
+
+            bool operator==(const Key& other) const
+            {
+                return amx == other.amx && index == other.index;
+            }
+        };
+
+        struct KeyHash
+        {
+            std::size_t operator()(const Key& key) const
+            {
+                return std::hash<const void*>{}(key.amx) ^ static_cast<std::size_t>(key.index) * 0x9E3779B9u;
+            }
+        };
+
+        if (!TraceEnabled()) {
+            return "plugin";
+        }
+
+        thread_local std::unordered_map<Key, const char*, KeyHash> cache{};
+        thread_local std::uint32_t generation{};
+
+        if (const auto current = g_name_generation.load(std::memory_order_acquire); generation != current) {
+            cache.clear();
+            generation = current;
+        }
+
+        if (const auto it = cache.find({amx, index}); it != cache.end()) {
+            return it->second;
+        }
+
+        const auto id = FindAmxScriptByAmx(amx);
+        const auto* const plugin = id >= 0 ? GetAmxScriptName(id, true) : nullptr;
+        std::string name = plugin && *plugin ? plugin : "plugin";
+        name += "::";
+
+        if (index == AMX_EXEC_MAIN) {
+            name += "main";
+        }
+        else if (index == AMX_EXEC_CONT) {
+            name += "continue";
+        }
+        else if (const auto& amx_index = GetAmxIndex(const_cast<Amx*>(amx));
+                 index >= 0 && index < amx_index.PublicCount()) {
+            name += amx_index.PublicName(index);
+        }
+        else {
+            name += "public #" + std::to_string(index);
+        }
+
+        return cache[{amx, index}] = TraceIntern(name);
+    }
+
+    void SetTraceForwardName(const int id, const char* const name)
+    {
+        if (id >= 0 && id < MAX_TRACED_FORWARDS && name) {
+            g_forward_names[id].store(TraceIntern(std::string{"forward "} + name), std::memory_order_release);
+        }
+    }
+
+    const char* TraceForwardName(const int id)
+    {
+        const char* name = nullptr;
+
+        if (id >= 0 && id < MAX_TRACED_FORWARDS) {
+            name = g_forward_names[id].load(std::memory_order_acquire);
+        }
+
+        return name ? name : "forward";
+    }
+
+    void ResetTraceNames()
+    {
+        for (auto& name : g_forward_names) {
+            name.store(nullptr, std::memory_order_relaxed);
+        }
+
+        g_name_generation.fetch_add(1, std::memory_order_release);
+    }
+
+    void SetTraceThreadName(const char* const name)
+    {
+        auto& buffer = LocalBuffer();
+        const std::lock_guard lock{g_mutex};
+
+        buffer.name = name;
+    }
+
+    bool WriteChromeTrace(const char* const path)
+    {
+        auto* const file = std::fopen(path, "w");
+
+        if (!file) {
+            return false;
+        }
+
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers{};
+        std::vector<std::vector<Event>> events{};
+        std::vector<std::string> names{};
+
+        {
+            const std::lock_guard lock{g_mutex};
+            buffers = g_buffers;
+
+            for (const auto& buffer : buffers) {
+                names.push_back(buffer->name);
+            }
+        }
+
+        // Snapshot the rings oldest first, without stopping their writers.
+        auto origin = UINT64_MAX;
+
+        for (const auto& buffer : buffers) {
+            auto& copy = events.emplace_back();
+            const auto written = buffer->written.load(std::memory_order_acquire);
+            const auto floor = std::max<std::uint64_t>(buffer->cleared.load(std::memory_order_relaxed),
+                                        written > TRACE_BUFFER_EVENTS ? written - TRACE_BUFFER_EVENTS : 0);
+
+            for (auto i = floor; i < written; ++i) {
+                const auto& slot = buffer->events[i % TRACE_BUFFER_EVENTS];
+                copy.push_back({slot.name.load(std::memory_order_relaxed), slot.category.load(std::memory_order_relaxed),
+                                slot.start.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed)});
+            }
+
+            // Drop the oldest entries if the writer lapped them while they were copied.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            const auto claimed = buffer->claimed.load(std::memory_order_relaxed);
+            const auto reused = claimed > TRACE_BUFFER_EVENTS ? claimed - TRACE_BUFFER_EVENTS : 0;
+
+            if (reused > floor) {
+                copy.erase(copy.begin(), copy.begin() + static_cast<std::ptrdiff_t>(std::min(reused - floor, written - floor)));
+            }
+
+            for (const auto& event : copy) {
+                origin = std::min(origin, event.start);
+            }
+        }
+
+        const auto us_per_tick = CycleClock::NanosecondsPerTick() / 1000.0;
+
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+        std::fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":", file);
+        WriteJsonString(file, *MODULE_NAME ? MODULE_NAME : "amxx module");
+        std::fputs("}}", file);
+
+        for (std::size_t i = 0; i < buffers.size(); ++i) {
+            std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":",
+                         buffers[i]->tid);
+            WriteJsonString(file, names[i].c_str());
+            std::fputs("}}", file);
+
+            for (const auto& event : events[i]) {
+                std::fputs(",\n{\"name\":", file);
+                WriteJsonString(file, event.name);
+                std::fputs(",\"cat\":", file);
+                WriteJsonString(file, event.category);
+                std::fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%zu}",
+                             static_cast<double>(event.start - origin) * us_per_tick,
+                             static_cast<double>(event.end - event.start) * us_per_tick, buffers[i]->tid);
+            }
+        }
+
+        std::fputs("\n]}\n", file);
+
+        const auto written = !std::ferror(file);
+        return std::fclose(file) == 0 && written;
+    }
+
+    void ClearTrace()
+    {
+        const std::lock_guard lock{g_mutex};
+
+        // The writers own their indices, so clearing only moves the start of what is flushed.
+        for (const auto& buffer : g_buffers) {
+            buffer->cleared.store(buffer->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+}
+
+#endif
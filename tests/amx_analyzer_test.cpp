@@ -0,0 +1,144 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "amx_image.h"
+#include <amxx/amx_analyzer.h>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace amxx;
+using amx::Opcode;
+
+namespace
+{
+    class AmxAnalyzerTest : public testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            test::AmxAssembler code{};
+            code.Emit(Opcode::Halt, 0);
+
+            // scan(): once(); for (;;) { each(); } and a call through SYSREQ.PRI
+            scan_ = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::PushC, 0);
+            code.Emit(Opcode::SysreqC, 0);
+            code.Emit(Opcode::Stack, 4);
+            const auto loop = code.Here();
+            code.Emit(Opcode::PushC, 0);
+            code.Emit(Opcode::SysreqC, 1);
+            code.Emit(Opcode::Stack, 4);
+            code.Emit(Opcode::Jump, loop);
+            code.Emit(Opcode::SysreqPri);
+            code.Emit(Opcode::Retn);
+
+            // other(): once()
+            other_ = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::PushC, 0);
+            code.Emit(Opcode::SysreqC, 0);
+            code.Emit(Opcode::Stack, 4);
+            code.Emit(Opcode::Retn);
+
+            code_size_ = code.Code().size() * sizeof(cell);
+            image_ = test::BuildAmxImage({{"scan", scan_}, {"other", other_}}, {"once", "each", "unused"}, code.Code());
+        }
+
+        [[nodiscard]] const unsigned char* Bytes() const
+        {
+            return reinterpret_cast<const unsigned char*>(image_.data());
+        }
+
+        std::vector<cell> image_{};
+        cell scan_{};
+        cell other_{};
+        std::size_t code_size_{};
+    };
+}
+
+TEST_F(AmxAnalyzerTest, CountsNativeCallSitesAndLoops)
+{
+    amx::ImageReport report{};
+    ASSERT_EQ(amx::AnalyzeImage(Bytes(), image_.size() * sizeof(cell), report), AmxError::None);
+
+    EXPECT_EQ(report.code_size, code_size_);
+    EXPECT_EQ(report.instructions, 16U);
+    EXPECT_EQ(report.dynamic_calls, 1U);
+    EXPECT_EQ(report.LoopCallSites(), 1U);
+
+    // Most loop call sites first, then most call sites.
+    ASSERT_EQ(report.natives.size(), 3U);
+    EXPECT_EQ(report.natives[0].name, "each");
+    EXPECT_EQ(report.natives[0].call_sites, 1U);
+    EXPECT_EQ(report.natives[0].loop_call_sites, 1U);
+    EXPECT_EQ(report.natives[1].name, "once");
+    EXPECT_EQ(report.natives[1].call_sites, 2U);
+    EXPECT_EQ(report.natives[1].loop_call_sites, 0U);
+    EXPECT_EQ(report.natives[2].name, "unused");
+    EXPECT_EQ(report.natives[2].call_sites, 0U);
+}
+
+TEST_F(AmxAnalyzerTest, SizesThePublicsUpToTheNextProc)
+{
+    amx::ImageReport report{};
+    ASSERT_EQ(amx::AnalyzeImage(Bytes(), image_.size() * sizeof(cell), report), AmxError::None);
+
+    ASSERT_EQ(report.publics.size(), 2U);
+    EXPECT_EQ(report.publics[0].name, "scan");
+    EXPECT_EQ(report.publics[0].address, static_cast<ucell>(scan_));
+    EXPECT_EQ(report.publics[0].size, static_cast<std::size_t>(other_ - scan_));
+    EXPECT_EQ(report.publics[0].native_calls, 2U);
+    EXPECT_EQ(report.publics[1].name, "other");
+    EXPECT_EQ(report.publics[1].size, code_size_ - static_cast<std::size_t>(other_));
+    EXPECT_EQ(report.publics[1].native_calls, 1U);
+}
+
+TEST_F(AmxAnalyzerTest, AnalyzesAFileAndReportsIt)
+{
+    const auto path = testing::TempDir() + "analyzed.amx";
+    const auto& header = *reinterpret_cast<const AmxHeader*>(Bytes());
+    std::ofstream{path, std::ios::binary}.write(reinterpret_cast<const char*>(Bytes()), header.size);
+
+    amx::ImageReport report{};
+    ASSERT_EQ(amx::AnalyzeFile(path.c_str(), report), AmxError::None);
+    EXPECT_EQ(report.plugin, "analyzed.amx");
+    EXPECT_EQ(report.LoopCallSites(), 1U);
+
+    const auto text = amx::ImageReportText({report});
+    EXPECT_NE(text.find("analyzed.amx: " + std::to_string(code_size_) + " bytes of code, 16 instructions"), std::string::npos)
+        << text;
+
+    const auto json = amx::ImageReportJson({report});
+    EXPECT_EQ(json.rfind(R"({"plugins":[{"name":"analyzed.amx")", 0), 0U) << json;
+    EXPECT_NE(json.find(R"({"name":"each","call_sites":1,"loop_call_sites":1})"), std::string::npos) << json;
+}
+
+TEST_F(AmxAnalyzerTest, RejectsBrokenImages)
+{
+    amx::ImageReport report{};
+    EXPECT_EQ(amx::AnalyzeImage(Bytes(), sizeof(AmxHeader) - 1, report), AmxError::Init);
+
+    // A native index past the native table.
+    auto image = image_;
+    const auto& header = *reinterpret_cast<const AmxHeader*>(image.data());
+    image[static_cast<std::size_t>(header.cod + other_) / sizeof(cell) + 4] = 3;
+    EXPECT_EQ(amx::AnalyzeImage(reinterpret_cast<const unsigned char*>(image.data()), image.size() * sizeof(cell), report),
+              AmxError::InvalidInstr);
+}
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_host_test.h"
+#include <amxx/amx_format.h>
+#include <amxx/amx_heap.h>
+#include <string>
+#include <string_view>
+
+using namespace amxx;
+
+namespace
+{
+    constexpr amx::CompiledFormat HUD_FORMAT{"HP: %d | %5.2f | [%-4s] [%06d] %x %X %b %u %c %%"};
+    constexpr amx::CompiledFormat STRING_FORMAT{"%s-%s %.3s"};
+    constexpr amx::CompiledFormat FLOAT_FORMAT{"%.2f %.0f %f %8.1f|%-8.1f|"};
+    constexpr amx::CompiledFormat LITERAL_FORMAT{"no conversions"};
+
+    class AmxFormatTest : public test::FakeHostTest
+    {
+    protected:
+        void SetUp() override
+        {
+            amx_ = host::AddPlugin("format.amxx", {});
+            ASSERT_NE(amx_, nullptr);
+        }
+
+        Amx* amx_{};
+    };
+}
+
+TEST(FormatTo, FormatsIntegersStringsAndCharacters)
+{
+    char buffer[128];
+
+    const auto length = amx::FormatTo<HUD_FORMAT>(buffer, sizeof(buffer), 100, 3.14159f, "ab", -42, 255, 255, 5, -1, 'Z');
+    EXPECT_STREQ(buffer, "HP: 100 |  3.14 | [ab  ] [-00042] ff FF 101 4294967295 Z %");
+    EXPECT_EQ(length, std::string_view{buffer}.size());
+
+    alignas(32) const cell cells[8] = {'c', 'e', 'l', 'l', 0};
+    amx::FormatTo<STRING_FORMAT>(buffer, sizeof(buffer), amx::CellStringView{cells}, std::string_view{"view"},
+                                 std::string{"truncated"});
+    EXPECT_STREQ(buffer, "cell-view tru");
+
+    EXPECT_EQ(amx::FormatTo<LITERAL_FORMAT>(buffer, sizeof(buffer)), 14U);
+    EXPECT_STREQ(buffer, "no conversions");
+}
+
+TEST(FormatTo, RoundsFloatsHalfAwayFromZero)
+{
+    char buffer[128];
+
+    // Unlike the C library, which rounds the exact binary value, as the core's %f does.
+    amx::FormatTo<FLOAT_FORMAT>(buffer, sizeof(buffer), 2.675, 0.5, -1.5, -2.25, 3.0);
+    EXPECT_STREQ(buffer, "2.68 1 -1.500000     -2.3|3.0     |");
+}
+
+TEST(FormatTo, TruncatesToTheBuffer)
+{
+    char buffer[6];
+
+    const auto length = amx::FormatTo<STRING_FORMAT>(buffer, sizeof(buffer), "abcdef", "x", "y");
+    EXPECT_STREQ(buffer, "abcde");
+    EXPECT_EQ(length, 5U);
+}
+
+TEST_F(AmxFormatTest, FormatsNativeArguments)
+{
+    AmxHeapScope heap{amx_};
+
+    const auto format = heap.AllocateString("id=%d name=%s f=%.1f hex=%x");
+    cell params[] = {5 * sizeof(cell), format.address, heap.AllocateCell(-7).address,
+                     heap.AllocateString("bob").address, heap.AllocateCell(amx::FloatToCell(2.5f)).address,
+                     heap.AllocateCell(255).address};
+
+    char buffer[64];
+    EXPECT_EQ(amx::FormatAmxString(amx_, params, 1, buffer), 27U);
+    EXPECT_STREQ(buffer, "id=-7 name=bob f=2.5 hex=ff");
+
+    // The second call is served from the cached pieces of the plugin format.
+    char small[8];
+    EXPECT_EQ(amx::FormatAmxString(amx_, params, 1, small), 7U);
+    EXPECT_STREQ(small, "id=-7 n");
+}
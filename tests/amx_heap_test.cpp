@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_host_test.h"
+#include <amxx/amx_heap.h>
+#include <cstddef>
+#include <limits>
+
+using namespace amxx;
+
+namespace
+{
+    class AmxHeapTest : public test::FakeHostTest
+    {
+    protected:
+        void SetUp() override
+        {
+            amx_ = host::AddPlugin("heap.amxx", {}, {}, 1024);
+            ASSERT_NE(amx_, nullptr);
+        }
+
+        Amx* amx_{};
+    };
+}
+
+TEST_F(AmxHeapTest, RollsBackOnScopeExit)
+{
+    const auto heap = amx_->hea;
+
+    {
+        AmxHeapScope scope{amx_};
+        const auto first = scope.AllocateCell(7);
+        const auto second = scope.AllocateString("abc");
+
+        ASSERT_TRUE(first);
+        ASSERT_TRUE(second);
+        EXPECT_EQ(*first.phys, 7);
+        EXPECT_EQ(second.address, first.address + static_cast<cell>(sizeof(cell)));
+        EXPECT_EQ(second.phys[3], 0);
+        EXPECT_EQ(scope.Used(), 5U);
+        EXPECT_GT(amx_->hea, heap);
+
+        scope.Reset();
+        EXPECT_EQ(amx_->hea, heap);
+        EXPECT_EQ(scope.Used(), 0U);
+        EXPECT_TRUE(scope.Allocate(2));
+    }
+
+    EXPECT_EQ(amx_->hea, heap);
+}
+
+TEST_F(AmxHeapTest, ServesReservedAllocationsWithoutBumpingTheHeap)
+{
+    AmxHeapScope scope{amx_, 16};
+    const auto reserved = amx_->hea;
+
+    for (auto i = 0; i < 16; ++i) {
+        ASSERT_TRUE(scope.Allocate(1));
+    }
+
+    EXPECT_EQ(amx_->hea, reserved);
+    EXPECT_TRUE(scope.Allocate(1));
+    EXPECT_GT(amx_->hea, reserved);
+}
+
+TEST_F(AmxHeapTest, RejectsRequestsThatReachTheStack)
+{
+    AmxHeapScope scope{amx_};
+    const auto heap = amx_->hea;
+    const auto room = static_cast<std::size_t>(amx_->stk - amx_->hea - AMX_STACK_MARGIN) / sizeof(cell);
+
+    EXPECT_EQ(scope.Reserve(room + 1), AmxError::Memory);
+    EXPECT_EQ(scope.Reserve(std::numeric_limits<std::size_t>::max()), AmxError::Memory);
+    EXPECT_EQ(scope.Reserve(std::numeric_limits<std::size_t>::max() / sizeof(cell) + 2), AmxError::Memory);
+    EXPECT_FALSE(scope.Allocate(room + 1));
+    EXPECT_EQ(amx_->hea, heap);
+
+    EXPECT_EQ(scope.Reserve(room), AmxError::None);
+    EXPECT_TRUE(scope.Allocate(room));
+}
+
+TEST_F(AmxHeapTest, RefusesToGrowOverAForeignAllocation)
+{
+    AmxHeapScope scope{amx_};
+    ASSERT_TRUE(scope.Allocate(1));
+
+    cell address{};
+    cell* phys{};
+    ASSERT_EQ(AmxAllot(amx_, 1, &address, &phys), static_cast<int>(AmxError::None));
+
+    EXPECT_FALSE(scope.Allocate(1));
+
+    amx_->hea = address;
+}
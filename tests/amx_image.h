@@ -0,0 +1,147 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/amx.h>
+#include <amxx/amx_opcodes.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+//
+// Hand-assembled AMX images for the tests, so the interpreter and the loader run without the Pawn compiler.
+//
+
+namespace amxx::test
+{
+    /**
+     * @brief Emits a code section one instruction at a time.
+    */
+    class AmxAssembler
+    {
+    public:
+        /**
+         * @brief N/D
+        */
+        void Emit(const amx::Opcode opcode)
+        {
+            code_.push_back(static_cast<cell>(opcode));
+        }
+
+        /**
+         * @brief N/D
+        */
+        void Emit(const amx::Opcode opcode, const cell operand)
+        {
+            code_.push_back(static_cast<cell>(opcode));
+            code_.push_back(operand);
+        }
+
+        /**
+         * @brief Code address of the next instruction.
+        */
+        [[nodiscard]] cell Here() const
+        {
+            return static_cast<cell>(code_.size() * sizeof(cell));
+        }
+
+        /**
+         * @brief N/D
+        */
+        [[nodiscard]] const std::vector<cell>& Code() const
+        {
+            return code_;
+        }
+
+    private:
+        std::vector<cell> code_{};
+    };
+
+    /**
+     * @brief Builds a loadable image from \c code with the given publics (name, code address) and natives,
+     * followed by \c memory_cells of data, heap and stack.
+    */
+    inline std::vector<cell> BuildAmxImage(const std::vector<std::pair<std::string, cell>>& publics,
+                                           const std::vector<std::string>& natives, const std::vector<cell>& code,
+                                           const std::size_t memory_cells = 4096)
+    {
+        std::size_t names_size = sizeof(std::uint16_t);
+
+        for (const auto& [name, address] : publics) {
+            names_size += name.size() + 1;
+        }
+
+        for (const auto& name : natives) {
+            names_size += name.size() + 1;
+        }
+
+        const auto publics_offset = sizeof(AmxHeader);
+        const auto natives_offset = publics_offset + publics.size() * sizeof(AmxFuncStubNt);
+        const auto names_offset = natives_offset + natives.size() * sizeof(AmxFuncStubNt);
+        const auto code_offset = (names_offset + names_size + sizeof(cell) - 1) & ~(sizeof(cell) - 1);
+        const auto data_offset = code_offset + code.size() * sizeof(cell);
+        const auto stack_top = data_offset + memory_cells * sizeof(cell);
+
+        std::vector<cell> image(stack_top / sizeof(cell));
+        auto* const bytes = reinterpret_cast<unsigned char*>(image.data());
+        auto* const header = reinterpret_cast<AmxHeader*>(bytes);
+
+        header->size = static_cast<std::int32_t>(data_offset);
+        header->magic = AMX_MAGIC;
+        header->file_version = std::byte{8};
+        header->amx_version = std::byte{8};
+        header->definition_size = sizeof(AmxFuncStubNt);
+        header->cod = static_cast<std::int32_t>(code_offset);
+        header->dat = static_cast<std::int32_t>(data_offset);
+        header->hea = static_cast<std::int32_t>(data_offset);
+        header->stp = static_cast<std::int32_t>(stack_top);
+        header->cip = -1;
+        header->publics = static_cast<std::int32_t>(publics_offset);
+        header->natives = static_cast<std::int32_t>(natives_offset);
+        header->libraries = static_cast<std::int32_t>(names_offset);
+        header->public_vars = static_cast<std::int32_t>(names_offset);
+        header->tags = static_cast<std::int32_t>(names_offset);
+        header->name_table = static_cast<std::int32_t>(names_offset);
+
+        const std::uint16_t max_name_length = 31;
+        std::memcpy(bytes + names_offset, &max_name_length, sizeof(max_name_length));
+        auto name_offset = names_offset + sizeof(max_name_length);
+
+        const auto write_entry = [&](const std::size_t entry, const std::string& name, const cell address) {
+            const AmxFuncStubNt stub{static_cast<ucell>(address), static_cast<ucell>(name_offset)};
+            std::memcpy(bytes + entry, &stub, sizeof(stub));
+            std::memcpy(bytes + name_offset, name.c_str(), name.size() + 1);
+            name_offset += name.size() + 1;
+        };
+
+        for (std::size_t i = 0; i < publics.size(); ++i) {
+            write_entry(publics_offset + i * sizeof(AmxFuncStubNt), publics[i].first, publics[i].second);
+        }
+
+        for (std::size_t i = 0; i < natives.size(); ++i) {
+            write_entry(natives_offset + i * sizeof(AmxFuncStubNt), natives[i], 0);
+        }
+
+        std::memcpy(bytes + code_offset, code.data(), code.size() * sizeof(cell));
+
+        return image;
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_host_test.h"
+#include <amxx/amx_index.h>
+#include <string>
+#include <vector>
+
+using namespace amxx;
+
+namespace
+{
+    using AmxIndexTest = test::FakeHostTest;
+}
+
+TEST_F(AmxIndexTest, FindsEveryPublicAndNativeLikeTheCore)
+{
+    std::vector<host::FakePublicInfo> publics{};
+    std::vector<std::string> names{};
+
+    // Enough names to make the probes wrap around the table.
+    for (auto i = 0; i < 40; ++i) {
+        names.push_back("on_event_" + std::to_string(i));
+    }
+
+    for (const auto& name : names) {
+        publics.push_back({name.c_str(), [](Amx*, cell*) { return 0; }});
+    }
+
+    auto* const amx = host::AddPlugin("index.amxx", publics, {"get_user_name", "set_task"});
+    ASSERT_NE(amx, nullptr);
+
+    const auto& index = GetAmxIndex(amx);
+    ASSERT_EQ(index.PublicCount(), 40);
+    ASSERT_EQ(index.NativeCount(), 2);
+    EXPECT_EQ(index.GetAmx(), amx);
+
+    for (const auto& name : names) {
+        auto expected = -1;
+        ASSERT_EQ(AmxFindPublic(amx, name.c_str(), &expected), static_cast<int>(AmxError::None));
+        EXPECT_EQ(index.FindPublic(name), expected) << name;
+        EXPECT_EQ(index.PublicName(expected), name);
+    }
+
+    auto expected = -1;
+    ASSERT_EQ(AmxFindNative(amx, "set_task", &expected), static_cast<int>(AmxError::None));
+    EXPECT_EQ(FindNativeIndex(amx, "set_task"), expected);
+    EXPECT_STREQ(index.NativeName(expected), "set_task");
+}
+
+TEST_F(AmxIndexTest, DoesNotMatchPrefixesOrMissingNames)
+{
+    auto* const amx = host::AddPlugin("prefix.amxx", {{"on_event", [](Amx*, cell*) { return 0; }}});
+    ASSERT_NE(amx, nullptr);
+
+    EXPECT_EQ(FindPublicIndex(amx, "on_event"), 0);
+    EXPECT_EQ(FindPublicIndex(amx, "on_even"), -1);
+    EXPECT_EQ(FindPublicIndex(amx, "on_event_post"), -1);
+    EXPECT_EQ(FindPublicIndex(amx, ""), -1);
+    EXPECT_EQ(FindNativeIndex(amx, "on_event"), -1);
+}
+
+TEST_F(AmxIndexTest, IsRebuiltAfterARelease)
+{
+    auto* const amx = host::AddPlugin("release.amxx", {{"first", [](Amx*, cell*) { return 0; }}});
+    ASSERT_NE(amx, nullptr);
+
+    EXPECT_EQ(FindPublicIndex(amx, "first"), 0);
+    ReleaseAmxIndex(amx);
+    EXPECT_EQ(FindPublicIndex(amx, "first"), 0);
+
+    ReleaseAmxIndices();
+    EXPECT_EQ(GetAmxIndex(amx).PublicCount(), 1);
+}
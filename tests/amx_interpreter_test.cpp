@@ -0,0 +1,219 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "amx_image.h"
+#include "fake_host_test.h"
+#include <amxx/amx_interpreter.h>
+#include <amxx/native.h>
+#include <amxx/plugin_local.h>
+#include <amxx/public_call.h>
+#include <climits>
+#include <initializer_list>
+#include <vector>
+
+using namespace amxx;
+using amx::Opcode;
+
+namespace
+{
+    int Twice(const int value)
+    {
+        return value * 2;
+    }
+
+    constexpr AmxNativeInfo NATIVES[] = {MakeNative<&Twice>("twice"), {nullptr, nullptr}};
+
+    class AmxInterpreterTest : public test::FakeHostTest
+    {
+    protected:
+        static void SetUpTestSuite()
+        {
+            AddNatives(NATIVES);
+        }
+
+        void SetUp() override
+        {
+            test::AmxAssembler code{};
+            code.Emit(Opcode::Halt, 0);
+
+            // add(a, b): return a + b
+            const auto add = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::LoadSPri, 12);
+            code.Emit(Opcode::LoadSAlt, 16);
+            code.Emit(Opcode::Add);
+            code.Emit(Opcode::Retn);
+
+            // sum(n): for (new i = 0; i < n; ++i) total += i
+            const auto sum = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::ZeroPri);
+            code.Emit(Opcode::PushPri);
+            code.Emit(Opcode::PushPri);
+            const auto loop = code.Here();
+            code.Emit(Opcode::LoadSPri, -8);
+            code.Emit(Opcode::LoadSAlt, 12);
+            code.Emit(Opcode::Jsgeq, 0);
+            const auto exit_operand = code.Code().size() - 1;
+            code.Emit(Opcode::LoadSPri, -4);
+            code.Emit(Opcode::LoadSAlt, -8);
+            code.Emit(Opcode::Add);
+            code.Emit(Opcode::StorSPri, -4);
+            code.Emit(Opcode::IncS, -8);
+            code.Emit(Opcode::Jump, loop);
+            const auto exit = code.Here();
+            code.Emit(Opcode::LoadSPri, -4);
+            code.Emit(Opcode::Stack, 8);
+            code.Emit(Opcode::Retn);
+
+            // call_twice(n): return twice(n) + 1
+            const auto call_twice = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::PushS, 12);
+            code.Emit(Opcode::PushC, 4);
+            code.Emit(Opcode::SysreqC, 0);
+            code.Emit(Opcode::Stack, 8);
+            code.Emit(Opcode::AddC, 1);
+            code.Emit(Opcode::Retn);
+
+            // divide(a, b): return a / b * 10 + a % b, with floored division
+            const auto divide = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::LoadSPri, 12);
+            code.Emit(Opcode::LoadSAlt, 16);
+            code.Emit(Opcode::Sdiv);
+            code.Emit(Opcode::SmulC, 10);
+            code.Emit(Opcode::Add);
+            code.Emit(Opcode::Retn);
+
+            // quotient(a, b): return a / b, through the operand-swapped form
+            const auto quotient = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::LoadSPri, 16);
+            code.Emit(Opcode::LoadSAlt, 12);
+            code.Emit(Opcode::SdivAlt);
+            code.Emit(Opcode::Retn);
+
+            // out_of_bounds(): array[10] of a 6-element array
+            const auto out_of_bounds = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::ConstPri, 10);
+            code.Emit(Opcode::Bounds, 5);
+            code.Emit(Opcode::Retn);
+
+            auto image_code = code.Code();
+            image_code[exit_operand] = exit;
+
+            amx_ = host::LoadPlugin("interpreter.amxx",
+                                    test::BuildAmxImage({{"add", add},
+                                                         {"call_twice", call_twice},
+                                                         {"divide", divide},
+                                                         {"out_of_bounds", out_of_bounds},
+                                                         {"quotient", quotient},
+                                                         {"sum", sum}},
+                                                        {"twice"}, image_code));
+            ASSERT_NE(amx_, nullptr);
+        }
+
+        /**
+         * @brief Pushes \c args in the order Pawn does (last first) and runs the public \c name.
+        */
+        AmxError Run(const char* const name, const std::initializer_list<cell> args, cell& result)
+        {
+            const std::vector<cell> values{args};
+
+            for (auto it = values.rbegin(); it != values.rend(); ++it) {
+                AmxPush(amx_, *it);
+            }
+
+            return static_cast<AmxError>(AmxExec(amx_, &result, FindPublicIndex(amx_, name)));
+        }
+
+        cell Run(const char* const name, const std::initializer_list<cell> args)
+        {
+            cell result{};
+            EXPECT_EQ(Run(name, args, result), AmxError::None) << name;
+
+            return result;
+        }
+
+        Amx* amx_{};
+    };
+}
+
+TEST_F(AmxInterpreterTest, LoadsTheImage)
+{
+    ASSERT_NE(amx::GetInterpreter(amx_), nullptr);
+    EXPECT_EQ(amx::GetInterpreter(amx_)->UnboundNativeCount(), 0U);
+    EXPECT_EQ(FindPublicIndex(amx_, "add"), 0);
+    EXPECT_EQ(FindPublicIndex(amx_, "sum"), 5);
+}
+
+TEST_F(AmxInterpreterTest, SharesTheUserDataSlotWithPluginLocals)
+{
+    PluginLocal<int> values{};
+    values.Get(amx_) = 5;
+
+    EXPECT_EQ(amx_->user_tags[0], detail::PLUGIN_LOCAL_TAG);
+    EXPECT_EQ(Run("add", {1, 2}), 3);
+    EXPECT_EQ(*values.Find(amx_), 5);
+}
+
+TEST_F(AmxInterpreterTest, RunsArithmeticAndLoops)
+{
+    const auto stack = amx_->stk;
+    const auto heap = amx_->hea;
+
+    EXPECT_EQ(Run("add", {3, 4}), 7);
+    EXPECT_EQ(Run("sum", {10}), 45);
+    EXPECT_EQ(Run("sum", {0}), 0);
+    EXPECT_EQ(amx_->stk, stack);
+    EXPECT_EQ(amx_->hea, heap);
+
+    PublicCall<int(int, int)> call{};
+    ASSERT_TRUE(call.Bind(amx_, "add"));
+    EXPECT_EQ(call(20, 22), 42);
+}
+
+TEST_F(AmxInterpreterTest, CallsNatives)
+{
+    EXPECT_EQ(Run("call_twice", {5}), 11);
+    EXPECT_EQ(Run("call_twice", {-3}), -5);
+}
+
+TEST_F(AmxInterpreterTest, DividesWithFlooring)
+{
+    EXPECT_EQ(Run("divide", {7, 2}), 31);
+    EXPECT_EQ(Run("divide", {-7, 2}), -39);
+    EXPECT_EQ(Run("divide", {7, -2}), -41);
+    EXPECT_EQ(Run("divide", {-7, -2}), 29);
+    EXPECT_EQ(Run("quotient", {9, -1}), -9);
+    EXPECT_EQ(Run("quotient", {INT_MIN, -1}), INT_MIN);
+
+    cell result{};
+    EXPECT_EQ(Run("quotient", {1, 0}, result), AmxError::Divide);
+}
+
+TEST_F(AmxInterpreterTest, ReportsOutOfBoundsIndexes)
+{
+    const auto stack = amx_->stk;
+    cell result{};
+
+    EXPECT_EQ(Run("out_of_bounds", {}, result), AmxError::Bounds);
+    EXPECT_EQ(amx_->stk, stack);
+    EXPECT_EQ(Run("add", {1, 2}), 3);
+}
@@ -0,0 +1,172 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/amx.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Runs every kernel at one level; the lengths cover empty input, the vector tails and the unrolled bodies.
+    */
+    class AmxSimdTest : public testing::TestWithParam<amx::simd::Level>
+    {
+    protected:
+        void SetUp() override
+        {
+            previous_ = amx::simd::ActiveLevel();
+
+            if (amx::simd::SetLevel(GetParam()) != GetParam()) {
+                amx::simd::SetLevel(previous_);
+                GTEST_SKIP() << "The CPU does not support this kernel level.";
+            }
+        }
+
+        void TearDown() override
+        {
+            amx::simd::SetLevel(previous_);
+        }
+
+        static constexpr std::size_t LENGTHS[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 100, 257};
+
+    private:
+        amx::simd::Level previous_{};
+    };
+
+    std::vector<cell> MakeCells(const std::size_t count)
+    {
+        std::vector<cell> cells(count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            cells[i] = static_cast<cell>(i * 37 % 251) - 120;
+        }
+
+        return cells;
+    }
+}
+
+TEST_P(AmxSimdTest, CellStringLength)
+{
+    for (const auto length : LENGTHS) {
+        std::vector<cell> string(length + 40, 'a');
+        string[length] = 0;
+
+        EXPECT_EQ(amx::simd::CellStringLength(string.data(), string.size()), length);
+        EXPECT_EQ(amx::simd::CellStringLength(string.data(), length / 2), length / 2);
+    }
+}
+
+TEST_P(AmxSimdTest, NarrowAndWiden)
+{
+    for (const auto length : LENGTHS) {
+        std::string chars(length, '\0');
+
+        for (std::size_t i = 0; i < length; ++i) {
+            chars[i] = static_cast<char>(i * 7 + 1);
+        }
+
+        std::vector<cell> cells(length + 1, -1);
+        amx::simd::WidenChars(cells.data(), chars.data(), length);
+
+        for (std::size_t i = 0; i < length; ++i) {
+            ASSERT_EQ(cells[i], static_cast<cell>(chars[i])) << "length " << length << ", index " << i;
+        }
+
+        EXPECT_EQ(cells[length], -1);
+
+        amx::simd::WidenBytes(cells.data(), chars.data(), length);
+
+        for (std::size_t i = 0; i < length; ++i) {
+            ASSERT_EQ(cells[i], static_cast<cell>(static_cast<unsigned char>(chars[i]))) << "length " << length;
+        }
+
+        std::string narrowed(length, '\0');
+        amx::simd::NarrowCells(narrowed.data(), cells.data(), length);
+        EXPECT_EQ(narrowed, chars);
+    }
+}
+
+TEST_P(AmxSimdTest, ValidateUtf8)
+{
+    const std::string valid = std::string(40, 'a') + "\xD0\xBF\xD1\x80\xD0\xB8\xE2\x82\xAC\xF0\x9F\x98\x80" + std::string(40, 'z');
+    EXPECT_TRUE(amx::simd::ValidateUtf8(valid.data(), valid.size()));
+    EXPECT_TRUE(amx::simd::ValidateUtf8(valid.data(), 0));
+
+    for (const auto* const invalid : {"\x80", "\xC0\xAF", "\xE2\x82", "\xED\xA0\x80", "\xF5\x80\x80\x80"}) {
+        const auto string = std::string(33, 'a') + invalid + std::string(33, 'b');
+        EXPECT_FALSE(amx::simd::ValidateUtf8(string.data(), string.size())) << "offset 33";
+        EXPECT_FALSE(amx::simd::ValidateUtf8(invalid, std::char_traits<char>::length(invalid))) << "offset 0";
+    }
+}
+
+TEST_P(AmxSimdTest, CopyAndFill)
+{
+    for (const auto length : LENGTHS) {
+        const auto source = MakeCells(length + 1);
+        std::vector<cell> dest(length + 1, 5);
+
+        amx::simd::CopyCells(dest.data(), source.data(), length);
+        EXPECT_TRUE(std::equal(source.begin(), source.begin() + static_cast<std::ptrdiff_t>(length), dest.begin()));
+        EXPECT_EQ(dest[length], 5);
+
+        amx::simd::FillCells(dest.data(), -9, length);
+        EXPECT_EQ(static_cast<std::size_t>(std::count(dest.begin(), dest.end(), -9)), length);
+        EXPECT_EQ(dest[length], 5);
+    }
+}
+
+TEST_P(AmxSimdTest, CompareFindAndCount)
+{
+    for (const auto length : LENGTHS) {
+        const auto first = MakeCells(length);
+        auto second = first;
+
+        EXPECT_EQ(amx::simd::CompareCells(first.data(), second.data(), length), length);
+        EXPECT_EQ(amx::simd::FindCell(first.data(), 1000, length), length);
+
+        if (length == 0) {
+            continue;
+        }
+
+        const auto index = length * 2 / 3;
+        second[index] += 1;
+        EXPECT_EQ(amx::simd::CompareCells(first.data(), second.data(), length), index);
+
+        const auto expected_find = static_cast<std::size_t>(std::find(first.begin(), first.end(), first[index]) - first.begin());
+        EXPECT_EQ(amx::simd::FindCell(first.data(), first[index], length), expected_find);
+
+        const auto expected_count = static_cast<std::size_t>(std::count(first.begin(), first.end(), first[index]));
+        EXPECT_EQ(amx::simd::CountCell(first.data(), first[index], length), expected_count);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Levels, AmxSimdTest,
+                         testing::Values(amx::simd::Level::Scalar, amx::simd::Level::Sse2, amx::simd::Level::Avx2),
+                         [](const testing::TestParamInfo<amx::simd::Level>& info) -> std::string {
+                             switch (info.param) {
+                             case amx::simd::Level::Sse2:
+                                 return "Sse2";
+                             case amx::simd::Level::Avx2:
+                                 return "Avx2";
+                             default:
+                                 return "Scalar";
+                             }
+                         });
@@ -0,0 +1,160 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "amx_image.h"
+#include "fake_host_test.h"
+#include <amxx/amxx_file.h>
+#include <amxx/public_call.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef HAS_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace amxx;
+using amx::Opcode;
+
+namespace
+{
+    class AmxxFileTest : public test::FakeHostTest
+    {
+    protected:
+        void SetUp() override
+        {
+            // answer(): return 42
+            test::AmxAssembler code{};
+            code.Emit(Opcode::Halt, 0);
+            const auto answer = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::ConstPri, 42);
+            code.Emit(Opcode::Retn);
+
+            image_ = test::BuildAmxImage({{"answer", answer}}, {}, code.Code(), 256);
+        }
+
+        [[nodiscard]] const AmxHeader& Header() const
+        {
+            return *reinterpret_cast<const AmxHeader*>(image_.data());
+        }
+
+        /**
+         * @brief The file holds the image up to the end of the data section; the loader adds the heap and stack.
+        */
+        [[nodiscard]] std::string FileBytes() const
+        {
+            return {reinterpret_cast<const char*>(image_.data()), static_cast<std::size_t>(Header().size)};
+        }
+
+        static std::string WriteFile(const char* const name, const std::string& bytes)
+        {
+            auto path = testing::TempDir() + name;
+            std::ofstream{path, std::ios::binary}.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+            return path;
+        }
+
+        static void ExpectAnswer(Amx* const amx)
+        {
+            ASSERT_NE(amx, nullptr) << (host::Messages().empty() ? "" : host::Messages().back());
+
+            PublicCall<int()> call{};
+            ASSERT_TRUE(call.Bind(amx, "answer"));
+            EXPECT_EQ(call(), 42);
+        }
+
+        std::vector<cell> image_{};
+    };
+}
+
+TEST_F(AmxxFileTest, LoadsAPlainAmxFile)
+{
+    const auto path = WriteFile("amxx_file_test.amx", FileBytes());
+
+    const amx::AmxxFile file{path.c_str()};
+    ASSERT_TRUE(file.IsOpen()) << file.ErrorText();
+    EXPECT_TRUE(file.IsPlain());
+
+    std::vector<cell> image{};
+    ASSERT_EQ(file.Load(image), AmxError::None) << file.ErrorText();
+    EXPECT_EQ(image.size() * sizeof(cell), static_cast<std::size_t>(Header().stp));
+
+    ExpectAnswer(host::LoadPluginFile(path.c_str()));
+}
+
+#ifdef HAS_ZLIB
+TEST_F(AmxxFileTest, LoadsTheSectionForOurCellSize)
+{
+    const auto bytes = FileBytes();
+    auto compressed_size = compressBound(static_cast<uLong>(bytes.size()));
+    std::string compressed(compressed_size, '\0');
+    ASSERT_EQ(compress(reinterpret_cast<Bytef*>(compressed.data()), &compressed_size,
+                       reinterpret_cast<const Bytef*>(bytes.data()), static_cast<uLong>(bytes.size())),
+              Z_OK);
+    compressed.resize(compressed_size);
+
+    const amx::AmxxFileHeader header{amx::AMXX_FILE_MAGIC, amx::AMXX_FILE_VERSION, 2};
+    const auto offset = static_cast<std::int32_t>(sizeof(header) + 2 * sizeof(amx::AmxxSection));
+
+    // A section for another cell size comes first and must be skipped.
+    const amx::AmxxSection other{8, 10, 200, 300, 0};
+    const amx::AmxxSection ours{static_cast<std::int8_t>(sizeof(cell)), static_cast<std::int32_t>(compressed.size()),
+                                static_cast<std::int32_t>(bytes.size()), Header().stp, offset};
+
+    std::string container{};
+    container.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    container.append(reinterpret_cast<const char*>(&other), sizeof(other));
+    container.append(reinterpret_cast<const char*>(&ours), sizeof(ours));
+    container += compressed;
+
+    const auto path = WriteFile("amxx_file_test.amxx", container);
+
+    const amx::AmxxFile file{path.c_str()};
+    ASSERT_TRUE(file.IsOpen()) << file.ErrorText();
+    EXPECT_FALSE(file.IsPlain());
+    EXPECT_EQ(file.SectionCount(), 2);
+    ASSERT_NE(file.FindSection(), nullptr);
+
+    // Copied out: gtest binds its arguments by reference and the section is packed.
+    const std::int32_t section_offset = file.FindSection()->offset;
+    EXPECT_EQ(section_offset, offset);
+
+    ExpectAnswer(host::LoadPluginFile(path.c_str()));
+}
+#endif
+
+TEST_F(AmxxFileTest, RejectsDamagedImages)
+{
+    auto bytes = FileBytes();
+    const auto truncated = WriteFile("amxx_file_test_truncated.amx", bytes.substr(0, bytes.size() / 2));
+
+    reinterpret_cast<AmxHeader*>(bytes.data())->cod = -4;
+    const auto corrupt = WriteFile("amxx_file_test_corrupt.amx", bytes);
+
+    host::ClearMessages();
+    EXPECT_EQ(host::LoadPluginFile(truncated.c_str()), nullptr);
+    EXPECT_EQ(host::LoadPluginFile(corrupt.c_str()), nullptr);
+    EXPECT_EQ(host::LoadPluginFile((testing::TempDir() + "amxx_file_test_missing.amx").c_str()), nullptr);
+    EXPECT_EQ(host::Messages().size(), 3U);
+    EXPECT_EQ(host::PluginCount(), 0);
+
+
+    EXPECT_EQ(amx::ValidateHeader(Header(), image_.size() * sizeof(cell)), AmxError::None);
+    EXPECT_NE(amx::ValidateHeader(Header(), image_.size() * sizeof(cell) / 2), AmxError::None);
+}
@@ -0,0 +1,99 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_host_test.h"
+#include <amxx/api.h>
+#include <string>
+
+using namespace amxx;
+
+namespace
+{
+    class ApiResolveTest : public test::FakeHostTest
+    {
+    protected:
+        void TearDown() override
+        {
+            host::EnableFunctions();
+
+            if (GetApiResolveInfo().missing_required) {
+                host::DetachModule();
+                ASSERT_EQ(host::AttachModule(host::LinkedModule()), Status::Ok);
+            }
+
+            FakeHostTest::TearDown();
+        }
+
+        /**
+         * @brief Attaches the module again, with \c name missing from the host if it is set.
+        */
+        static Status Reattach(const char* const name = nullptr)
+        {
+            host::DetachModule();
+
+            if (name) {
+                host::DisableFunction(name);
+            }
+
+            host::ClearMessages();
+
+            return host::AttachModule(host::LinkedModule());
+        }
+
+        static bool Logged(const std::string& text)
+        {
+            for (const auto& message : host::Messages()) {
+                if (message.find(text) != std::string::npos) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+    };
+}
+
+TEST_F(ApiResolveTest, LogsTheResolveSummaryAtAttach)
+{
+    ASSERT_EQ(Reattach(), Status::Ok);
+
+    const auto& info = GetApiResolveInfo();
+    EXPECT_EQ(info.missing_optional, 0);
+    EXPECT_EQ(info.missing_required, nullptr);
+    EXPECT_TRUE(Logged("Resolved " + std::to_string(info.resolved) + " AMXX functions in "));
+    EXPECT_TRUE(Logged("0 optional missing."));
+}
+
+#ifndef AMXX_182_COMPATIBILITY
+TEST_F(ApiResolveTest, AttachesWithoutOptionalFunctionsAndLogsThem)
+{
+    ASSERT_EQ(Reattach("GetConfigManager"), Status::Ok);
+
+    const auto& info = GetApiResolveInfo();
+    EXPECT_EQ(info.missing_optional, 1);
+    EXPECT_EQ(info.missing_required, nullptr);
+    EXPECT_GT(info.resolved, 0);
+    EXPECT_TRUE(Logged("1 optional missing: GetConfigManager."));
+}
+#endif
+
+TEST_F(ApiResolveTest, RefusesToAttachWithoutARequiredFunction)
+{
+    EXPECT_EQ(Reattach("amx_Exec"), Status::FuncNotPresent);
+    EXPECT_STREQ(GetApiResolveInfo().missing_required, "amx_Exec");
+    EXPECT_TRUE(Logged("\"amx_Exec\" is not available"));
+}
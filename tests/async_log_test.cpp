@@ -0,0 +1,132 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_ASYNC_LOG
+
+#include "fake_host_test.h"
+#include <amxx/async_log.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace amxx;
+
+namespace
+{
+    class AsyncLogTest : public test::FakeHostTest
+    {
+    protected:
+        void SetUp() override
+        {
+            path_ = testing::TempDir() + "async_log_test.log";
+            std::remove(path_.c_str());
+        }
+
+        void TearDown() override
+        {
+            StopAsyncLog();
+            std::remove(path_.c_str());
+            FakeHostTest::TearDown();
+        }
+
+        /**
+         * @brief Stops the logger, so everything queued is written, and reads the file back.
+        */
+        std::string StopAndRead() const
+        {
+            StopAsyncLog();
+
+            std::stringstream text{};
+            text << std::ifstream{path_}.rdbuf();
+
+            return text.str();
+        }
+
+        /**
+         * @brief True if a message written through the host's \c Log contains \c text.
+        */
+        static bool Logged(const std::string& text)
+        {
+            for (const auto& message : host::Messages()) {
+                if (message.find(text) != std::string::npos) {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        std::string path_{};
+    };
+}
+
+TEST_F(AsyncLogTest, FallsBackToLogWhenStopped)
+{
+    auto* const amx = host::AddPlugin("logging.amxx", {});
+
+    EXPECT_FALSE(AsyncLogRunning());
+    AsyncLog("direct %d", 1);
+    AsyncLogError(amx, "failed %s", "here");
+
+    EXPECT_TRUE(Logged("direct 1"));
+    EXPECT_TRUE(Logged("[logging.amxx] failed here"));
+}
+
+TEST_F(AsyncLogTest, WritesQueuedMessagesAndCollapsesRepeats)
+{
+    auto* const amx = host::AddPlugin("logging.amxx", {});
+
+    ASSERT_TRUE(StartAsyncLog(path_.c_str()));
+    EXPECT_TRUE(AsyncLogRunning());
+    EXPECT_FALSE(StartAsyncLog(path_.c_str()));
+
+    AsyncLog("first %d", 1);
+
+    for (auto i = 0; i < 3; ++i) {
+        AsyncLogError(amx, "same error");
+    }
+
+    const auto log = StopAndRead();
+    EXPECT_FALSE(AsyncLogRunning());
+    EXPECT_NE(log.find("first 1\n"), std::string::npos) << log;
+    EXPECT_NE(log.find("[logging.amxx] same error\n"), std::string::npos) << log;
+    EXPECT_NE(log.find("[logging.amxx] Last message repeated 2 times\n"), std::string::npos) << log;
+    EXPECT_FALSE(Logged("first 1"));
+}
+
+TEST_F(AsyncLogTest, RateLimitsEachCallSite)
+{
+    AsyncLogOptions options{};
+    options.messages_per_second = 2;
+    ASSERT_TRUE(StartAsyncLog(path_.c_str(), options));
+
+    for (auto i = 0; i < 5; ++i) {
+        AsyncLog("storm %d", i);
+    }
+
+    AsyncLog("other site");
+    EXPECT_EQ(AsyncLogDropped(), 3U);
+
+    const auto log = StopAndRead();
+    EXPECT_NE(log.find("storm 1\n"), std::string::npos) << log;
+    EXPECT_EQ(log.find("storm 2\n"), std::string::npos) << log;
+    EXPECT_NE(log.find("other site\n"), std::string::npos) << log;
+    EXPECT_NE(log.find("3 messages suppressed by the rate limit, last: storm 1\n"), std::string::npos) << log;
+}
+
+#endif
@@ -0,0 +1,201 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_ASYNC_NATIVES
+
+#include "amx_image.h"
+#include "fake_host_test.h"
+#include <amxx/amx_heap.h>
+#include <amxx/amx_index.h>
+#include <amxx/async_native.h>
+#include <chrono>
+#include <thread>
+
+using namespace amxx;
+using amx::Opcode;
+
+namespace
+{
+    int g_resumed{};
+    AmxError g_resume_error{};
+    cell g_resume_value{};
+
+    void OnResumed(Amx*, const AmxError error, const cell return_val)
+    {
+        ++g_resumed;
+        g_resume_error = error;
+        g_resume_value = return_val;
+    }
+
+    /**
+     * @brief slow_length(const text[]): the length of \c text, counted on the task pool.
+    */
+    cell AMX_NATIVE_CALL SlowLength(Amx* const amx, cell* const params)
+    {
+        return SuspendAmx(amx, [text = amx::GetString(amx, params[1])] { return static_cast<cell>(text.size()); });
+    }
+
+    /**
+     * @brief run_measure(): runs the public measure of the calling plugin and returns its result.
+    */
+    cell AMX_NATIVE_CALL RunMeasure(Amx* const amx, cell*)
+    {
+        cell result{};
+        AmxExec(amx, &result, FindPublicIndex(amx, "measure"));
+
+        return result;
+    }
+
+    constexpr AmxNativeInfo NATIVES[] = {{"slow_length", SlowLength}, {"run_measure", RunMeasure}, {nullptr, nullptr}};
+
+    class AsyncNativeTest : public test::FakeHostTest
+    {
+    protected:
+        static void SetUpTestSuite()
+        {
+            AddNatives(NATIVES);
+        }
+
+        void SetUp() override
+        {
+            test::AmxAssembler code{};
+            code.Emit(Opcode::Halt, 0);
+
+            // measure(): new text[] = "abc"; return slow_length(text) + 100
+            const auto measure = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::PushC, 0);
+            code.Emit(Opcode::PushC, 'c');
+            code.Emit(Opcode::PushC, 'b');
+            code.Emit(Opcode::PushC, 'a');
+            code.Emit(Opcode::AddrPri, -16);
+            code.Emit(Opcode::PushPri);
+            code.Emit(Opcode::PushC, 4);
+            code.Emit(Opcode::SysreqC, 0);
+            code.Emit(Opcode::Stack, 8);
+            code.Emit(Opcode::AddC, 100);
+            code.Emit(Opcode::Stack, 16);
+            code.Emit(Opcode::Retn);
+
+            // measure_arg(const text[]): return slow_length(text)
+            const auto measure_arg = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::PushS, 12);
+            code.Emit(Opcode::PushC, 4);
+            code.Emit(Opcode::SysreqC, 0);
+            code.Emit(Opcode::Stack, 8);
+            code.Emit(Opcode::Retn);
+
+            // nested(): return run_measure()
+            const auto nested = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::PushC, 0);
+            code.Emit(Opcode::SysreqC, 1);
+            code.Emit(Opcode::Stack, 4);
+            code.Emit(Opcode::Retn);
+
+            amx_ = host::LoadPlugin("async.amxx",
+                                    test::BuildAmxImage({{"measure", measure}, {"measure_arg", measure_arg}, {"nested", nested}},
+                                                        {"slow_length", "run_measure"}, code.Code()));
+            ASSERT_NE(amx_, nullptr);
+
+            g_resumed = 0;
+            SetAmxResumeHandler(OnResumed);
+            ASSERT_TRUE(StartTaskPool(1));
+        }
+
+        void TearDown() override
+        {
+            StopTaskPool();
+            SetAmxResumeHandler(nullptr);
+            FakeHostTest::TearDown();
+        }
+
+        /**
+         * @brief Runs the completions until the suspended call of the plugin has been resumed.
+        */
+        void WaitForResume() const
+        {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+
+            while (IsAmxSuspended(amx_) && std::chrono::steady_clock::now() < deadline) {
+                RunTaskCompletions();
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+        }
+
+        /**
+         * @brief Runs \c measure_arg with \c text on the heap through \c AmxExecSuspendable.
+        */
+        AmxError MeasureArgument(const char* const text, cell& result) const
+        {
+            AmxHeapScope heap{amx_};
+            AmxPush(amx_, heap.AllocateString(text).address);
+
+            return AmxExecSuspendable(amx_, &result, FindPublicIndex(amx_, "measure_arg"));
+        }
+
+        Amx* amx_{};
+    };
+}
+
+TEST_F(AsyncNativeTest, ResumesAPublicWithAStringOnItsStack)
+{
+    cell result{};
+    ASSERT_EQ(AmxExecSuspendable(amx_, &result, FindPublicIndex(amx_, "measure")), AmxError::Sleep);
+    EXPECT_TRUE(IsAmxSuspended(amx_));
+
+    // Another public runs while the first sleeps; it cannot suspend and leaves the sleeping stack alone.
+    cell length{};
+    EXPECT_EQ(MeasureArgument("xy", length), AmxError::None);
+    EXPECT_EQ(length, 2);
+
+    WaitForResume();
+    ASSERT_EQ(g_resumed, 1);
+    EXPECT_EQ(g_resume_error, AmxError::None);
+    EXPECT_EQ(g_resume_value, 103);
+    EXPECT_EQ(amx_->stk, amx_->stp);
+    EXPECT_EQ(amx_->hea, amx_->hlw);
+}
+
+TEST_F(AsyncNativeTest, RunsPublicsWithHeapArgumentsRightAway)
+{
+    cell result{};
+    EXPECT_EQ(MeasureArgument("hello", result), AmxError::None);
+    EXPECT_EQ(result, 5);
+    EXPECT_FALSE(IsAmxSuspended(amx_));
+    EXPECT_EQ(amx_->hea, amx_->hlw);
+}
+
+TEST_F(AsyncNativeTest, DoesNotSuspendPublicsItDidNotRun)
+{
+    cell result{};
+    EXPECT_EQ(static_cast<AmxError>(AmxExec(amx_, &result, FindPublicIndex(amx_, "measure"))), AmxError::None);
+    EXPECT_EQ(result, 103);
+    EXPECT_FALSE(IsAmxSuspended(amx_));
+    EXPECT_EQ(g_resumed, 0);
+}
+
+TEST_F(AsyncNativeTest, DoesNotSuspendPublicsRunByANative)
+{
+    cell result{};
+    EXPECT_EQ(AmxExecSuspendable(amx_, &result, FindPublicIndex(amx_, "nested")), AmxError::None);
+    EXPECT_EQ(result, 103);
+    EXPECT_FALSE(IsAmxSuspended(amx_));
+}
+
+#endif
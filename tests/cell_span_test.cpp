@@ -0,0 +1,109 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_host_test.h"
+#include <amxx/amx_heap.h>
+#include <amxx/cell_span.h>
+#include <numeric>
+#include <vector>
+
+using namespace amxx;
+
+namespace
+{
+    class CellSpanTest : public test::FakeHostTest
+    {
+    protected:
+        void SetUp() override
+        {
+            amx_ = host::AddPlugin("span.amxx", {});
+            ASSERT_NE(amx_, nullptr);
+        }
+
+        Amx* amx_{};
+    };
+}
+
+TEST_F(CellSpanTest, ViewsAPluginArray)
+{
+    AmxHeapScope heap{amx_};
+    const cell values[] = {1, 2, 3, 4, 5};
+    const auto block = heap.AllocateArray(values, 5);
+
+    const amx::CellSpan span{amx_, block.address, 5};
+    ASSERT_EQ(span.size(), 5U);
+    EXPECT_EQ(std::accumulate(span.begin(), span.end(), 0), 15);
+
+    span[4] = 50;
+    EXPECT_EQ(block.phys[4], 50);
+
+    const amx::ConstCellSpan view = span;
+    const auto tail = view.Subspan(3);
+    ASSERT_EQ(tail.size(), 2U);
+    EXPECT_EQ(tail[1], 50);
+    EXPECT_EQ(view.Subspan(1, 2).size(), 2U);
+    EXPECT_EQ(view.Subspan(4, 10).size(), 1U);
+    EXPECT_TRUE(view.Subspan(5).empty());
+
+    EXPECT_TRUE((amx::CellSpan{amx_, block.address, -3}.empty()));
+}
+
+TEST_F(CellSpanTest, ReadsFloats)
+{
+    AmxHeapScope heap{amx_};
+    const cell values[] = {amx::FloatToCell(1.5f), amx::FloatToCell(-2.f)};
+    const auto block = heap.AllocateArray(values, 2);
+
+    const amx::FloatSpan span{amx_, block.address, 2};
+    EXPECT_FLOAT_EQ(span[0], 1.5f);
+    EXPECT_FLOAT_EQ(span[1], -2.f);
+}
+
+TEST_F(CellSpanTest, WalksTheRowsOfA2DArray)
+{
+    constexpr auto ROWS = 3;
+    constexpr auto COLUMNS = 4;
+
+    // Laid out as the compiler does: a table of row offsets relative to each entry, then the rows.
+    AmxHeapScope heap{amx_};
+    const auto block = heap.Allocate(ROWS + ROWS * COLUMNS);
+
+    for (auto row = 0; row < ROWS; ++row) {
+        block.phys[row] = static_cast<cell>(((ROWS - row) + row * COLUMNS) * sizeof(cell));
+
+        for (auto column = 0; column < COLUMNS; ++column) {
+            block.phys[ROWS + row * COLUMNS + column] = row * 10 + column;
+        }
+    }
+
+    const amx::ConstCellArray2D array{amx_, block.address, ROWS, COLUMNS};
+    EXPECT_EQ(array.Rows(), 3U);
+    EXPECT_EQ(array.Columns(), 4U);
+
+    std::vector<cell> seen{};
+
+    for (const auto row : array) {
+        seen.insert(seen.end(), row.begin(), row.end());
+    }
+
+    EXPECT_EQ(seen, (std::vector<cell>{0, 1, 2, 3, 10, 11, 12, 13, 20, 21, 22, 23}));
+
+    const amx::CellArray2D writable{amx_, block.address, ROWS, COLUMNS};
+    writable[2][3] = 99;
+    EXPECT_EQ(array[2][3], 99);
+    EXPECT_TRUE((amx::CellArray2D{amx_, block.address, 0, COLUMNS}.Empty()));
+}
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <amxx/cell_string.h>
+#include <gtest/gtest.h>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    /**
+     * @brief Zero-terminated cell form of \c text, as a plugin keeps it.
+    */
+    std::vector<cell> ToCells(const std::string_view text)
+    {
+        std::vector<cell> cells(text.begin(), text.end());
+        cells.push_back(0);
+
+        return cells;
+    }
+}
+
+TEST(CellStringTest, ComparesWithoutNarrowing)
+{
+    const auto cells = ToCells("Hello");
+    const amx::CellStringView string{cells.data()};
+
+    ASSERT_EQ(string.size(), 5U);
+    EXPECT_TRUE(string == "Hello");
+    EXPECT_TRUE(string != "Hell");
+    EXPECT_TRUE(string.EqualsIgnoreCase("hELLO"));
+    EXPECT_FALSE(string.EqualsIgnoreCase("hello!"));
+    EXPECT_TRUE(string.StartsWith("He"));
+    EXPECT_FALSE(string.StartsWith("Hello, world"));
+
+    EXPECT_EQ(string.Compare("Hello"), 0);
+    EXPECT_LT(string.Compare("Help"), 0);
+    EXPECT_GT(string.Compare("Hell"), 0);
+    EXPECT_LT(string.Compare("Hello!"), 0);
+}
+
+TEST(CellStringTest, FindsAndSlices)
+{
+    const auto cells = ToCells("key=value");
+    const amx::CellStringView string{cells.data()};
+
+    const auto separator = string.Find('=');
+    ASSERT_EQ(separator, 3U);
+    EXPECT_EQ(string.Find('x'), std::string_view::npos);
+    EXPECT_EQ(string.Substr(0, separator), "key");
+    EXPECT_EQ(string.Substr(separator + 1), "value");
+    EXPECT_TRUE(string.Substr(20).empty());
+}
+
+TEST(CellStringTest, HashesLikeTheNarrowString)
+{
+    const auto cells = ToCells("weapon_ak47");
+    const amx::CellStringView string{cells.data()};
+
+    EXPECT_EQ(string.Hash(), amx::HashString("weapon_ak47"));
+    EXPECT_NE(string.Hash(), amx::HashString("weapon_m4a1"));
+
+    static_assert(amx::HashString("") == 2166136261U);
+}
+
+TEST(CellStringTest, NarrowsIntoBoundedBuffers)
+{
+    const auto cells = ToCells("abcdefgh");
+
+    char buffer[5];
+    EXPECT_EQ(amx::NarrowString(cells.data(), buffer), "abcd");
+    EXPECT_EQ(buffer[4], '\0');
+    EXPECT_EQ(amx::CellStringView{cells.data()}.Narrow(buffer), "abcd");
+    EXPECT_EQ(amx::CellStringView{cells.data()}.ToString(), "abcdefgh");
+
+    char empty[1];
+    EXPECT_TRUE(amx::NarrowString(cells.data(), empty).empty());
+}
+
+TEST(CellStringTest, ArenaWrapsAround)
+{
+    const auto first = ToCells("first");
+    const auto second = ToCells("second");
+    amx::StringArena<16> arena{};
+
+    const auto a = arena.Narrow(first.data());
+    const auto b = arena.Narrow(second.data());
+    EXPECT_EQ(a, "first");
+    EXPECT_EQ(b, "second");
+    EXPECT_NE(a.data(), b.data());
+
+    // "first\0second\0" leaves 3 bytes, so the next string starts over at the front.
+    const auto c = arena.Narrow(first.data());
+    EXPECT_EQ(c, "first");
+    EXPECT_EQ(c.data(), a.data());
+
+    arena.Reset();
+    EXPECT_EQ(arena.Narrow(second.data()).data(), a.data());
+}
@@ -0,0 +1,37 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_host_test.h"
+
+namespace
+{
+    class FakeHostEnvironment final : public testing::Environment
+    {
+    public:
+        void SetUp() override
+        {
+            ASSERT_EQ(amxx::host::AttachModule(amxx::host::LinkedModule()), amxx::Status::Ok);
+        }
+
+        void TearDown() override
+        {
+            amxx::host::DetachModule();
+        }
+    };
+
+    [[maybe_unused]] const auto* const g_environment = testing::AddGlobalTestEnvironment(new FakeHostEnvironment);
+}
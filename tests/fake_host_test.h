@@ -0,0 +1,38 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <amxx/fake_host.h>
+#include <gtest/gtest.h>
+
+namespace amxx::test
+{
+    /**
+     * @brief Fixture of the tests that drive the module through the fake host.
+     * The module is attached once for the whole binary; every test starts without plugins or players.
+    */
+    class FakeHostTest : public testing::Test
+    {
+    protected:
+        void TearDown() override
+        {
+            host::UnloadPlugins();
+            host::ResetState();
+        }
+    };
+}
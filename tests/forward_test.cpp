@@ -0,0 +1,122 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_host_test.h"
+#include <amxx/forward.h>
+#include <string>
+
+using namespace amxx;
+
+namespace
+{
+    using ForwardTest = test::FakeHostTest;
+}
+
+TEST_F(ForwardTest, PassesTypedArgumentsToEveryPlugin)
+{
+    std::string seen[2]{};
+
+    for (auto i = 0; i < 2; ++i) {
+        host::AddPlugin(i ? "b.amxx" : "a.amxx", {{"on_event", [&, i](Amx* amx, cell* params) {
+            seen[i] = std::to_string(params[1]) + " " + std::to_string(amx::CellToFloat(params[2])) + " " +
+                      amx::GetString(amx, params[3]);
+
+            return static_cast<cell>(i + 1);
+        }}});
+    }
+
+    host::PluginsLoaded();
+
+    Forward<int(int, real, const char*)> forward{};
+    ASSERT_TRUE(forward.Register("on_event", ForwardExecType::Continue));
+
+    EXPECT_EQ(forward(7, 0.5f, "text"), 2);
+    EXPECT_EQ(seen[0], "7 0.500000 text");
+    EXPECT_EQ(seen[1], "7 0.500000 text");
+}
+
+TEST_F(ForwardTest, StopsAtThePluginThatHandlesIt)
+{
+    int calls[2]{};
+
+    host::AddPlugin("a.amxx", {{"on_event", [&](Amx*, cell*) {
+        ++calls[0];
+        return 1;
+    }}});
+
+    host::AddPlugin("b.amxx", {{"on_event", [&](Amx*, cell*) {
+        ++calls[1];
+        return 0;
+    }}});
+
+    host::PluginsLoaded();
+
+    Forward<int()> forward{};
+    ASSERT_TRUE(forward.Register("on_event", ForwardExecType::Stop));
+
+    EXPECT_EQ(forward(), 1);
+    EXPECT_EQ(calls[0], 1);
+    EXPECT_EQ(calls[1], 0);
+}
+
+TEST_F(ForwardTest, WritesReferencesAndArraysBack)
+{
+    auto* const amx = host::AddPlugin("ref.amxx", {{"on_ref", [](Amx* plugin, cell* params) {
+        *amx::Address(plugin, params[1]) += 5;
+        *reinterpret_cast<real*>(amx::Address(plugin, params[2])) *= 2.f;
+        amx::Address(plugin, params[3])[1] = 42;
+        amx::SetString(plugin, params[4], "new", 3, 15);
+
+        return 0;
+    }}});
+
+    Forward<int(cell&, real&, ForwardArray, char*)> forward{};
+    ASSERT_TRUE(forward.RegisterSingle(amx, "on_ref"));
+
+    cell value = 10;
+    real scale = 1.25f;
+    cell array[3] = {1, 2, 3};
+    char text[16] = "old";
+    forward(value, scale, MakeForwardArray(array, 3, true), text);
+
+    EXPECT_EQ(value, 15);
+    EXPECT_FLOAT_EQ(scale, 2.5f);
+    EXPECT_EQ(array[1], 42);
+    EXPECT_STREQ(text, "new");
+}
+
+TEST_F(ForwardTest, UnregistersASinglePluginForward)
+{
+    auto calls = 0;
+    auto* const amx = host::AddPlugin("single.amxx", {{"on_single", [&](Amx*, cell*) {
+        ++calls;
+        return 1;
+    }}});
+
+    Forward<int()> forward{};
+    EXPECT_FALSE(forward.RegisterSingle(amx, "absent"));
+    EXPECT_FALSE(forward.IsValid());
+
+    ASSERT_TRUE(forward.RegisterSingle(amx, "on_single"));
+    const auto id = forward.Id();
+    EXPECT_EQ(forward(), 1);
+
+    forward.Unregister();
+    EXPECT_FALSE(forward.IsValid());
+    EXPECT_EQ(ExecuteForward(id), -1);
+    EXPECT_EQ(calls, 1);
+}
@@ -0,0 +1,122 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_NATIVE_STATS
+
+#include "fake_host_test.h"
+#include <amxx/native_stats.h>
+#include <string>
+#include <vector>
+
+using namespace amxx;
+
+namespace
+{
+    /**
+     * @brief stats_echo(value): returns \c value.
+    */
+    cell AMX_NATIVE_CALL StatsEcho(Amx*, cell* const params)
+    {
+        return params[1];
+    }
+
+    constexpr AmxNativeInfo NATIVES[] = {{"stats_echo", StatsEcho}, {nullptr, nullptr}};
+
+    class NativeStatsTest : public test::FakeHostTest
+    {
+    protected:
+        static void SetUpTestSuite()
+        {
+            AddNatives(NATIVES);
+        }
+
+        void SetUp() override
+        {
+            ResetNativeStats();
+            SetNativeStatsEnabled(true);
+        }
+
+        void TearDown() override
+        {
+            SetNativeStatsEnabled(true);
+            FakeHostTest::TearDown();
+        }
+
+        /**
+         * @brief Counters of \c stats_echo, or nullptr if it was not called.
+        */
+        static const NativeStats* FindEcho(const std::vector<NativeStats>& stats)
+        {
+            for (const auto& native : stats) {
+                if (std::string{native.name} == "stats_echo") {
+                    return &native;
+                }
+            }
+
+            return nullptr;
+        }
+    };
+}
+
+TEST_F(NativeStatsTest, CountsCallsPerPlugin)
+{
+    auto* const busy = host::AddPlugin("busy.amxx", {});
+    auto* const idle = host::AddPlugin("idle.amxx", {});
+
+    for (auto i = 0; i < 3; ++i) {
+        EXPECT_EQ(host::CallNative(busy, "stats_echo", {i}), i);
+    }
+
+    host::CallNative(idle, "stats_echo", {0});
+
+    const auto stats = CollectNativeStats();
+    const auto* const echo = FindEcho(stats);
+    ASSERT_NE(echo, nullptr);
+    EXPECT_EQ(echo->calls, 4U);
+    EXPECT_EQ(echo->other_calls, 0U);
+    EXPECT_LE(echo->p50_ns, echo->p99_ns);
+    EXPECT_GE(echo->total_ns, echo->mean_ns);
+
+    ASSERT_EQ(echo->callers.size(), 2U);
+    EXPECT_EQ(echo->callers[0].amx, busy);
+    EXPECT_EQ(echo->callers[0].calls, 3U);
+    EXPECT_EQ(echo->callers[1].amx, idle);
+    EXPECT_EQ(echo->callers[1].calls, 1U);
+
+    const auto report = NativeStatsReport();
+    EXPECT_NE(report.find("stats_echo"), std::string::npos);
+    EXPECT_NE(report.find("busy.amxx 75%"), std::string::npos);
+}
+
+TEST_F(NativeStatsTest, SkipsRecordingWhileDisabled)
+{
+    auto* const amx = host::AddPlugin("paused.amxx", {});
+
+    SetNativeStatsEnabled(false);
+    EXPECT_FALSE(NativeStatsEnabled());
+    EXPECT_EQ(host::CallNative(amx, "stats_echo", {5}), 5);
+    EXPECT_EQ(FindEcho(CollectNativeStats()), nullptr);
+
+    SetNativeStatsEnabled(true);
+    host::CallNative(amx, "stats_echo", {5});
+    ASSERT_NE(FindEcho(CollectNativeStats()), nullptr);
+
+    ResetNativeStats();
+    EXPECT_EQ(FindEcho(CollectNativeStats()), nullptr);
+}
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_host_test.h"
+#include <amxx/amx_heap.h>
+#include <amxx/native.h>
+#include <numeric>
+#include <string>
+#include <string_view>
+
+using namespace amxx;
+
+namespace
+{
+    enum class Team
+    {
+        Terrorist = 1,
+        Ct = 2
+    };
+
+    int Sum(const int a, const float b, const bool c)
+    {
+        return a + static_cast<int>(b) + (c ? 100 : 0);
+    }
+
+    float Half(const float value)
+    {
+        return value / 2.f;
+    }
+
+    void Store(cell& out, real& value, const cell* source)
+    {
+        out = source[1];
+        value = 0.5f;
+    }
+
+    int Length(Amx*, const std::string_view string, const char* const pointer)
+    {
+        return static_cast<int>(string.size() * 1000 + std::char_traits<char>::length(pointer));
+    }
+
+    bool IsCt(const Team team)
+    {
+        return team == Team::Ct;
+    }
+
+    int Short(const NativeString<4> string)
+    {
+        return static_cast<int>(string.size());
+    }
+
+    int Total(const amx::Span<const cell> values, const int bias)
+    {
+        return std::accumulate(values.begin(), values.end(), bias);
+    }
+
+    void Scale(const amx::FloatSpan values, const float factor)
+    {
+        for (auto& value : values) {
+            value *= factor;
+        }
+    }
+
+    constexpr AmxNativeInfo NATIVES[] = {
+        AMXX_NATIVE(Sum), AMXX_NATIVE(Half), AMXX_NATIVE(Store), AMXX_NATIVE(Length), AMXX_NATIVE(IsCt),
+        AMXX_NATIVE(Short), AMXX_NATIVE(Total), AMXX_NATIVE(Scale), {nullptr, nullptr}};
+
+    class NativeTest : public test::FakeHostTest
+    {
+    protected:
+        static void SetUpTestSuite()
+        {
+            AddNatives(NATIVES);
+        }
+
+        void SetUp() override
+        {
+            amx_ = host::AddPlugin("natives.amxx", {});
+            ASSERT_NE(amx_, nullptr);
+        }
+
+        Amx* amx_{};
+    };
+}
+
+TEST_F(NativeTest, ConvertsScalars)
+{
+    EXPECT_EQ(host::CallNative(amx_, "Sum", {5, amx::FloatToCell(2.5f), 1}), 107);
+    EXPECT_EQ(host::CallNative(amx_, "Sum", {-5, amx::FloatToCell(-1.f), 0}), -6);
+    EXPECT_FLOAT_EQ(amx::CellToFloat(host::CallNative(amx_, "Half", {amx::FloatToCell(3.f)})), 1.5f);
+    EXPECT_EQ(host::CallNative(amx_, "IsCt", {static_cast<cell>(Team::Ct)}), 1);
+    EXPECT_EQ(host::CallNative(amx_, "IsCt", {static_cast<cell>(Team::Terrorist)}), 0);
+}
+
+TEST_F(NativeTest, BindsReferencesAndArrays)
+{
+    AmxHeapScope heap{amx_};
+    const auto out = heap.AllocateCell(0);
+    const auto value = heap.AllocateCell(0);
+    const cell source_data[] = {10, 20, 30};
+    const auto source = heap.AllocateArray(source_data, 3);
+
+    host::CallNative(amx_, "Store", {out.address, value.address, source.address});
+
+    EXPECT_EQ(*out.phys, 20);
+    EXPECT_FLOAT_EQ(amx::CellToFloat(*value.phys), 0.5f);
+}
+
+TEST_F(NativeTest, BindsStrings)
+{
+    AmxHeapScope heap{amx_};
+    const auto first = heap.AllocateString("hello");
+    const auto second = heap.AllocateString("ab");
+
+    EXPECT_EQ(host::CallNative(amx_, "Length", {first.address, second.address}), 5002);
+
+    const std::string long_string(600, 'x');
+    const auto spilled = heap.AllocateString(long_string);
+    EXPECT_EQ(host::CallNative(amx_, "Length", {spilled.address, second.address}), 600002);
+}
+
+TEST_F(NativeTest, TruncatesAndLogsStringsLongerThanTheBuffer)
+{
+    AmxHeapScope heap{amx_};
+    const auto second = heap.AllocateString("ab");
+    const std::string fits(NATIVE_STRING_BUFFER_SIZE - 1, 'x');
+    const std::string too_long(NATIVE_STRING_BUFFER_SIZE + 10, 'x');
+
+    host::ClearMessages();
+    EXPECT_EQ(host::CallNative(amx_, "Length", {heap.AllocateString(fits).address, second.address}),
+              static_cast<cell>(fits.size() * 1000 + 2));
+    EXPECT_TRUE(host::Messages().empty());
+
+    EXPECT_EQ(host::CallNative(amx_, "Length", {heap.AllocateString(too_long).address, second.address}),
+              static_cast<cell>(fits.size() * 1000 + 2));
+    ASSERT_EQ(host::Messages().size(), 1U);
+    EXPECT_NE(host::Messages()[0].find("truncated"), std::string::npos);
+}
+
+TEST_F(NativeTest, TruncatesNativeStringToItsSize)
+{
+    AmxHeapScope heap{amx_};
+
+    EXPECT_EQ(host::CallNative(amx_, "Short", {heap.AllocateString("abcdefgh").address}), 4);
+    EXPECT_EQ(host::CallNative(amx_, "Short", {heap.AllocateString("ab").address}), 2);
+}
+
+TEST_F(NativeTest, BindsSpansToTwoParameters)
+{
+    AmxHeapScope heap{amx_};
+    const cell values[] = {10, 20, 30};
+    const auto array = heap.AllocateArray(values, 3);
+
+    EXPECT_EQ(host::CallNative(amx_, "Total", {array.address, 3, 5}), 65);
+    EXPECT_EQ(host::CallNative(amx_, "Total", {array.address, 2, 0}), 30);
+
+    const cell floats[] = {amx::FloatToCell(1.5f), amx::FloatToCell(-2.f)};
+    const auto float_array = heap.AllocateArray(floats, 2);
+    host::CallNative(amx_, "Scale", {float_array.address, 2, amx::FloatToCell(2.f)});
+
+    EXPECT_FLOAT_EQ(amx::CellToFloat(float_array.phys[0]), 3.f);
+    EXPECT_FLOAT_EQ(amx::CellToFloat(float_array.phys[1]), -4.f);
+}
+
+TEST_F(NativeTest, RejectsTooFewParameters)
+{
+    host::ClearMessages();
+
+    EXPECT_EQ(host::CallNative(amx_, "Sum", {5, 1}), 0);
+    EXPECT_EQ(amx_->error, static_cast<int>(AmxError::Native));
+
+    // A span counts as two plugin parameters.
+    EXPECT_EQ(host::CallNative(amx_, "Total", {0, 0}), 0);
+    EXPECT_EQ(amx_->error, static_cast<int>(AmxError::Native));
+
+    ASSERT_EQ(host::Messages().size(), 2U);
+    EXPECT_NE(host::Messages()[0].find("expected 3, got 2"), std::string::npos);
+}
@@ -0,0 +1,138 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_host_test.h"
+#include <amxx/player_snapshot.h>
+#include <amxx/players.h>
+
+using namespace amxx;
+
+namespace
+{
+    class PlayersTest : public test::FakeHostTest
+    {
+    protected:
+        void TearDown() override
+        {
+            FakeHostTest::TearDown();
+            InvalidatePlayerViews();
+        }
+    };
+}
+
+TEST_F(PlayersTest, ReadsThePlayerRecord)
+{
+    host::ConnectPlayer(3, "player");
+    host::GetFakePlayer(3).deaths = 11;
+    host::GetFakePlayer(3).team_id = 2;
+
+    const auto& view = GetPlayerView(3);
+    ASSERT_TRUE(view.IsBound());
+    EXPECT_TRUE(view.InGame());
+    EXPECT_EQ(view.Id(), 3);
+    EXPECT_EQ(view.Deaths(), 11);
+    EXPECT_EQ(view.TeamId(), 2);
+
+    host::GetFakePlayer(3).deaths = 12;
+    EXPECT_EQ(view.Deaths(), 12);
+
+    OnPlayerDisconnected(3);
+    EXPECT_FALSE(view.IsBound());
+}
+
+TEST_F(PlayersTest, StopsAtTheServerMaxClients)
+{
+    EXPECT_EQ(MaxClients(), MAX_CLIENTS);
+
+    host::SetMaxClients(8);
+    InvalidatePlayerViews();
+
+    EXPECT_EQ(MaxClients(), 8);
+    EXPECT_NE(PlayerPropAddress(8, PlayerProp::InGame), nullptr);
+    EXPECT_EQ(PlayerPropAddress(9, PlayerProp::InGame), nullptr);
+
+    host::ConnectPlayer(12, "outside");
+    const auto& outside = GetPlayerView(12);
+    EXPECT_FALSE(outside.IsBound());
+    EXPECT_FALSE(outside.InGame());
+    EXPECT_FALSE(GetPlayerView(0).InGame());
+    EXPECT_FALSE(GetPlayerView(MAX_CLIENTS + 1).InGame());
+}
+
+TEST_F(PlayersTest, CapturesOnlyTheServerSlots)
+{
+    host::SetMaxClients(4);
+    InvalidatePlayerViews();
+
+    host::ConnectPlayer(2, "inside");
+    host::ConnectPlayer(10, "outside");
+
+    PlayerSnapshot snapshot{};
+    EXPECT_EQ(snapshot.Capture(), 1U);
+    EXPECT_EQ(snapshot.Capture(), 0U);
+
+    host::GetFakePlayer(2).deaths = 1;
+    host::GetFakePlayer(10).deaths = 1;
+    EXPECT_EQ(snapshot.Capture(), 1U);
+}
+
+TEST_F(PlayersTest, CapturesTheChangedFields)
+{
+    host::ConnectPlayer(1, "bot", true);
+
+    PlayerSnapshot snapshot{};
+    ASSERT_EQ(snapshot.Capture(), 1U);
+    EXPECT_EQ(snapshot.Current().state[1], PLAYER_FIELD_IN_GAME | PLAYER_FIELD_ALIVE | PLAYER_FIELD_BOT);
+    EXPECT_EQ(snapshot.Current().health[1], 100);
+
+    host::GetFakePlayer(1).health = 40;
+    host::GetFakePlayer(1).alive = false;
+    ASSERT_EQ(snapshot.Capture(), 1U);
+    EXPECT_EQ(snapshot.Changes()[0].id, 1);
+    EXPECT_EQ(snapshot.Changes()[0].fields, PLAYER_FIELD_HEALTH | PLAYER_FIELD_ALIVE);
+    EXPECT_EQ(snapshot.Previous().health[1], 100);
+    EXPECT_EQ(snapshot.Current().state[1] & PLAYER_FIELD_BOT, PLAYER_FIELD_BOT);
+
+    host::DisconnectPlayer(1);
+    host::GetFakePlayer(1).connecting = true;
+    ASSERT_EQ(snapshot.Capture(), 1U);
+    EXPECT_EQ(snapshot.Current().state[1], PLAYER_FIELD_CONNECTED_NOT_IN_GAME);
+    EXPECT_EQ(snapshot.Current().health[1], 0);
+}
+
+TEST_F(PlayersTest, IgnoresConnectEventsOutsideTheServerSlots)
+{
+    host::SetMaxClients(4);
+    InvalidatePlayerViews();
+
+    OnPlayerConnected(0);
+    OnPlayerConnected(5);
+    OnPlayerConnected(MAX_CLIENTS + 1);
+    OnPlayerDisconnected(-1);
+    OnPlayerDisconnected(MAX_CLIENTS + 1);
+    EXPECT_FALSE(GetPlayerView(5).IsBound());
+
+    host::ConnectPlayer(4, "last");
+    host::GetFakePlayer(4).weapons[MAX_PLAYER_WEAPONS - 1].clip = 7;
+    host::GetFakePlayer(4).flags[MAX_ACCESS_LEVELS - 1] = 3;
+    OnPlayerConnected(4);
+
+    const auto& view = GetPlayerView(4);
+    ASSERT_TRUE(view.InGame());
+    EXPECT_EQ(view.Weapon(MAX_PLAYER_WEAPONS - 1).clip, 7);
+    EXPECT_EQ(view.Flags(MAX_ACCESS_LEVELS - 1), 3);
+}
@@ -0,0 +1,133 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_host_test.h"
+#include <amxx/plugin_local.h>
+
+using namespace amxx;
+
+namespace
+{
+    int g_live = 0;
+
+    struct PluginState
+    {
+        explicit PluginState(Amx* const owner)
+            : amx(owner)
+        {
+            ++g_live;
+        }
+
+        ~PluginState()
+        {
+            --g_live;
+        }
+
+        PluginState(const PluginState&) = delete;
+        PluginState& operator=(const PluginState&) = delete;
+
+        Amx* amx;
+        int value{};
+    };
+
+    class PluginLocalTest : public test::FakeHostTest
+    {
+    protected:
+        void SetUp() override
+        {
+            g_live = 0;
+            first_ = host::AddPlugin("first.amxx", {});
+            second_ = host::AddPlugin("second.amxx", {});
+        }
+
+        PluginLocal<PluginState> states_{};
+        PluginLocal<int> counters_{};
+        Amx* first_{};
+        Amx* second_{};
+    };
+}
+
+TEST_F(PluginLocalTest, CreatesOneValuePerPluginOnFirstUse)
+{
+    EXPECT_EQ(states_.Find(first_), nullptr);
+
+    states_.Get(first_).value = 5;
+    states_[second_].value = 7;
+    counters_[second_] = 3;
+
+    EXPECT_EQ(g_live, 2);
+    EXPECT_EQ(states_.Find(first_)->amx, first_);
+    EXPECT_EQ(states_.Find(first_)->value, 5);
+    EXPECT_EQ(states_.Get(second_).value, 7);
+    EXPECT_EQ(*counters_.Find(second_), 3);
+    EXPECT_EQ(counters_.Find(first_), nullptr);
+
+    auto sum = 0;
+    states_.ForEach([&](Amx*, const PluginState& state) { sum += state.value; });
+    EXPECT_EQ(sum, 12);
+}
+
+TEST_F(PluginLocalTest, ResetAndReleaseDestroyTheValues)
+{
+    states_.Get(first_);
+    states_.Get(second_);
+    counters_.Get(second_);
+
+    states_.Reset(first_);
+    EXPECT_EQ(states_.Find(first_), nullptr);
+    EXPECT_EQ(g_live, 1);
+
+    ReleasePluginLocals(second_);
+    EXPECT_EQ(states_.Find(second_), nullptr);
+    EXPECT_EQ(counters_.Find(second_), nullptr);
+    EXPECT_EQ(g_live, 0);
+
+    {
+        PluginLocal<PluginState> scoped{};
+        scoped.Get(first_);
+        EXPECT_EQ(g_live, 1);
+    }
+
+    EXPECT_EQ(g_live, 0);
+}
+
+TEST_F(PluginLocalTest, FallsBackWhenTheUserDataSlotIsTaken)
+{
+    auto* const crowded = host::AddPlugin("crowded.amxx", {});
+
+    for (auto i = 0; i < amx::AMX_USER_CORE_FIRST; ++i) {
+        crowded->user_tags[i] = amx::MakeUserTag('T', 'E', 'S', 'T');
+        crowded->user_data[i] = crowded;
+    }
+
+    states_.Get(crowded).value = 9;
+    EXPECT_EQ(states_.Find(crowded)->value, 9);
+    EXPECT_EQ(crowded->user_data[0], crowded);
+
+    ReleasePluginLocals(crowded);
+    EXPECT_EQ(states_.Find(crowded), nullptr);
+    EXPECT_EQ(g_live, 0);
+}
+
+TEST_F(PluginLocalTest, UnloadingThePluginsDestroysTheValues)
+{
+    states_.Get(first_);
+    states_.Get(second_);
+
+    host::UnloadPlugins();
+    EXPECT_EQ(g_live, 0);
+}
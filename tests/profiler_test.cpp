@@ -0,0 +1,143 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_PROFILER
+
+#include "amx_image.h"
+#include "fake_host_test.h"
+#include <amxx/amx_index.h>
+#include <amxx/profiler.h>
+#include <limits>
+#include <string>
+
+using namespace amxx;
+using amx::Opcode;
+
+namespace
+{
+    int g_hook_calls{};
+
+    int AMXAPI CountingHook(Amx*)
+    {
+        ++g_hook_calls;
+        return static_cast<int>(AmxError::None);
+    }
+
+    /**
+     * @brief Sample on every statement.
+    */
+    constexpr auto EVERY_STATEMENT = std::numeric_limits<std::uint32_t>::max();
+
+    class ProfilerTest : public test::FakeHostTest
+    {
+    protected:
+        void SetUp() override
+        {
+            test::AmxAssembler code{};
+            code.Emit(Opcode::Halt, 0);
+
+            // inner(): return 1
+            const auto inner = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::Break);
+            code.Emit(Opcode::ConstPri, 1);
+            code.Emit(Opcode::Retn);
+
+            // outer(): return inner()
+            const auto outer = code.Here();
+            code.Emit(Opcode::Proc);
+            code.Emit(Opcode::Break);
+            code.Emit(Opcode::PushC, 0);
+            code.Emit(Opcode::Call, inner);
+            code.Emit(Opcode::Retn);
+
+            amx_ = host::LoadPlugin("prof.amxx", test::BuildAmxImage({{"inner", inner}, {"outer", outer}}, {}, code.Code()));
+            ASSERT_NE(amx_, nullptr);
+
+            g_hook_calls = 0;
+            ResetProfiler();
+        }
+
+        void TearDown() override
+        {
+            StopProfiling();
+            ResetProfiler();
+            FakeHostTest::TearDown();
+        }
+
+        /**
+         * @brief Runs the public \c outer \c times times.
+        */
+        void RunOuter(const int times) const
+        {
+            for (auto i = 0; i < times; ++i) {
+                cell result{};
+                ASSERT_EQ(static_cast<AmxError>(AmxExec(amx_, &result, FindPublicIndex(amx_, "outer"))), AmxError::None);
+                ASSERT_EQ(result, 1);
+            }
+        }
+
+        Amx* amx_{};
+    };
+}
+
+TEST_F(ProfilerTest, FoldsTheSampledCallStacks)
+{
+    ASSERT_TRUE(StartProfiling(amx_, EVERY_STATEMENT));
+    EXPECT_TRUE(IsProfiling(amx_));
+    EXPECT_FALSE(StartProfiling(amx_));
+
+    RunOuter(10);
+
+    EXPECT_GT(ProfilerSampleCount(), 0U);
+    const auto stacks = CollapsedStacks();
+    EXPECT_NE(stacks.find("prof.amxx;outer "), std::string::npos) << stacks;
+    EXPECT_NE(stacks.find("prof.amxx;outer;inner "), std::string::npos) << stacks;
+}
+
+TEST_F(ProfilerTest, ChainsAndRestoresThePreviousHook)
+{
+    amx_->debug = CountingHook;
+    ASSERT_TRUE(StartProfiling(amx_, EVERY_STATEMENT));
+
+    RunOuter(1);
+    EXPECT_EQ(g_hook_calls, 2);
+
+    StopProfiling(amx_);
+    EXPECT_FALSE(IsProfiling(amx_));
+    EXPECT_EQ(amx_->debug, CountingHook);
+
+    // The samples outlive the profile.
+    EXPECT_NE(CollapsedStacks().find("prof.amxx;outer"), std::string::npos);
+
+    RunOuter(1);
+    EXPECT_EQ(g_hook_calls, 4);
+}
+
+TEST_F(ProfilerTest, ResetDropsTheSamples)
+{
+    ASSERT_TRUE(StartProfiling(amx_, EVERY_STATEMENT));
+    RunOuter(1);
+    ASSERT_GT(ProfilerSampleCount(), 0U);
+
+    ResetProfiler();
+    EXPECT_EQ(ProfilerSampleCount(), 0U);
+    EXPECT_TRUE(CollapsedStacks().empty());
+    EXPECT_TRUE(IsProfiling(amx_));
+}
+
+#endif
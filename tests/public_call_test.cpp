@@ -0,0 +1,184 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fake_host_test.h"
+#include <amxx/public_call.h>
+#include <string>
+
+using namespace amxx;
+
+namespace
+{
+    using PublicCallTest = test::FakeHostTest;
+}
+
+TEST_F(PublicCallTest, PassesArgumentsAndReturnsTheResult)
+{
+    std::string seen{};
+
+    auto* const amx = host::AddPlugin(
+        "call.amxx", {{"on_call", [&](Amx* plugin, cell* params) {
+            seen = amx::GetString(plugin, params[3]);
+
+            return static_cast<cell>(params[0] / sizeof(cell) * 1000 + params[1] + params[2]);
+        }}});
+
+    PublicCall<int(int, int, const char*)> call{};
+    ASSERT_TRUE(call.Bind(amx, "on_call"));
+
+    const auto heap = amx->hea;
+    EXPECT_EQ(call(20, 22, "text"), 3042);
+    EXPECT_EQ(call.Error(), AmxError::None);
+    EXPECT_EQ(seen, "text");
+    EXPECT_EQ(amx->hea, heap);
+}
+
+TEST_F(PublicCallTest, WritesReferencesBack)
+{
+    auto* const amx = host::AddPlugin("ref.amxx", {{"on_ref", [](Amx* plugin, cell* params) {
+        *amx::Address(plugin, params[1]) += 5;
+        *reinterpret_cast<real*>(amx::Address(plugin, params[2])) *= 2.f;
+
+        return 0;
+    }}});
+
+    PublicCall<void(cell&, real&)> call{};
+    ASSERT_TRUE(call.Bind(amx, "on_ref"));
+
+    cell value = 10;
+    real scale = 1.25f;
+    call(value, scale);
+
+    EXPECT_EQ(value, 15);
+    EXPECT_FLOAT_EQ(scale, 2.5f);
+}
+
+TEST_F(PublicCallTest, FailsToBindAMissingPublic)
+{
+    auto* const amx = host::AddPlugin("missing.amxx", {{"present", [](Amx*, cell*) { return 1; }}});
+
+    PublicCall<int()> call{};
+    EXPECT_FALSE(call.Bind(amx, "absent"));
+    EXPECT_FALSE(call.IsValid());
+    EXPECT_EQ(call(), 0);
+    EXPECT_NE(call.Error(), AmxError::None);
+}
+
+TEST_F(PublicCallTest, ExecvIgnoresItsParameters)
+{
+    cell count = -1;
+    auto* const amx = host::AddPlugin("execv.amxx", {{"on_exec", [&](Amx*, cell* params) {
+        count = params[0];
+        return 0;
+    }}});
+
+    int index{};
+    ASSERT_EQ(AmxFindPublic(amx, "on_exec", &index), static_cast<int>(AmxError::None));
+
+    cell params[] = {1, 2, 3};
+    cell result{};
+    EXPECT_EQ(AmxExecV(amx, &result, index, 3, params), static_cast<int>(AmxError::None));
+    EXPECT_EQ(count, 0);
+}
+
+TEST_F(PublicCallTest, BroadcastSkipsPluginsWithoutThePublicAndPausedPlugins)
+{
+    int calls[3]{};
+
+    host::AddPlugin("a.amxx", {{"on_frame", [&](Amx* amx, cell* params) {
+        ++calls[0];
+        amx::Address(amx, params[1])[0] += params[2];
+        return 1;
+    }}});
+
+    host::AddPlugin("none.amxx", {{"other", [](Amx*, cell*) { return 0; }}});
+
+    auto* const paused = host::AddPlugin("b.amxx", {{"on_frame", [&](Amx*, cell*) {
+        ++calls[1];
+        return 3;
+    }}});
+
+    host::AddPlugin("c.amxx", {{"on_frame", [&](Amx* amx, cell* params) {
+        ++calls[2];
+        return amx::Address(amx, params[1])[0];
+    }}});
+
+    host::PluginsLoaded();
+
+    PublicBroadcast<int(SharedArray&, int)> broadcast{};
+    ASSERT_TRUE(broadcast.Bind("on_frame", ForwardExecType::Continue));
+    EXPECT_EQ(broadcast.Count(), 3U);
+
+    cell data[4] = {1};
+    SharedArray array{data, 4};
+
+    EXPECT_EQ(broadcast(array, 1), 3);
+    EXPECT_TRUE(array.Dirty());
+    EXPECT_EQ(data[0], 2);
+
+    host::PausePlugin(paused, true);
+    EXPECT_EQ(broadcast(array, 10), 12);
+    EXPECT_EQ(data[0], 12);
+    EXPECT_EQ(calls[0], 2);
+    EXPECT_EQ(calls[1], 1);
+    EXPECT_EQ(calls[2], 2);
+
+    broadcast.Reset();
+}
+
+TEST_F(PublicCallTest, PassesANullStringAsAnEmptyOne)
+{
+    std::string seen{"unset"};
+
+    auto* const amx = host::AddPlugin("null.amxx", {{"on_text", [&](Amx* plugin, cell* params) {
+        seen = amx::GetString(plugin, params[1]);
+        return 1;
+    }}});
+
+    PublicCall<int(const char*)> call{};
+    ASSERT_TRUE(call.Bind(amx, "on_text"));
+    EXPECT_EQ(call(nullptr), 1);
+    EXPECT_EQ(seen, "");
+}
+
+TEST_F(PublicCallTest, BroadcastReportsErrorsAndKeepsTheArrayOfFailedPlugins)
+{
+    host::AddPlugin("fails.amxx", {{"on_frame", [](Amx* amx, cell* params) {
+        amx::Address(amx, params[1])[0] = 99;
+        RaiseAmxError(amx, AmxError::Native);
+        return 5;
+    }}});
+
+    host::AddPlugin("reads.amxx", {{"on_frame", [](Amx* amx, cell* params) {
+        return amx::Address(amx, params[1])[0];
+    }}});
+
+    host::PluginsLoaded();
+
+    PublicBroadcast<int(SharedArray&)> broadcast{};
+    ASSERT_TRUE(broadcast.Bind("on_frame", ForwardExecType::Continue));
+
+    cell data[2] = {7};
+    SharedArray array{data, 2};
+
+    EXPECT_EQ(broadcast(array), 7);
+    EXPECT_EQ(broadcast.Error(), AmxError::Native);
+    EXPECT_FALSE(array.Dirty());
+    EXPECT_EQ(data[0], 7);
+
+    broadcast.Reset();
+}
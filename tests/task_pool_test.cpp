@@ -0,0 +1,142 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_TASK_POOL
+
+#include <amxx/task_pool.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace amxx;
+
+namespace
+{
+    class TaskPoolTest : public testing::Test
+    {
+    protected:
+        void TearDown() override
+        {
+            StopTaskPool();
+            RunTaskCompletions();
+        }
+
+        /**
+         * @brief Runs the completions until \c done holds or a few seconds have passed.
+        */
+        template <typename TPredicate>
+        static void RunCompletionsUntil(TPredicate&& done)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+
+            while (!done() && std::chrono::steady_clock::now() < deadline) {
+                RunTaskCompletions();
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            }
+        }
+    };
+}
+
+TEST_F(TaskPoolTest, RunsWorkInlineWithoutAPool)
+{
+    ASSERT_FALSE(TaskPoolRunning());
+    EXPECT_EQ(TaskPoolSize(), 0U);
+
+    auto ran_on = std::thread::id{};
+    auto result = 0;
+    SubmitTask([&ran_on] {
+        ran_on = std::this_thread::get_id();
+        return 42;
+    }, [&result](const int value) { result = value; });
+
+    EXPECT_EQ(ran_on, std::this_thread::get_id());
+    EXPECT_EQ(result, 0);
+    EXPECT_EQ(RunTaskCompletions(), 1U);
+    EXPECT_EQ(result, 42);
+}
+
+TEST_F(TaskPoolTest, RunsWorkOnWorkersAndCompletionsOnTheCallingThread)
+{
+    ASSERT_TRUE(StartTaskPool(3));
+    EXPECT_TRUE(TaskPoolRunning());
+    EXPECT_EQ(TaskPoolSize(), 3U);
+    EXPECT_FALSE(StartTaskPool(1));
+
+    constexpr auto TASKS = 200;
+    const auto game_thread = std::this_thread::get_id();
+    std::atomic<int> on_game_thread{};
+    auto sum = 0;
+    auto done = 0;
+
+    for (auto i = 1; i <= TASKS; ++i) {
+        SubmitTask([&on_game_thread, game_thread, i] {
+            on_game_thread += std::this_thread::get_id() == game_thread;
+            return i;
+        }, [&sum, &done, game_thread](const int value) {
+            EXPECT_EQ(std::this_thread::get_id(), game_thread);
+            sum += value;
+            ++done;
+        });
+    }
+
+    RunCompletionsUntil([&done] { return done == TASKS; });
+    EXPECT_EQ(done, TASKS);
+    EXPECT_EQ(sum, TASKS * (TASKS + 1) / 2);
+    EXPECT_EQ(on_game_thread, 0);
+}
+
+TEST_F(TaskPoolTest, StopFinishesTheQueuedWork)
+{
+    ASSERT_TRUE(StartTaskPool(2));
+
+    std::atomic<int> ran{};
+
+    for (auto i = 0; i < 100; ++i) {
+        SubmitTask([&ran] {
+            std::this_thread::sleep_for(std::chrono::microseconds{50});
+            ++ran;
+        });
+    }
+
+    StopTaskPool();
+    EXPECT_FALSE(TaskPoolRunning());
+    EXPECT_EQ(TaskPoolSize(), 0U);
+    EXPECT_EQ(ran, 100);
+}
+
+TEST_F(TaskPoolTest, RunsCompletionsInOrderAndInBatches)
+{
+    std::vector<int> order{};
+
+    for (auto i = 0; i < 5; ++i) {
+        PostToGameThread([&order, i] { order.push_back(i); });
+    }
+
+    // Move-only state is fine in a Task.
+    PostToGameThread([value = std::make_unique<int>(5), &order] { order.push_back(*value); });
+
+    EXPECT_EQ(RunTaskCompletions(2), 2U);
+    EXPECT_EQ(order, (std::vector<int>{0, 1}));
+    EXPECT_EQ(RunTaskCompletions(), 4U);
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3, 4, 5}));
+    EXPECT_EQ(RunTaskCompletions(), 0U);
+}
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ *  Copyright (C) 2020 the_hunter
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifdef AMXX_TRACE
+
+#include "fake_host_test.h"
+#include <amxx/amx_index.h>
+#include <amxx/forward.h>
+#include <amxx/trace.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace amxx;
+
+namespace
+{
+    class TraceTest : public test::FakeHostTest
+    {
+    protected:
+        void SetUp() override
+        {
+            SetTraceEnabled(true);
+            ClearTrace();
+        }
+
+        void TearDown() override
+        {
+            SetTraceEnabled(true);
+            ClearTrace();
+            ResetTraceNames();
+            FakeHostTest::TearDown();
+        }
+
+        /**
+         * @brief Writes the trace out and reads it back.
+        */
+        static std::string ReadTrace()
+        {
+            const auto path = testing::TempDir() + "trace_test.json";
+            EXPECT_TRUE(WriteChromeTrace(path.c_str()));
+
+            std::stringstream text{};
+            text << std::ifstream{path}.rdbuf();
+
+            return text.str();
+        }
+    };
+}
+
+TEST_F(TraceTest, WritesScopesOfEveryThreadAsJson)
+{
+    {
+        const TraceScope scope{TraceIntern("say \"hi\""), "test"};
+    }
+
+    std::thread{[] {
+        SetTraceThreadName("worker");
+        const TraceScope scope{"worker slice", "test"};
+    }}.join();
+
+    const auto trace = ReadTrace();
+    EXPECT_EQ(trace.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0), 0U);
+    EXPECT_NE(trace.find(R"({"name":"say \"hi\"","cat":"test","ph":"X")"), std::string::npos) << trace;
+    EXPECT_NE(trace.find(R"("args":{"name":"worker"})"), std::string::npos) << trace;
+    EXPECT_NE(trace.find(R"({"name":"worker slice")"), std::string::npos) << trace;
+
+    ClearTrace();
+    EXPECT_EQ(ReadTrace().find("worker slice"), std::string::npos);
+}
+
+TEST_F(TraceTest, RecordsNothingWhilePaused)
+{
+    SetTraceEnabled(false);
+    EXPECT_FALSE(TraceEnabled());
+
+    {
+        const TraceScope scope{"paused slice", "test"};
+    }
+
+    EXPECT_EQ(ReadTrace().find("paused slice"), std::string::npos);
+}
+
+TEST_F(TraceTest, NamesPublicsAndForwards)
+{
+    auto* const amx = host::AddPlugin("traced.amxx", {{"on_traced", [](Amx*, cell*) { return 1; }}});
+    host::PluginsLoaded();
+
+    Forward<int()> forward{};
+    ASSERT_TRUE(forward.Register("on_traced", ForwardExecType::Continue));
+    EXPECT_STREQ(TraceForwardName(forward.Id()), "forward on_traced");
+    EXPECT_EQ(forward(), 1);
+
+    cell result{};
+    EXPECT_EQ(static_cast<AmxError>(AmxExec(amx, &result, FindPublicIndex(amx, "on_traced"))), AmxError::None);
+
+    const auto trace = ReadTrace();
+    EXPECT_NE(trace.find(R"({"name":"forward on_traced","cat":"forward")"), std::string::npos) << trace;
+    EXPECT_NE(trace.find(R"({"name":"traced.amxx::on_traced","cat":"plugin")"), std::string::npos) << trace;
+
+    EXPECT_STREQ(TracePublicName(amx, AMX_EXEC_MAIN), "traced.amxx::main");
+    EXPECT_STREQ(TracePublicName(amx, 7), "traced.amxx::public #7");
+
+    ResetTraceNames();
+    EXPECT_STREQ(TraceForwardName(forward.Id()), "forward");
+    EXPECT_STREQ(TraceForwardName(-1), "forward");
+}
+
+#endif